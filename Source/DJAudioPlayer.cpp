@@ -10,38 +10,405 @@
 
 #include "DJAudioPlayer.h"
 
-DJAudioPlayer::DJAudioPlayer(AudioFormatManager &_formatManager) : formatManager(_formatManager)
+// How much already-played audio a streamed track keeps buffered for loops.
+static constexpr double loopHistorySeconds = 8.0;
+
+// How long gain, speed and filter changes take to reach their new value.
+static constexpr double parameterRampSeconds = 0.05;
+
+// A synced deck closes a beat phase error over this long,
+static constexpr double phaseCorrectionSeconds = 0.5;
+
+// but never bends the tempo by more than this much to do it.
+static constexpr double maximumPhaseCorrection = 0.04;
+
+// How much of the track after a hot cue is kept in memory, which is how long a
+// streamed track has to decode ahead after a cue is triggered.
+static constexpr double attackSeconds = 1.0;
+
+// The resamplers and the time-stretcher make stereo, whatever the track has.
+static constexpr int numDeckChannels = 2;
+
+//==============================================================================
+// Decodes the audio after a hot cue on the cue thread, with its own reader so the
+// playing reader is never touched.
+class DJAudioPlayer::AttackJob : public ThreadPoolJob
+{
+public:
+    AttackJob(WeakReference<DJAudioPlayer> _owner,
+              AudioFormatManager &_formatManager,
+              const File &_file,
+              int _generation,
+              int _index,
+              int64 _startSample)
+        : ThreadPoolJob("Hot cue " + String(_index + 1)),
+          owner(_owner),
+          formatManager(_formatManager),
+          file(_file),
+          generation(_generation),
+          index(_index),
+          startSample(_startSample)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+        if (reader == nullptr || reader->sampleRate <= 0.0 || shouldExit())
+        {
+            return jobHasFinished;
+        }
+
+        const auto length = (int)jlimit((int64)0, (int64)(attackSeconds * reader->sampleRate), reader->lengthInSamples - startSample);
+        auto samples = std::make_shared<AudioBuffer<float>>(jlimit(1, 2, (int)reader->numChannels), length);
+        reader->read(samples.get(), 0, length, startSample, true, true);
+
+        MessageManager::callAsync([weakOwner = owner, g = generation, i = index, start = startSample, samples]
+                                  {
+            if (auto *player = weakOwner.get())
+                player->attackDecoded(g, i, start, samples); });
+
+        return jobHasFinished;
+    }
+
+private:
+    WeakReference<DJAudioPlayer> owner; // The player that receives the buffer, if it still exists
+    AudioFormatManager &formatManager;	// Used to open the track
+    File file;							// The track
+    int generation;						// The player's trackGeneration when the job was started
+    int index;							// The hot cue
+    int64 startSample;					// The cue point
+};
+
+//==============================================================================
+DJAudioPlayer::DJAudioPlayer(AudioFormatManager &_formatManager, TimeSliceThread *_decodeThread)
+    : formatManager(_formatManager), decodeThread(_decodeThread)
 {
     // Constructor for DJAudioPlayer class.
+    hotCues.fill(-1);
 }
 
 DJAudioPlayer::~DJAudioPlayer()
 {
     // Destructor for DJAudioPlayer class.
+    cuePool.removeAllJobs(true, 2000);
+
+    // Detach the sources before they are deleted.
+    transportSource.setSource(nullptr);
 }
 
 void DJAudioPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
 {
     // Prepare the audio player for playback.
-    transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    basefilterSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    lowpassSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    resamplingSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    smoothedSpeed.reset(sampleRate, parameterRampSeconds);
+    smoothedHighPass.reset(sampleRate, parameterRampSeconds);
+    smoothedLowPass.reset(sampleRate, parameterRampSeconds);
+    smoothedSpeed.setCurrentAndTargetValue(targetSpeed.load());
+    highPassActive = false;
+    lowPassActive = false;
+    appliedHighPass = 0.0f;
+    appliedLowPass = 0.0f;
+    appliedSpeed = 0.0f;
+    appliedRateRatio = 0.0;
+    deviceSampleRate = sampleRate;
+    preparedBlockSize = samplesPerBlockExpected;
+    renderedSamples = 0;
+
+    resampler.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    keyLockResampler.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    keyLockActive = false;
+
+    // The resamplers prepared the chain at the device rate, but the transport runs at the
+    // track's rate so it doesn't resample a second time and its positions stay in seconds.
+    const auto trackRate = trackSampleRate.load();
+    transportSource.prepareToPlay(samplesPerBlockExpected, trackRate > 0.0 ? trackRate : sampleRate);
+
+    // The EQ and filters run after the resampler, at the device rate. They are prepared for
+    // as many channels as the resamplers make, and run on as many as the mixer renders.
+    deckProcessor.prepare(sampleRate, samplesPerBlockExpected, numDeckChannels);
+    updateParameters(0);
 }
 
 void DJAudioPlayer::getNextAudioBlock(const AudioSourceChannelInfo &bufferToFill)
 {
-    // Get the next audio block to be played.
-    resamplingSource.getNextAudioBlock(bufferToFill);
+    // Get the next audio block to be played. Parameter changes from the GUI are
+    // picked up here, so the audio thread never waits for the message thread.
+    const auto startOffset = applyTransportEvents(bufferToFill.numSamples);
+    updateParameters(bufferToFill.numSamples);
+
+    // Both paths pull from the transport, so switching only needs the newly used one cleared out.
+    const bool useKeyLock = keyLock.load();
+
+    if (useKeyLock != keyLockActive)
+    {
+        if (useKeyLock)
+        {
+            stretchSource.reset();
+            keyLockResampler.reset();
+        }
+        else
+        {
+            resampler.reset();
+        }
+
+        keyLockActive = useKeyLock;
+    }
+
+    // A start waiting for its beat is silence, and the chain isn't pulled so the playhead stays put.
+    if (startOffset > 0)
+    {
+        bufferToFill.buffer->clear(bufferToFill.startSample, startOffset);
+    }
+
+    const AudioSourceChannelInfo playing(bufferToFill.buffer, bufferToFill.startSample + startOffset, bufferToFill.numSamples - startOffset);
+
+    if (playing.numSamples <= 0)
+    {
+        return;
+    }
+
+    if (!keyLockActive)
+    {
+        resampler.getNextAudioBlock(playing);
+    }
+    else if (appliedRateRatio != 1.0)
+    {
+        // The time-stretcher works at the track's rate, so its output still has to be converted.
+        keyLockResampler.getNextAudioBlock(playing);
+    }
+    else
+    {
+        stretchSource.getNextAudioBlock(playing);
+    }
+
+    // Trim, EQ, filters and gain in one in-place stage.
+    deckProcessor.process(playing);
+}
+
+int DJAudioPlayer::applyTransportEvents(int numSamples)
+{
+    // A quantized start is turned into a sample of the render clock once, when it arrives,
+    // and the block it falls in is split there.
+    TransportEvent event;
+
+    while (transportEvents.pop(event))
+    {
+        startClock = event.type == TransportEvent::startOnBeat ? getNextBeatClock(*event.reference) : -1;
+    }
+
+    if (startClock < 0)
+    {
+        return 0;
+    }
+
+    const auto offset = startClock - renderedSamples;
+
+    if (offset >= numSamples)
+    {
+        return numSamples;
+    }
+
+    startClock = -1;
+    return (int)jmax((int64)0, offset);
+}
+
+int64 DJAudioPlayer::getNextBeatClock(const DJAudioPlayer &reference) const
+{
+    // Move the reference deck's published beat on to now, as sync does, and count the samples to its next beat.
+    const auto beatsPerSecond = reference.publishedBeatsPerSecond.load();
+
+    if (beatsPerSecond <= 0.0 || !reference.publishedPlaying.load())
+    {
+        return -1;
+    }
+
+    const auto elapsedSeconds = (double)(renderedSamples - reference.publishedClock.load()) / deviceSampleRate;
+    const auto beat = reference.publishedBeat.load() + beatsPerSecond * elapsedSeconds;
+
+    return renderedSamples + (int64)std::ceil((std::ceil(beat) - beat) / beatsPerSecond * deviceSampleRate);
+}
+
+void DJAudioPlayer::updateParameters(int numSamples)
+{
+    // Move the speed and the filter cutoffs one block closer to their targets, and hand
+    // the gains to the deck processor, which ramps them itself.
+    publishBeatPosition();
+
+    // A synced deck takes its speed from the leader instead of the speed slider.
+    auto speedTarget = targetSpeed.load();
+
+    if (auto *leader = syncLeader.load())
+    {
+        const auto syncSpeed = getSyncSpeed(*leader);
+
+        if (syncSpeed > 0.0f)
+        {
+            speedTarget = syncSpeed;
+        }
+    }
+
+    smoothedSpeed.setTargetValue(speedTarget);
+    const auto speed = smoothedSpeed.skip(numSamples);
+
+    // The track's sample rate and the speed are applied by the same resampler.
+    const auto trackRate = trackSampleRate.load();
+    const auto rateRatio = trackRate > 0.0 ? trackRate / deviceSampleRate : 1.0;
+
+    if (speed != appliedSpeed || rateRatio != appliedRateRatio)
+    {
+        if (keyLockActive && (rateRatio != 1.0) != (appliedRateRatio != 1.0))
+        {
+            keyLockResampler.reset();
+        }
+
+        resampler.setResamplingRatio(speed * rateRatio);
+        keyLockResampler.setResamplingRatio(rateRatio);
+        stretchSource.setSpeed(speed);
+        appliedSpeed = speed;
+        appliedRateRatio = rateRatio;
+        publishedSpeed = speed;
+    }
+
+    renderedSamples += numSamples;
+
+    deckProcessor.setTrim(targetTrim.load() * targetAutoGain.load());
+    deckProcessor.setGain(targetGain.load());
+
+    for (int band = 0; band < 3; ++band)
+    {
+        deckProcessor.setBandGain((ThreeBandIsolator::Band)band, eqKills[band].load() ? 0.0f : eqGains[band].load());
+    }
+
+    const auto highPass = targetHighPass.load();
+    const auto lowPass = targetLowPass.load();
+
+    if (highPass > 0.0f)
+    {
+        if (!highPassActive)
+        {
+            smoothedHighPass.setCurrentAndTargetValue(highPass);
+            highPassActive = true;
+        }
+
+        smoothedHighPass.setTargetValue(highPass);
+        const auto frequency = smoothedHighPass.skip(numSamples);
+
+        if (frequency != appliedHighPass)
+        {
+            deckProcessor.setHighPassCutoff(frequency);
+            appliedHighPass = frequency;
+        }
+    }
+
+    if (lowPass > 0.0f)
+    {
+        if (!lowPassActive)
+        {
+            smoothedLowPass.setCurrentAndTargetValue(lowPass);
+            lowPassActive = true;
+        }
+
+        smoothedLowPass.setTargetValue(lowPass);
+        const auto frequency = smoothedLowPass.skip(numSamples);
+
+        if (frequency != appliedLowPass)
+        {
+            deckProcessor.setLowPassCutoff(frequency);
+            appliedLowPass = frequency;
+        }
+    }
+}
+
+void DJAudioPlayer::publishBeatPosition()
+{
+    // Publish the beat being heard at the start of this block, and the tempo it is moving at.
+    // The transport's position is where the chain reads, which is ahead of what is heard.
+    const auto period = beatPeriod.load();
+    const auto playing = transportSource.isPlaying();
+
+    if (period > 0.0)
+    {
+        const auto heardPosition = transportSource.getCurrentPosition() - getChainLatency();
+        publishedBeat = (heardPosition - downbeat.load()) / period;
+        publishedBeatsPerSecond = appliedSpeed / period;
+    }
+    else
+    {
+        publishedBeatsPerSecond = 0.0;
+    }
+
+    publishedClock = renderedSamples;
+    publishedPlaying = playing && startClock < 0;
+}
+
+double DJAudioPlayer::getChainLatency() const
+{
+    // Add up the input held by the path the last block went through, in samples of the track.
+    // The key lock resampler holds time-stretched samples, each of which stands for speed samples of the track.
+    const auto trackRate = trackSampleRate.load();
+
+    if (trackRate <= 0.0)
+    {
+        return 0.0;
+    }
+
+    auto latency = 0.0;
+
+    if (!keyLockActive)
+    {
+        latency = resampler.getLatency();
+    }
+    else
+    {
+        latency = stretchSource.getLatency();
+
+        if (appliedRateRatio != 1.0)
+        {
+            latency += keyLockResampler.getLatency() * appliedSpeed;
+        }
+    }
+
+    return latency / trackRate;
+}
+
+float DJAudioPlayer::getSyncSpeed(const DJAudioPlayer &leader) const
+{
+    // Match the leader's tempo, then speed up or slow down a little to line up the beats.
+    const auto period = beatPeriod.load();
+    const auto leaderBeatsPerSecond = leader.publishedBeatsPerSecond.load();
+
+    if (period <= 0.0 || leaderBeatsPerSecond <= 0.0)
+    {
+        return 0.0f;
+    }
+
+    auto beatsPerSecond = leaderBeatsPerSecond;
+
+    if (leader.publishedPlaying.load() && transportSource.isPlaying())
+    {
+        // The leader may have published during the previous block, so move its beat on to now.
+        const auto elapsedSeconds = (double)(renderedSamples - leader.publishedClock.load()) / deviceSampleRate;
+        const auto leaderBeat = leader.publishedBeat.load() + leaderBeatsPerSecond * elapsedSeconds;
+
+        // Only the phase matters, so take the error to the nearest beat.
+        auto error = leaderBeat - publishedBeat.load();
+        error -= std::round(error);
+
+        const auto correction = jlimit(-maximumPhaseCorrection, maximumPhaseCorrection, error / phaseCorrectionSeconds / leaderBeatsPerSecond);
+        beatsPerSecond *= 1.0 + correction;
+    }
+
+    return (float)(beatsPerSecond * period);
 }
 
 void DJAudioPlayer::releaseResources()
 {
     // Release the resources used by the audio player.
     // transportSource.releaseResources();
-    basefilterSource.releaseResources();
-    lowpassSource.releaseResources();
-    resamplingSource.releaseResources();
+    resampler.releaseResources();
+    keyLockResampler.releaseResources();
+    deckProcessor.reset();
 }
 
 void DJAudioPlayer::loadURL(URL audioURL)
@@ -53,24 +420,223 @@ void DJAudioPlayer::loadURL(URL audioURL)
 
     if (reader != nullptr)
     {
-        std::unique_ptr<AudioFormatReaderSource> newSource(new AudioFormatReaderSource(reader, true));
-        transportSource.setSource(newSource.get(), 0, nullptr, reader->sampleRate);
-        readerSource.reset(newSource.release());
+        loadedFile = audioURL.isLocalFile() ? audioURL.getLocalFile() : File();
+        setReader(reader);
     }
 }
 
+void DJAudioPlayer::loadTrack(LoadedTrack &track)
+{
+    // Take the decoded samples or the reader that the TrackLoader opened on its worker thread.
+    std::cout << "Loading track: " << track.audioURL.toString(true) << std::endl;
+
+    // A decoded track seeks instantly, so only streamed tracks get attack buffers.
+    loadedFile = track.decoded == nullptr && track.audioURL.isLocalFile() ? track.audioURL.getLocalFile() : File();
+
+    if (track.decoded != nullptr)
+    {
+        setDecodedTrack(track.decoded);
+    }
+    else if (track.mappedReader != nullptr)
+    {
+        setMappedReader(track.mappedReader.release());
+    }
+    else if (track.reader != nullptr)
+    {
+        setReader(track.reader.release());
+    }
+}
+
+void DJAudioPlayer::setReader(AudioFormatReader *reader)
+{
+    // The reader is decoded on the shared background thread, so the audio
+    // callback only copies PCM out of the read-ahead buffer.
+    if (decodeThread == nullptr)
+    {
+        std::cout << "DJAudioPlayer::Can't stream a track without a decode thread, only decoded tracks can be loaded" << std::endl;
+        delete reader;
+        return;
+    }
+
+    const auto sampleRate = reader->sampleRate;
+    const auto numChannels = (int)reader->numChannels;
+
+    std::unique_ptr<ReadAheadBuffer> newReadAhead(new ReadAheadBuffer(new AudioFormatReaderSource(reader, true),
+                                                                      *decodeThread,
+                                                                      true,
+                                                                      sampleRate,
+                                                                      readAheadSeconds,
+                                                                      numChannels));
+    // Keep some played audio behind the playhead so loops jump back into the buffer.
+    newReadAhead->setHistorySeconds(loopHistorySeconds);
+    swapSource(std::move(newReadAhead), nullptr, nullptr, sampleRate);
+}
+
+void DJAudioPlayer::setMappedReader(MemoryMappedAudioFormatReader *reader)
+{
+    // Uncompressed samples are converted straight from the mapped file, no read-ahead copy needed.
+    if (decodeThread == nullptr)
+    {
+        std::cout << "DJAudioPlayer::Can't stream a track without a decode thread, only decoded tracks can be loaded" << std::endl;
+        delete reader;
+        return;
+    }
+
+    const auto sampleRate = reader->sampleRate;
+    std::unique_ptr<MappedTrackSource> newMapped(new MappedTrackSource(reader, *decodeThread, readAheadSeconds));
+    swapSource(nullptr, std::move(newMapped), nullptr, sampleRate);
+}
+
+void DJAudioPlayer::setDecodedTrack(std::shared_ptr<const DecodedTrack> track)
+{
+    // The whole track is in memory, so there is nothing to decode ahead of the playhead.
+    std::unique_ptr<DecodedTrackSource> newDecoded(new DecodedTrackSource(track));
+    swapSource(nullptr, nullptr, std::move(newDecoded), track->sampleRate);
+}
+
+void DJAudioPlayer::swapSource(std::unique_ptr<ReadAheadBuffer> newReadAhead,
+                               std::unique_ptr<MappedTrackSource> newMapped,
+                               std::unique_ptr<DecodedTrackSource> newDecoded,
+                               double sampleRate)
+{
+    // The transport swaps the pointer under its audio lock; the old source is
+    // only deleted once the audio thread can no longer be using it.
+    PositionableAudioSource *newSource = newReadAhead != nullptr ? (PositionableAudioSource *)newReadAhead.get()
+                                         : newMapped != nullptr  ? (PositionableAudioSource *)newMapped.get()
+                                                                 : (PositionableAudioSource *)newDecoded.get();
+
+    // No rate is given to the transport, so it doesn't resample; the deck's resampler does that
+    // together with the speed. The transport is prepared at the track's rate instead.
+    std::unique_ptr<HotCueSource> newHotCueSource(new HotCueSource(*newSource));
+    std::unique_ptr<LoopEngine> newLoopEngine(new LoopEngine(*newHotCueSource));
+
+    // A new rate is set while the transport has no source, so its audio lock only covers storing
+    // the rate. setSource() then prepares the new chain once, at that rate, outside the lock,
+    // and the other decks in the same callback never wait for it.
+    if (preparedBlockSize > 0 && sampleRate != sourceSampleRate)
+    {
+        transportSource.setSource(nullptr);
+        transportSource.prepareToPlay(preparedBlockSize, sampleRate);
+    }
+
+    transportSource.setSource(newLoopEngine.get(), 0, nullptr, 0.0);
+
+    // The old loop engine refers to the old hot cue source, which refers to the old track source.
+    loopEngine = std::move(newLoopEngine);
+    hotCueSource = std::move(newHotCueSource);
+    readAheadSource = std::move(newReadAhead);
+    mappedSource = std::move(newMapped);
+    decodedSource = std::move(newDecoded);
+    sourceSampleRate = sampleRate;
+    trackSampleRate = sampleRate;
+
+    // The new track starts without hot cues until they are set.
+    hotCues.fill(-1);
+    ++trackGeneration;
+}
+
 void DJAudioPlayer::start()
 {
     // Start playback of the audio.
+    transportEvents.push({TransportEvent::cancel, nullptr});
     transportSource.start();
 }
 
+void DJAudioPlayer::startOnBeat(const DJAudioPlayer *reference)
+{
+    // The event goes first, so the audio thread holds the deck before it sees the transport playing.
+    if (!quantize || reference == nullptr || reference == this)
+    {
+        start();
+    }
+    else
+    {
+        transportEvents.push({TransportEvent::startOnBeat, reference});
+        transportSource.start();
+    }
+}
+
 void DJAudioPlayer::stop()
 {
     // Stop playback of the audio.
+    transportEvents.push({TransportEvent::cancel, nullptr});
     transportSource.stop();
 }
 
+void DJAudioPlayer::setQuantize(bool shouldQuantize)
+{
+    // Set whether deck actions wait for the beat grid.
+    quantize = shouldQuantize;
+}
+
+bool DJAudioPlayer::isQuantized() const
+{
+    // Get whether deck actions wait for the beat grid.
+    return quantize;
+}
+
+LoopEngine::Timing DJAudioPlayer::getTiming(LoopEngine::Timing quantized) const
+{
+    // A stopped deck has no next beat to wait for.
+    return quantize && transportSource.isPlaying() && hasBeatGrid() ? quantized : LoopEngine::Timing::now;
+}
+
+void DJAudioPlayer::setBeatGrid(double downbeatSeconds, double beatPeriodSeconds)
+{
+    // Set the beat grid of the loaded track.
+    if (beatPeriodSeconds < 0)
+    {
+        std::cout << "DJAudioPlayer::Invalid beat period: " << beatPeriodSeconds << "Beat period should be 0 or more" << std::endl;
+    }
+    else
+    {
+        downbeat = downbeatSeconds;
+        beatPeriod = beatPeriodSeconds;
+
+        // The loop engine times scheduled changes in samples of the track.
+        if (loopEngine != nullptr)
+        {
+            loopEngine->setBeatGrid(downbeatSeconds * sourceSampleRate, beatPeriodSeconds * sourceSampleRate);
+        }
+    }
+}
+
+void DJAudioPlayer::setSyncLeader(DJAudioPlayer *leader)
+{
+    // Follow another deck, as long as that doesn't close a loop of decks following each other.
+    // Walk up the leader's own leaders; if this deck is among them, the decks would chase each other.
+    for (auto *deck = leader; deck != nullptr; deck = deck->getSyncLeader())
+    {
+        if (deck == this)
+        {
+            std::cout << "DJAudioPlayer::Invalid sync leader: a deck can't follow itself or a deck that follows it" << std::endl;
+            return;
+        }
+    }
+
+    syncLeader = leader;
+}
+
+DJAudioPlayer *DJAudioPlayer::getSyncLeader() const
+{
+    return syncLeader.load();
+}
+
+bool DJAudioPlayer::isPlaying() const
+{
+    return transportSource.isPlaying();
+}
+
+bool DJAudioPlayer::hasBeatGrid() const
+{
+    return beatPeriod.load() > 0.0;
+}
+
+float DJAudioPlayer::getCurrentSpeed() const
+{
+    return publishedSpeed.load();
+}
+
 void DJAudioPlayer::setGain(float gain)
 {
     // Set the gain (volume) of the audio.
@@ -80,20 +646,20 @@ void DJAudioPlayer::setGain(float gain)
     }
     else
     {
-        transportSource.setGain(gain);
+        targetGain = gain;
     }
 }
 
 void DJAudioPlayer::setSpeed(float ratio)
 {
     // Set the speed (resampling ratio) of the audio.
-    if (ratio < 0 || ratio > 100.0)
+    if (ratio <= 0 || ratio > 100.0)
     {
-        std::cout << "DJAudioPlayer::Invalid speed value: " << ratio << "Speed should be between 0 and 100.0" << std::endl;
+        std::cout << "DJAudioPlayer::Invalid speed value: " << ratio << "Speed should be above 0 and at most 100.0" << std::endl;
     }
     else
     {
-        resamplingSource.setResamplingRatio(ratio);
+        targetSpeed = ratio;
     }
 }
 
@@ -130,22 +696,360 @@ double DJAudioPlayer::getPositionRelative() const
     }
 }
 
+void DJAudioPlayer::setReadAheadSeconds(double seconds)
+{
+    // Set the size of the read-ahead buffer, applied to the current and future tracks.
+    if (seconds <= 0.0 || seconds > 60.0)
+    {
+        std::cout << "DJAudioPlayer::Invalid read-ahead value: " << seconds << "Read-ahead should be between 0 and 60.0 seconds" << std::endl;
+    }
+    else
+    {
+        readAheadSeconds = seconds;
+
+        if (readAheadSource != nullptr)
+        {
+            readAheadSource->setReadAheadSeconds(seconds);
+        }
+
+        if (mappedSource != nullptr)
+        {
+            mappedSource->setReadAheadSeconds(seconds);
+        }
+    }
+}
+
+double DJAudioPlayer::getReadAheadSeconds() const
+{
+    // Get the size of the read-ahead buffer.
+    return readAheadSeconds;
+}
+
+float DJAudioPlayer::getBufferFillLevel() const
+{
+    // Get the fill level of the read-ahead buffer. A decoded track is always full.
+    if (decodedSource != nullptr)
+    {
+        return 1.0f;
+    }
+
+    if (mappedSource != nullptr)
+    {
+        return mappedSource->getFillLevel();
+    }
+
+    return readAheadSource != nullptr ? readAheadSource->getFillLevel() : 0.0f;
+}
+
+int DJAudioPlayer::getUnderrunCount() const
+{
+    // Get the number of blocks that weren't decoded in time.
+    return readAheadSource != nullptr ? readAheadSource->getUnderrunCount() : 0;
+}
+
+void DJAudioPlayer::setDecodeIntoMemory(bool shouldDecode)
+{
+    // Set whether new tracks are decoded into memory when loaded.
+    decodeIntoMemory = shouldDecode;
+}
+
+bool DJAudioPlayer::isDecodingIntoMemory() const
+{
+    // Get whether new tracks are decoded into memory when loaded.
+    return decodeIntoMemory;
+}
+
+void DJAudioPlayer::setLoopInAtPlayhead()
+{
+    // Set the loop in point at the playhead.
+    if (loopEngine != nullptr)
+    {
+        loopEngine->setLoopInAtPlayhead(getTiming(LoopEngine::Timing::nextBeat));
+    }
+}
+
+void DJAudioPlayer::setLoopOutAtPlayhead()
+{
+    // Set the loop out point at the playhead.
+    if (loopEngine != nullptr)
+    {
+        loopEngine->setLoopOutAtPlayhead(getTiming(LoopEngine::Timing::nextBeat));
+    }
+}
+
+void DJAudioPlayer::setLoopEnabled(bool shouldLoop)
+{
+    // Turn the loop on straight away, and with quantize on leave it on the next bar.
+    if (loopEngine != nullptr)
+    {
+        loopEngine->setLoopEnabled(shouldLoop, shouldLoop ? LoopEngine::Timing::now : getTiming(LoopEngine::Timing::nextBar));
+    }
+}
+
+bool DJAudioPlayer::isLoopEnabled() const
+{
+    // Get whether the loop is on.
+    return loopEngine != nullptr && loopEngine->isLoopEnabled();
+}
+
+bool DJAudioPlayer::hasLoop() const
+{
+    // Get whether the loop points make a loop.
+    return loopEngine != nullptr && loopEngine->getLoopOutSample() > loopEngine->getLoopInSample();
+}
+
+void DJAudioPlayer::halveLoop()
+{
+    // Halve the length of the loop.
+    if (loopEngine != nullptr)
+    {
+        loopEngine->halveLoop();
+    }
+}
+
+void DJAudioPlayer::doubleLoop()
+{
+    // Double the length of the loop.
+    if (loopEngine != nullptr)
+    {
+        loopEngine->doubleLoop();
+    }
+}
+
+void DJAudioPlayer::startLoopRoll(double lengthInSecs)
+{
+    // Start a loop roll of the given length.
+    if (lengthInSecs <= 0.0)
+    {
+        std::cout << "DJAudioPlayer::Invalid loop roll length: " << lengthInSecs << "Length should be above 0" << std::endl;
+    }
+    else if (loopEngine != nullptr)
+    {
+        loopEngine->startLoopRoll((int64)(lengthInSecs * sourceSampleRate));
+    }
+}
+
+void DJAudioPlayer::stopLoopRoll()
+{
+    // Stop the loop roll.
+    if (loopEngine != nullptr)
+    {
+        loopEngine->stopLoopRoll();
+    }
+}
+
+void DJAudioPlayer::setHotCueAtPlayhead(int index)
+{
+    // Set a hot cue at the playhead.
+    if (index < 0 || index >= HotCueSource::numCues || loopEngine == nullptr)
+    {
+        std::cout << "DJAudioPlayer::Invalid hot cue: " << index << "Hot cue should be 0 to " << HotCueSource::numCues - 1 << " with a track loaded" << std::endl;
+    }
+    else
+    {
+        hotCues[(size_t)index] = loopEngine->getNextReadPosition();
+        decodeAttack(index);
+    }
+}
+
+void DJAudioPlayer::clearHotCue(int index)
+{
+    // Clear a hot cue and drop its attack buffer.
+    if (index < 0 || index >= HotCueSource::numCues)
+    {
+        std::cout << "DJAudioPlayer::Invalid hot cue: " << index << "Hot cue should be 0 to " << HotCueSource::numCues - 1 << std::endl;
+    }
+    else
+    {
+        hotCues[(size_t)index] = -1;
+        decodeAttack(index);
+    }
+}
+
+void DJAudioPlayer::setHotCues(const HotCueSource::Cues &cues)
+{
+    // Replace every hot cue of the loaded track.
+    hotCues = cues;
+
+    for (int index = 0; index < HotCueSource::numCues; ++index)
+    {
+        decodeAttack(index);
+    }
+}
+
+const HotCueSource::Cues &DJAudioPlayer::getHotCues() const
+{
+    return hotCues;
+}
+
+void DJAudioPlayer::triggerHotCue(int index)
+{
+    // Jump on the audio thread, so the cue plays from the very next block or on the beat.
+    if (index < 0 || index >= HotCueSource::numCues || hotCues[(size_t)index] < 0 || loopEngine == nullptr)
+    {
+        return;
+    }
+
+    const auto playing = transportSource.isPlaying();
+    loopEngine->jumpTo(hotCues[(size_t)index], playing, getTiming(LoopEngine::Timing::nextBeat));
+
+    if (!playing)
+    {
+        start();
+    }
+}
+
+void DJAudioPlayer::jumpBeats(int beats)
+{
+    // Jump along the beat grid on the audio thread, on the next beat with quantize on. A stopped
+    // deck doesn't render, so its playhead is moved straight away instead.
+    if (loopEngine == nullptr || !hasBeatGrid())
+    {
+        return;
+    }
+
+    if (transportSource.isPlaying())
+    {
+        loopEngine->jumpBeats(beats, true, getTiming(LoopEngine::Timing::nextBeat));
+    }
+    else
+    {
+        transportSource.setPosition(jmax(0.0, transportSource.getCurrentPosition() + beats * beatPeriod.load()));
+    }
+}
+
+void DJAudioPlayer::decodeAttack(int index)
+{
+    // The old attack buffer is dropped straight away, since the cue has moved.
+    if (hotCueSource == nullptr)
+    {
+        return;
+    }
+
+    hotCueSource->setAttack(index, 0, nullptr);
+    const auto startSample = hotCues[(size_t)index];
+
+    if (startSample >= 0 && loadedFile != File())
+    {
+        cuePool.addJob(new AttackJob(WeakReference<DJAudioPlayer>(this), formatManager, loadedFile,
+                                     trackGeneration, index, startSample),
+                       true);
+    }
+}
+
+void DJAudioPlayer::attackDecoded(int generation, int index, int64 startSample, std::shared_ptr<const AudioBuffer<float>> samples)
+{
+    // Only use the buffer if it is still for the loaded track and the cue hasn't moved.
+    if (generation == trackGeneration && hotCues[(size_t)index] == startSample && hotCueSource != nullptr)
+    {
+        hotCueSource->setAttack(index, startSample, std::move(samples));
+    }
+}
+
+void DJAudioPlayer::setKeyLock(bool shouldLock)
+{
+    // Switch between the resampler and the time-stretcher; the audio thread picks this up on the next block.
+    keyLock = shouldLock;
+}
+
+bool DJAudioPlayer::isKeyLockEnabled() const
+{
+    // Get whether key lock is on.
+    return keyLock.load();
+}
+
+void DJAudioPlayer::setKeyLockQuality(TimeStretchAudioSource::Quality quality)
+{
+    // Set the quality of the time-stretcher.
+    stretchSource.setQuality(quality);
+}
+
+void DJAudioPlayer::setResamplerQuality(SincResamplingAudioSource::Quality quality)
+{
+    // Set the quality of both resamplers.
+    resampler.setQuality(quality);
+    keyLockResampler.setQuality(quality);
+}
+
+void DJAudioPlayer::setTrim(float gain)
+{
+    // Set the trim, applied before the EQ.
+    if (gain < 0 || gain > 4)
+    {
+        std::cout << "DJAudioPlayer::Invalid trim value: " << gain << "Trim should be between 0 and 4" << std::endl;
+    }
+    else
+    {
+        targetTrim = gain;
+    }
+}
+
+void DJAudioPlayer::setAutoGain(float gain)
+{
+    // Set the loudness matching gain of the loaded track.
+    if (gain < 0 || gain > 4)
+    {
+        std::cout << "DJAudioPlayer::Invalid auto gain value: " << gain << "Auto gain should be between 0 and 4" << std::endl;
+    }
+    else
+    {
+        targetAutoGain = gain;
+    }
+}
+
+void DJAudioPlayer::setEqGain(int band, float gain)
+{
+    // Set the gain of one EQ band.
+    if (band < 0 || band > 2 || gain < 0 || gain > 4)
+    {
+        std::cout << "DJAudioPlayer::Invalid EQ value: band " << band << " gain " << gain << "Band should be 0 to 2 and gain between 0 and 4" << std::endl;
+    }
+    else
+    {
+        eqGains[band] = gain;
+    }
+}
+
+void DJAudioPlayer::setEqKill(int band, bool shouldKill)
+{
+    // Kill or restore one EQ band.
+    if (band < 0 || band > 2)
+    {
+        std::cout << "DJAudioPlayer::Invalid EQ band: " << band << "Band should be 0 to 2" << std::endl;
+    }
+    else
+    {
+        eqKills[band] = shouldKill;
+    }
+}
+
 // found on the forum: forum.juce.com/t/bass-treble-mid-equaliser/52245/7
 
 // This function sets the low-pass filter for the audio player.
 // A low-pass filter allows frequencies below a certain cutoff frequency to pass through,
 // while attenuating frequencies above the cutoff frequency.
+// The cutoff glides to the new value on the audio thread.
 void DJAudioPlayer::setLowPass(double frequency)
 {
-    auto *reader = readerSource->getAudioFormatReader();
-    IIRCoefficients coeffs = IIRCoefficients::makeLowPass(reader->sampleRate, frequency);
-    lowpassSource.setCoefficients(coeffs);
+    if (frequency <= 0.0)
+    {
+        std::cout << "DJAudioPlayer::Invalid low-pass frequency: " << frequency << "Frequency should be above 0" << std::endl;
+    }
+    else
+    {
+        targetLowPass = (float)frequency;
+    }
 }
 
 // Similar to the low-pass filter, this function sets the high-pass filter for the audio player.
 void DJAudioPlayer::setHighPass(double frequency)
 {
-    auto *reader = readerSource->getAudioFormatReader();
-    IIRCoefficients coeffs = IIRCoefficients::makeHighPass(reader->sampleRate, frequency);
-    basefilterSource.setCoefficients(coeffs);
-}
\ No newline at end of file
+    if (frequency <= 0.0)
+    {
+        std::cout << "DJAudioPlayer::Invalid high-pass frequency: " << frequency << "Frequency should be above 0" << std::endl;
+    }
+    else
+    {
+        targetHighPass = (float)frequency;
+    }
+}
@@ -10,6 +10,14 @@
 
 #pragma once
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "ReadAheadBuffer.h"
+#include "MappedTrackSource.h"
+#include "LoopEngine.h"
+#include "HotCueSource.h"
+#include "TimeStretchAudioSource.h"
+#include "SincResamplingAudioSource.h"
+#include "DeckProcessor.h"
+#include "TrackLoader.h"
 
 class DJAudioPlayer : public AudioSource
 {
@@ -17,8 +25,10 @@ public:
 	/**
 		Constructor.
 		@param formatManager The AudioFormatManager object used for loading audio files.
+		@param decodeThread The background thread shared by all decks for decoding ahead of the playhead,
+							or nullptr for a deck that only plays tracks decoded into memory.
 	*/
-	DJAudioPlayer(AudioFormatManager &formatManager);
+	DJAudioPlayer(AudioFormatManager &formatManager, TimeSliceThread *decodeThread);
 
 	/**
 		Destructor.
@@ -49,16 +59,47 @@ public:
 	*/
 	void loadURL(URL audioURL);
 
+	/**
+		Swaps a track that was opened by the TrackLoader into the deck. Only the
+		pointer swap happens under the audio lock, so playback is not interrupted
+		while the track is being opened.
+		@param track The loaded track. Its player reader is taken by this object.
+	*/
+	void loadTrack(LoadedTrack &track);
+
 	/**
 		Starts playback of the audio.
 	*/
 	void start();
 
 	/**
-		Stops playback of the audio.
+		Starts playback on the next beat of another deck. The transport starts straight
+		away, but the audio thread keeps the deck silent and its playhead still until the
+		sample where that deck's next beat falls. Starts straight away if quantize is off
+		or the other deck isn't playing a track with a beat grid.
+		@param reference The deck to start in time with, or nullptr.
+	*/
+	void startOnBeat(const DJAudioPlayer *reference);
+
+	/**
+		Stops playback of the audio, and drops a start that is waiting for its beat.
 	*/
 	void stop();
 
+	/**
+		Sets whether deck actions wait for the beat grid. With quantize on, loop points,
+		hot cues and beat jumps happen on the next beat, and leaving a loop happens on the
+		next bar or at the loop's end. Actions happen straight away while the deck is
+		stopped or the track has no beat grid.
+		@param shouldQuantize True to line actions up with the beat grid.
+	*/
+	void setQuantize(bool shouldQuantize);
+
+	/**
+		Returns whether deck actions wait for the beat grid.
+	*/
+	bool isQuantized() const;
+
 	/**
 		Sets the gain (volume) of the audio.
 		@param gain The gain value, ranging from 0.0 to 1.0.
@@ -101,13 +142,392 @@ public:
 	*/
 	double getPositionRelative() const;
 
+	/**
+		Sets how much audio this deck decodes ahead of the playhead on the background thread.
+		@param seconds The read-ahead size in seconds.
+	*/
+	void setReadAheadSeconds(double seconds);
+
+	/**
+		Returns how much audio this deck decodes ahead of the playhead.
+		@return The read-ahead size in seconds.
+	*/
+	double getReadAheadSeconds() const;
+
+	/**
+		Returns how full the read-ahead buffer is.
+		@return The fill level, where 0.0 is empty and 1.0 is full. Returns 0.0 when no track is loaded.
+	*/
+	float getBufferFillLevel() const;
+
+	/**
+		Returns the number of audio blocks that were not decoded in time since the track was loaded.
+		@return The number of underruns.
+	*/
+	int getUnderrunCount() const;
+
+	/**
+		Sets whether tracks loaded from now on are fully decoded into memory. Seeking in
+		a decoded track is instant, and a recently played track is taken from the cache.
+		@param shouldDecode True to decode into memory, false to stream from the file.
+	*/
+	void setDecodeIntoMemory(bool shouldDecode);
+
+	/**
+		Returns whether tracks are fully decoded into memory when loaded.
+		@return True if decoding into memory, false if streaming.
+	*/
+	bool isDecodingIntoMemory() const;
+
+	/**
+		Sets the loop in point to the current playhead position.
+	*/
+	void setLoopInAtPlayhead();
+
+	/**
+		Sets the loop out point to the current playhead position.
+	*/
+	void setLoopOutAtPlayhead();
+
+	/**
+		Turns the loop on or off. With quantize on, the loop is left on the next bar.
+		@param shouldLoop True to loop between the in and out points.
+	*/
+	void setLoopEnabled(bool shouldLoop);
+
+	/**
+		Returns whether the loop is on.
+		@return True if looping.
+	*/
+	bool isLoopEnabled() const;
+
+	/**
+		Returns whether the loaded track has a loop to turn on, as last applied by the audio thread.
+	*/
+	bool hasLoop() const;
+
+	/**
+		Halves the length of the loop, keeping the in point.
+	*/
+	void halveLoop();
+
+	/**
+		Doubles the length of the loop, keeping the in point.
+	*/
+	void doubleLoop();
+
+	/**
+		Starts a loop roll from the playhead. The track keeps running underneath,
+		so playback carries on where it would have been when the roll stops.
+		@param lengthInSecs The length of the rolled loop in seconds.
+	*/
+	void startLoopRoll(double lengthInSecs);
+
+	/**
+		Ends the loop roll.
+	*/
+	void stopLoopRoll();
+
+	/**
+		Sets a hot cue at the playhead and starts decoding its attack buffer.
+		@param index The hot cue, from 0 to HotCueSource::numCues - 1.
+	*/
+	void setHotCueAtPlayhead(int index);
+
+	/**
+		Clears a hot cue.
+		@param index The hot cue, from 0 to HotCueSource::numCues - 1.
+	*/
+	void clearHotCue(int index);
+
+	/**
+		Replaces all the hot cues of the loaded track, e.g. with the ones stored for it,
+		and starts decoding their attack buffers.
+		@param cues The position of each cue in samples of the track, -1 for cues that aren't set.
+	*/
+	void setHotCues(const HotCueSource::Cues &cues);
+
+	/**
+		Returns the hot cues of the loaded track.
+	*/
+	const HotCueSource::Cues &getHotCues() const;
+
+	/**
+		Jumps to a hot cue at the start of the next block, or on the next beat with
+		quantize on, and plays from there. The start of the cue is played from its attack
+		buffer while the track catches up.
+		@param index The hot cue, from 0 to HotCueSource::numCues - 1.
+	*/
+	void triggerHotCue(int index);
+
+	/**
+		Moves the playhead a number of beats along the beat grid, keeping its place in
+		the beat. Nothing happens if the track has no beat grid.
+		@param beats How far to jump, negative to jump back.
+	*/
+	void jumpBeats(int beats);
+
+	/**
+		Turns key lock on or off. With key lock on, the speed changes the tempo
+		without changing the pitch.
+		@param shouldLock True to keep the pitch when the speed changes.
+	*/
+	void setKeyLock(bool shouldLock);
+
+	/**
+		Returns whether key lock is on.
+		@return True if the pitch is kept when the speed changes.
+	*/
+	bool isKeyLockEnabled() const;
+
+	/**
+		Sets the quality/CPU setting of the key lock time-stretcher.
+		@param quality The new quality setting.
+	*/
+	void setKeyLockQuality(TimeStretchAudioSource::Quality quality);
+
+	/**
+		Sets the quality/CPU setting of the resampler that applies the speed and the
+		track's sample rate.
+		@param quality The new quality setting.
+	*/
+	void setResamplerQuality(SincResamplingAudioSource::Quality quality);
+
+	/**
+		Sets the trim, applied before the EQ to match the level of different tracks.
+		@param gain The linear trim gain, ranging from 0.0 to 4.0.
+	*/
+	void setTrim(float gain);
+
+	/**
+		Sets the gain that matches the loaded track's loudness to the other tracks. It is
+		applied together with the trim, so the trim still works on top of it.
+		@param gain The linear gain, ranging from 0.0 to 4.0, where 1.0 leaves the track unchanged.
+	*/
+	void setAutoGain(float gain);
+
+	/**
+		Sets the gain of one band of the 3-band EQ.
+		@param band The band: 0 for low, 1 for mid and 2 for high.
+		@param gain The linear gain, ranging from 0.0 to 4.0, where 1.0 leaves the band unchanged.
+	*/
+	void setEqGain(int band, float gain);
+
+	/**
+		Kills or restores one band of the 3-band EQ, keeping its gain setting.
+		@param band The band: 0 for low, 1 for mid and 2 for high.
+		@param shouldKill True to silence the band.
+	*/
+	void setEqKill(int band, bool shouldKill);
+
+	/**
+		Sets the beat grid of the loaded track, which sync needs on both decks.
+		@param downbeatSeconds The time of the first downbeat.
+		@param beatPeriodSeconds The length of a beat, or 0 if the track has no beat grid.
+	*/
+	void setBeatGrid(double downbeatSeconds, double beatPeriodSeconds);
+
+	/**
+		Makes this deck follow another deck's tempo and beat phase. The speed is
+		corrected on the audio thread at the start of every block from both decks'
+		playheads, so the decks never drift apart.
+		The leader is refused if it follows this deck, directly or through other decks.
+		@param leader The deck to follow, or nullptr to stop following and go back to the speed slider.
+	*/
+	void setSyncLeader(DJAudioPlayer *leader);
+
+	/**
+		Returns the deck this deck follows, or nullptr if sync is off.
+	*/
+	DJAudioPlayer *getSyncLeader() const;
+
+	/**
+		Returns whether the deck is playing.
+	*/
+	bool isPlaying() const;
+
+	/**
+		Returns whether the loaded track has a beat grid.
+	*/
+	bool hasBeatGrid() const;
+
+	/**
+		Returns the speed the deck is playing at, including any sync correction.
+	*/
+	float getCurrentSpeed() const;
+
 private:
+	class AttackJob;
+
+	// A change to the transport, sent from the message thread to the audio thread.
+	struct TransportEvent
+	{
+		enum Type
+		{
+			startOnBeat, // Hold the deck until the reference deck's next beat
+			cancel		 // Drop a start that is waiting
+		};
+
+		Type type = cancel;
+		const DJAudioPlayer *reference = nullptr;
+	};
+
+	/**
+		Returns when a deck action should happen: the given timing with quantize on,
+		or straight away if quantize is off, the deck is stopped or there is no beat grid.
+		@param quantized The timing to use with quantize on.
+	*/
+	LoopEngine::Timing getTiming(LoopEngine::Timing quantized) const;
+
+	/**
+		Applies the transport events and works out where a waiting start happens in this
+		block. Only called on the audio thread.
+		@param numSamples The length of the block being rendered.
+		@return The number of samples to keep silent before the deck plays, numSamples to stay silent for the whole block.
+	*/
+	int applyTransportEvents(int numSamples);
+
+	/**
+		Works out the sample of the render clock where another deck's next beat falls.
+		Only called on the audio thread.
+		@param reference The deck to start in time with.
+		@return The sample on renderedSamples' clock, or -1 if that deck isn't playing with a beat grid.
+	*/
+	int64 getNextBeatClock(const DJAudioPlayer &reference) const;
+
+	/**
+		Decodes the attack buffer of a hot cue on the cue thread, if the track is
+		streamed from a file. Tracks in memory don't need one.
+		@param index The hot cue.
+	*/
+	void decodeAttack(int index);
+
+	/**
+		Hands a decoded attack buffer to the track's HotCueSource, unless the track or
+		the cue has changed since it was requested.
+	*/
+	void attackDecoded(int generation, int index, int64 startSample, std::shared_ptr<const AudioBuffer<float>> samples);
+
+	/**
+		Wraps a reader in the read-ahead chain and makes it the deck's source.
+		@param reader The reader to play, which this object takes ownership of.
+	*/
+	void setReader(AudioFormatReader *reader);
+
+	/**
+		Makes a track that is already decoded in memory the deck's source.
+		@param track The decoded track.
+	*/
+	void setDecodedTrack(std::shared_ptr<const DecodedTrack> track);
+
+	/**
+		Makes a memory-mapped WAV or AIFF file the deck's source.
+		@param reader A reader that has mapped the whole file, which this object takes ownership of.
+	*/
+	void setMappedReader(MemoryMappedAudioFormatReader *reader);
+
+	/**
+		Moves the speed and filter cutoffs towards their targets and passes the
+		latest parameters to the resampler and the deck processor. Only called on the audio thread.
+		@param numSamples The length of the block being rendered.
+	*/
+	void updateParameters(int numSamples);
+
+	/**
+		Publishes this deck's beat position and tempo for the decks that follow it.
+		Only called on the audio thread.
+	*/
+	void publishBeatPosition();
+
+	/**
+		Returns how far the transport's position runs ahead of what is heard, because the
+		resampler or the time-stretcher has already pulled input it hasn't played yet.
+		Only called on the audio thread.
+		@return The latency in seconds of the track.
+	*/
+	double getChainLatency() const;
+
+	/**
+		Works out the speed that matches the leader's tempo and pulls this deck
+		towards the leader's beat phase. Only called on the audio thread.
+		@param leader The deck being followed.
+		@return The speed, or 0 if either deck has no beat grid.
+	*/
+	float getSyncSpeed(const DJAudioPlayer &leader) const;
+
+	/**
+		Swaps a new source into the transport and deletes the previous one.
+		Only one of the source pointers is set after this call. The transport runs at
+		the source's sample rate, and the resampler converts to the device rate.
+		@param sampleRate The sample rate of the new source.
+	*/
+	void swapSource(std::unique_ptr<ReadAheadBuffer> newReadAhead,
+					std::unique_ptr<MappedTrackSource> newMapped,
+					std::unique_ptr<DecodedTrackSource> newDecoded,
+					double sampleRate);
+
 	AudioFormatManager &formatManager;					   // Reference to the AudioFormatManager object
-	std::unique_ptr<AudioFormatReaderSource> readerSource; // Unique pointer to the AudioFormatReaderSource object
+	TimeSliceThread *decodeThread;						   // Background thread shared by the decks for decoding, nullptr if there is none
+	double readAheadSeconds = 2.0;						   // Size of the read-ahead buffer in seconds
+	bool decodeIntoMemory = false;						   // Whether new tracks are fully decoded into memory
+	double sourceSampleRate = 0.0;						   // Sample rate of the loaded track, 0 when nothing is loaded
+	std::unique_ptr<ReadAheadBuffer> readAheadSource;	   // Decodes a compressed track ahead of the playhead on decodeThread
+	std::unique_ptr<MappedTrackSource> mappedSource;	   // Plays a WAV or AIFF file straight from memory-mapped pages
+	std::unique_ptr<DecodedTrackSource> decodedSource;	   // Plays a track that was decoded into memory
+	std::unique_ptr<HotCueSource> hotCueSource;			   // Plays the start of hot cues from memory
+	std::unique_ptr<LoopEngine> loopEngine;				   // Applies loops between the track source and the transport
+	HotCueSource::Cues hotCues;							   // Hot cues of the loaded track in samples, -1 if not set
+	File loadedFile;									   // The loaded track if it is streamed from a local file
+	int trackGeneration = 0;							   // Counts loaded tracks, so late attack buffers are dropped
+	ThreadPool cuePool{1};								   // Decodes attack buffers
+	bool quantize = false;								   // Whether deck actions wait for the beat grid
+	LockFreeQueue<TransportEvent, 16> transportEvents;	   // Starts and cancels waiting for the audio thread
+
+	// Written by the message thread, read by the audio thread at the start of each block
+	std::atomic<float> targetGain{1.0f};	 // Gain set by the volume slider
+	std::atomic<float> targetSpeed{1.0f};	 // Speed set by the speed slider
+	std::atomic<float> targetHighPass{0.0f}; // High-pass cutoff in Hz, 0 until the knob is first moved
+	std::atomic<float> targetLowPass{0.0f};	 // Low-pass cutoff in Hz, 0 until the knob is first moved
+	std::atomic<bool> keyLock{false};		 // Whether the time-stretcher is used instead of the resampler
+	std::atomic<double> trackSampleRate{0.0}; // Sample rate of the loaded track, 0 when nothing is loaded
+	std::atomic<float> targetTrim{1.0f};	 // Trim before the EQ
+	std::atomic<float> targetAutoGain{1.0f}; // Loudness matching gain of the loaded track, applied with the trim
+	std::atomic<float> eqGains[3]{{1.0f}, {1.0f}, {1.0f}}; // Gain of the low, mid and high EQ bands
+	std::atomic<bool> eqKills[3]{{false}, {false}, {false}}; // Whether each EQ band is killed
+	std::atomic<double> downbeat{0.0};					  // Time of the first downbeat in seconds
+	std::atomic<double> beatPeriod{0.0};				  // Length of a beat in seconds, 0 without a beat grid
+	std::atomic<DJAudioPlayer *> syncLeader{nullptr};	  // The deck being followed, or nullptr
+
+	// Written by the audio thread for following decks and the GUI. All decks render on the
+	// same audio thread, one after another, so a follower never sees a half-written set.
+	std::atomic<double> publishedBeat{0.0};			   // Beat position at the start of the last block
+	std::atomic<double> publishedBeatsPerSecond{0.0}; // Tempo at the current speed, 0 without a beat grid
+	std::atomic<int64> publishedClock{0};			   // renderedSamples when the beat position was published
+	std::atomic<bool> publishedPlaying{false};		   // Whether the deck was playing during the last block
+	std::atomic<float> publishedSpeed{1.0f};		   // Speed of the last block
+
+	// Only used by the audio thread
+	SmoothedValue<float, ValueSmoothingTypes::Multiplicative> smoothedSpeed{1.0f};			 // Speed glide
+	SmoothedValue<float, ValueSmoothingTypes::Multiplicative> smoothedHighPass{1.0f};		 // High-pass cutoff glide
+	SmoothedValue<float, ValueSmoothingTypes::Multiplicative> smoothedLowPass{1.0f};		 // Low-pass cutoff glide
+	float appliedSpeed = 1.0f;																 // Speed last given to the resampler
+	double appliedRateRatio = 1.0;															 // Track rate over device rate last given to the resamplers
+	float appliedHighPass = 0.0f;															 // Cutoff last given to the high-pass filter
+	float appliedLowPass = 0.0f;															 // Cutoff last given to the low-pass filter
+	bool highPassActive = false;															 // Whether the high-pass filter has been set
+	bool lowPassActive = false;																 // Whether the low-pass filter has been set
+	bool keyLockActive = false;																 // Whether the last block went through the time-stretcher
+	double deviceSampleRate = 44100.0;														 // Sample rate the deck renders at
+	int preparedBlockSize = 0;																 // Block size of the last prepareToPlay, 0 until prepared
+	int64 renderedSamples = 0;																 // Samples rendered since prepareToPlay, the clock sync is measured against
+	int64 startClock = -1;																	 // Sample of renderedSamples' clock where a waiting start happens, -1 if none
+
 	AudioTransportSource transportSource;				   // AudioTransportSource object for playback control
 
-	IIRFilterAudioSource basefilterSource{&transportSource, false}; // IIRFilterAudioSource object for base filtering
-	IIRFilterAudioSource lowpassSource{&basefilterSource, false};	// IIRFilterAudioSource object for low-pass filtering
+	SincResamplingAudioSource resampler{&transportSource, false, 2};		  // Applies the speed and the track's sample rate in one pass
+	TimeStretchAudioSource stretchSource{&transportSource, false, 2};		  // Changes the tempo without the pitch when key lock is on
+	SincResamplingAudioSource keyLockResampler{&stretchSource, false, 2}; // Converts the time-stretcher's output to the device rate
+	DeckProcessor deckProcessor;											  // Trim, EQ, filters and gain at the device rate
 
-	ResamplingAudioSource resamplingSource{&lowpassSource, false, 2}; // ResamplingAudioSource object for resampling
+	JUCE_DECLARE_WEAK_REFERENCEABLE(DJAudioPlayer)
 };
\ No newline at end of file
@@ -11,28 +11,55 @@
 #include <JuceHeader.h>
 #include "DeckGUI.h"
 
+// Tracks are played back at the ReplayGain 2.0 reference loudness.
+static constexpr double autoGainTarget = -18.0;
+
 //==============================================================================
 
 DeckGUI::DeckGUI(DJAudioPlayer *_player,
                  AudioFormatManager &formatManagerToUse,
-                 AudioThumbnailCache &cacheToUse)
+                 AudioThumbnailCache &cacheToUse,
+                 TrackLoader &loader,
+                 WaveformStore &waveformStore,
+                 TrackAnalyser &analyser)
     : player(_player),
-      waveformDisplay(formatManagerToUse, cacheToUse),
-      cue(0.0),
-      rotationAngle(0.0),
-      loopMode(false),
-      in(0.0),
-      out(0.99)
+      trackLoader(loader),
+      trackAnalyser(analyser),
+      waveformDisplay(formatManagerToUse, cacheToUse, waveformStore),
+      scrollingWaveform(*_player),
+      rotationAngle(0.0)
 {
     // Control buttons
     addAndMakeVisible(playButton);
     addAndMakeVisible(cueButton);
     addAndMakeVisible(loadButton);
+    addAndMakeVisible(ramButton);
+
+    // Hot cue pads, numbered from 1
+    for (int i = 0; i < HotCueSource::numCues; ++i)
+    {
+        hotCueButtons[i].setButtonText(String(i + 1));
+        addAndMakeVisible(hotCueButtons[i]);
+        hotCueButtons[i].addListener(this);
+    }
+
+    updateHotCueButtons();
 
     // Loop buttons
     addAndMakeVisible(loopButton);
     addAndMakeVisible(inLoopButton);
     addAndMakeVisible(outLoopButton);
+    addAndMakeVisible(halveLoopButton);
+    addAndMakeVisible(doubleLoopButton);
+    addAndMakeVisible(rollButton);
+    addAndMakeVisible(jumpBackButton);
+    addAndMakeVisible(jumpForwardButton);
+
+    // Key lock controls
+    addAndMakeVisible(keyLockButton);
+    addAndMakeVisible(syncButton);
+    addAndMakeVisible(keyLockQualityBox);
+    addAndMakeVisible(quantizeButton);
 
     // Sliders
     addAndMakeVisible(volSlider);
@@ -43,8 +70,21 @@ DeckGUI::DeckGUI(DJAudioPlayer *_player,
     addAndMakeVisible(highKnob);
     addAndMakeVisible(lowKnob);
 
-    // Waveform display
+    // EQ knobs and kill switches
+    addAndMakeVisible(highEqKnob);
+    addAndMakeVisible(midEqKnob);
+    addAndMakeVisible(lowEqKnob);
+    addAndMakeVisible(highKillButton);
+    addAndMakeVisible(midKillButton);
+    addAndMakeVisible(lowKillButton);
+
+    // Waveform displays, the zoomed one follows the overview of the whole track
     addAndMakeVisible(waveformDisplay);
+    addAndMakeVisible(scrollingWaveform);
+    waveformDisplay.onOverviewChanged = [this](std::shared_ptr<const WaveformOverview> overview)
+    {
+        scrollingWaveform.setOverview(overview);
+    };
 
     volSlider.setRange(0.0, 1.0);
     volSlider.setValue(1.0);
@@ -65,12 +105,34 @@ DeckGUI::DeckGUI(DJAudioPlayer *_player,
     highKnob.setTextBoxStyle(Slider::TextBoxAbove, false, 50, 20);
     lowKnob.setTextBoxStyle(Slider::TextBoxAbove, false, 50, 20);
 
+    // The EQ knobs cut down to -24 dB, the kill switches remove a band completely
+    for (auto *knob : {&highEqKnob, &midEqKnob, &lowEqKnob})
+    {
+        knob->setRange(-24.0, 6.0);
+        knob->setValue(0.0);
+        knob->setSliderStyle(Slider::Rotary);
+        knob->setTextBoxStyle(Slider::NoTextBox, false, 0, 0);
+        knob->setDoubleClickReturnValue(true, 0.0);
+    }
+
     // Set the button color for the play button to red
     playButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(90, 183, 92));
     inLoopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
     outLoopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
     loopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    halveLoopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    doubleLoopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    rollButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    jumpBackButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    jumpForwardButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    quantizeButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    keyLockButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    syncButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    highKillButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    midKillButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    lowKillButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
     loadButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    ramButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
 
     // Set the slider styles for the volume and speed sliders
     volSlider.setSliderStyle(Slider::LinearVertical);
@@ -87,10 +149,43 @@ DeckGUI::DeckGUI(DJAudioPlayer *_player,
     playButton.addListener(this);
     cueButton.addListener(this);
     loadButton.addListener(this);
+    ramButton.addListener(this);
 
     loopButton.addListener(this);
     inLoopButton.addListener(this);
     outLoopButton.addListener(this);
+    halveLoopButton.addListener(this);
+    doubleLoopButton.addListener(this);
+    jumpBackButton.addListener(this);
+    jumpForwardButton.addListener(this);
+    keyLockButton.addListener(this);
+    syncButton.addListener(this);
+    quantizeButton.addListener(this);
+
+    // Key lock quality, ids follow TimeStretchAudioSource::Quality plus one
+    keyLockQualityBox.addItem("LOW", 1);
+    keyLockQualityBox.addItem("MED", 2);
+    keyLockQualityBox.addItem("HIGH", 3);
+    keyLockQualityBox.setSelectedId(2, dontSendNotification);
+    keyLockQualityBox.onChange = [this]
+    {
+        player->setKeyLockQuality((TimeStretchAudioSource::Quality)(keyLockQualityBox.getSelectedId() - 1));
+    };
+
+    // The roll only lasts while the button is held, so it follows the button state rather than clicks
+    rollButton.onStateChange = [this]
+    {
+        const bool down = rollButton.isDown();
+
+        if (down != rolling)
+        {
+            rolling = down;
+            if (rolling)
+                player->startLoopRoll(loopRollSeconds);
+            else
+                player->stopLoopRoll();
+        }
+    };
 
     volSlider.addListener(this);
     speedSlider.addListener(this);
@@ -98,6 +193,15 @@ DeckGUI::DeckGUI(DJAudioPlayer *_player,
 
     highKnob.addListener(this);
     lowKnob.addListener(this);
+    highEqKnob.addListener(this);
+    midEqKnob.addListener(this);
+    lowEqKnob.addListener(this);
+    highKillButton.addListener(this);
+    midKillButton.addListener(this);
+    lowKillButton.addListener(this);
+
+    // There is no loop until a track is loaded and its loop points are set
+    updateLoopButton();
 
     // Start the timer with a callback interval of 50ms
     startTimer(50);
@@ -105,19 +209,41 @@ DeckGUI::DeckGUI(DJAudioPlayer *_player,
 
 DeckGUI::~DeckGUI()
 {
-    // Stop the timer and remove listeners
+    // Stop the timer, drop any pending load and remove listeners
     stopTimer();
+    trackLoader.cancelLoads(this);
+    trackLoader.setDecodingIntoMemory(this, false);
     playButton.removeListener(this);
     cueButton.removeListener(this);
     loadButton.removeListener(this);
+    ramButton.removeListener(this);
+
+    for (auto &hotCueButton : hotCueButtons)
+    {
+        hotCueButton.removeListener(this);
+    }
+
     volSlider.removeListener(this);
     speedSlider.removeListener(this);
     positionSlider.removeListener(this);
     loopButton.removeListener(this);
     inLoopButton.removeListener(this);
     outLoopButton.removeListener(this);
+    halveLoopButton.removeListener(this);
+    doubleLoopButton.removeListener(this);
+    jumpBackButton.removeListener(this);
+    jumpForwardButton.removeListener(this);
+    keyLockButton.removeListener(this);
+    syncButton.removeListener(this);
+    quantizeButton.removeListener(this);
     highKnob.removeListener(this);
     lowKnob.removeListener(this);
+    highEqKnob.removeListener(this);
+    midEqKnob.removeListener(this);
+    lowEqKnob.removeListener(this);
+    highKillButton.removeListener(this);
+    midKillButton.removeListener(this);
+    lowKillButton.removeListener(this);
 }
 
 void DeckGUI::paint(juce::Graphics &g)
@@ -154,6 +280,39 @@ void DeckGUI::paint(juce::Graphics &g)
     // Draw the white line rotating around the center of the circle
     g.setColour(juce::Colours::white);
     g.drawLine(center.x, center.y, x, y, 2.0f); // Draw the line with a thickness of 2.0f
+
+    // Show how far ahead the background thread has decoded and how often it fell behind,
+    // and the track's tempo and the tempo at the current speed. The timer compares against
+    // these to tell whether they need drawing again.
+    g.setFont(juce::FontOptions(12.0f));
+    bufferText = getBufferText();
+    g.drawText(bufferText, bufferTextBounds, juce::Justification::centred, true);
+    tempoText = getTempoText();
+    g.drawText(tempoText, tempoTextBounds, juce::Justification::centred, true);
+
+    // Show the track's loudness and the gain that matches it to the other tracks
+    if (analysis.hasLoudness())
+    {
+        g.drawText("LUFS " + String(analysis.loudness, 1) + "   GAIN " + String(Decibels::gainToDecibels(analysis.getAutoGain(autoGainTarget)), 1) + " dB",
+                   loudnessTextBounds, juce::Justification::centred, true);
+    }
+}
+
+// The buffer line of the deck: decoding headroom and underruns
+String DeckGUI::getBufferText() const
+{
+    return "BUFFER " + String(roundToInt(player->getBufferFillLevel() * 100.0f)) + "%   UNDERRUNS " + String(player->getUnderrunCount());
+}
+
+// The tempo line of the deck, empty without a beat grid
+String DeckGUI::getTempoText() const
+{
+    if (!analysis.hasBeatGrid())
+    {
+        return {};
+    }
+
+    return "BPM " + String(analysis.bpm, 1) + "   NOW " + String(analysis.bpm * player->getCurrentSpeed(), 1);
 }
 
 // I've decided to change the layout of the app and make it imitate the layout of the legendary Technics SL-1200MK2 with some modern additions
@@ -162,18 +321,20 @@ void DeckGUI::paint(juce::Graphics &g)
 
 //       C0     C1     C2     C3     C4     C5
 //     +---- + ---- + ---- + ---- + ---- + ---- +
-//  R0 |                waveform                |
+//  R0 |           scrolling waveform           |
 //     +---- + ---- + ---- + ---- + ---- + ---- +
-//  R1 |               PosSlider                |
+//  R1 |         waveform / PosSlider           |
 //     +---- + ---- + ---- + ---- + ---- + ---- +
-//  R2 |                   |  Hp  |   V  |   S  |
-//     +                   + ---- +   |  +   |  +
-//  R3 |    Spinning       |      |   |  |   |  |
-//     +     Record        + ---- +   |  +   |  +
-//  R4 |                   |  Lp  |   |  |   |  |
+//  R2 |             |  Hi  |  Hp  |   V  |   S  |
+//     +             + ---- + ---- +   |  +   |  +
+//  R3 |  Spinning   |  Mid | Key  |   |  |   |  |
+//     +   Record    + ---- + ---- +   |  +   |  +
+//  R4 |             |  Lo  |  Lp  |   |  |   |  |
 //     +---- + ---- + ---- + ---- + ---- + ---- +
-//  R5 |   PC    |      Loop dash     |   L     |
+//  R5 |   PC    |      Loop dash     |  L/RAM  |
 //     +---- + ---- + ---- + ---- + ---- + ---- +
+//
+// The loop dash has IN, OUT, /2 and x2 on top, and LOOP, the beat jumps and ROLL below.
 
 void DeckGUI::resized()
 {
@@ -184,21 +345,53 @@ void DeckGUI::resized()
     // Bottom button controls
     playButton.setBounds(0, row * 5, col * 1.5, row / 2);           // C0 R5 play button
     cueButton.setBounds(0, row * 5.5, col * 1.5, row / 2);          // C0 R5 for the cue button
-    loadButton.setBounds(col * 4.5, row * 5, col * 1.5, row);       // C3 R5 for the load button
-    inLoopButton.setBounds(col * 1.5, row * 5, col * 1.5, row / 2); // C0 R5 for the in loop button
-    outLoopButton.setBounds(col * 3, row * 5, col * 1.5, row / 2);  // C2 R5 for the out loop button
-    loopButton.setBounds(col * 1.5, row * 5.5, col * 3, row / 2);   // C0 R5 for the loop button
+    loadButton.setBounds(col * 4.5, row * 5, col * 1.5, row / 2);   // C3 R5 for the load button
+    ramButton.setBounds(col * 4.5, row * 5.5, col * 1.5, row / 2);  // C3 R5 for the RAM button
+
+    // Hot cue pads in a strip above the record
+    for (int i = 0; i < HotCueSource::numCues; ++i)
+    {
+        hotCueButtons[i].setBounds(col * 2 * i / HotCueSource::numCues, row * 2, col * 2 / HotCueSource::numCues, row / 3); // C0 R2 for the hot cue pads
+    }
+    inLoopButton.setBounds(col * 1.5, row * 5, col * 0.75, row / 2);       // C1 R5 for the in loop button
+    outLoopButton.setBounds(col * 2.25, row * 5, col * 0.75, row / 2);     // C2 R5 for the out loop button
+    halveLoopButton.setBounds(col * 3, row * 5, col * 0.75, row / 2);      // C3 R5 for the halve loop button
+    doubleLoopButton.setBounds(col * 3.75, row * 5, col * 0.75, row / 2);  // C3 R5 for the double loop button
+    loopButton.setBounds(col * 1.5, row * 5.5, col * 1.5, row / 2);        // C1 R5 for the loop button
+    jumpBackButton.setBounds(col * 3, row * 5.5, col * 0.375, row / 2);    // C3 R5 for the beat jump back button
+    jumpForwardButton.setBounds(col * 3.375, row * 5.5, col * 0.375, row / 2); // C3 R5 for the beat jump forward button
+    rollButton.setBounds(col * 3.75, row * 5.5, col * 0.75, row / 2);      // C3 R5 for the loop roll button
 
     volSlider.setBounds(col * 4, row * 2, col, row * 3);   // C4 R2 for the volume slider
     speedSlider.setBounds(col * 5, row * 2, col, row * 3); // C5 R2 for the speed slider
-    positionSlider.setBounds(0, row, col * 6, row);        // C0 R1 for the position slider
-    waveformDisplay.setBounds(0, 0, col * 6, row);         // C0 R0 for the waveform display
+    positionSlider.setBounds(0, row * 1.5, col * 6, row / 2);  // C0 R1 for the position slider
+    waveformDisplay.setBounds(0, row, col * 6, row / 2);       // C0 R1 for the whole track waveform
+    scrollingWaveform.setBounds(0, 0, col * 6, row);           // C0 R0 for the scrolling waveform
 
     highKnob.setBounds(col * 3, row * 2, col, row); // C4 R0 for the high pass filter knob
     lowKnob.setBounds(col * 3, row * 4, col, row);  // C5 R0 for the low pass filter knob
 
-    // Define the bounds for the circle in column 1, row 2
-    circleBounds = juce::Rectangle<int>((int)col * 0.5, (int)row * 2.5, (int)col * 2, (int)row * 2);
+    keyLockButton.setBounds(col * 3, row * 3, col / 2, row / 2);         // C3 R3 for the key lock button
+    syncButton.setBounds(col * 3.5, row * 3, col / 2, row / 2);          // C3 R3 for the sync button
+    keyLockQualityBox.setBounds(col * 3, row * 3.5, col / 2, row / 2);   // C3 R3 for the key lock quality
+    quantizeButton.setBounds(col * 3.5, row * 3.5, col / 2, row / 2);    // C3 R3 for the quantize button
+
+    // EQ column, each knob with its kill switch underneath
+    highEqKnob.setBounds(col * 2, row * 2, col, row * 0.75);              // C2 R2 for the high EQ knob
+    highKillButton.setBounds(col * 2.2, row * 2.75, col * 0.6, row / 4);   // C2 R2 for the high kill switch
+    midEqKnob.setBounds(col * 2, row * 3, col, row * 0.75);               // C2 R3 for the mid EQ knob
+    midKillButton.setBounds(col * 2.2, row * 3.75, col * 0.6, row / 4);    // C2 R3 for the mid kill switch
+    lowEqKnob.setBounds(col * 2, row * 4, col, row * 0.75);               // C2 R4 for the low EQ knob
+    lowKillButton.setBounds(col * 2.2, row * 4.75, col * 0.6, row / 4);    // C2 R4 for the low kill switch
+
+    // Define the bounds for the circle in columns 0 and 1, rows 2 to 4
+    const int recordSize = (int)jmin(col * 1.75, row * 2.25);
+    circleBounds = juce::Rectangle<int>(recordSize, recordSize).withCentre({(int)col, (int)(row * 3.6)});
+
+    // Status lines in the first two columns, at the top of row 2
+    bufferTextBounds = juce::Rectangle<int>(0, getHeight() / 3, getWidth() / 3, 20);
+    tempoTextBounds = bufferTextBounds.translated(0, 20);
+    loudnessTextBounds = tempoTextBounds.translated(0, 20);
 }
 
 // This method is called when a button is clicked
@@ -212,9 +405,9 @@ void DeckGUI::buttonClicked(Button *button)
         // Check if the play button text is "PLAY"
         if (playButton.getButtonText() == "PLAY")
         {
-            // Change button text to "PAUSE" and start the player
+            // Change button text to "PAUSE" and start the player, on the beat of a playing deck with quantize on
             playButton.setButtonText("PAUSE");
-            player->start();
+            player->startOnBeat(chooseSyncLeader != nullptr ? chooseSyncLeader(player) : nullptr);
             // Change button color to red
             playButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(218, 79, 74));
         }
@@ -229,81 +422,124 @@ void DeckGUI::buttonClicked(Button *button)
     }
     else if (button == &cueButton)
     {
-        // Check if the audio is paused
+        // The cue button works on the first hot cue: set it while paused, jump to it while playing
         if (playButton.getButtonText() == "PLAY")
         {
-            // Set cue point to the current player position
-            cue = player->getPositionRelative();
-            cueButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(250, 166, 50));
+            setHotCue(0);
         }
         else
         {
-            // Set player position to the cue point and start the player
-            player->setPositionRelative(cue);
-            player->start();
+            player->triggerHotCue(0);
         }
     }
-    else if (button == &loopButton)
+    else if (std::find_if(std::begin(hotCueButtons), std::end(hotCueButtons), [button](const TextButton &pad)
+                          { return &pad == button; }) != std::end(hotCueButtons))
     {
-        // Check if the loop is off
-        if (loopButton.getButtonText() == "LOOP OFF")
-        {
-            // Change button text to "LOOP ON" and enable loop mode
-            loopButton.setButtonText("LOOP ON");
-            loopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(1, 110, 205));
-            loopMode = true;
+        // An empty pad sets its cue, a set pad jumps to it, and a shift-click clears it
+        const auto index = (int)(static_cast<TextButton *>(button) - hotCueButtons);
 
-            // Start the player from the loop start position if valid
-            if (in < out)
-            {
-                player->start();
-                // Check if the audio is paused
-                if (playButton.getButtonText() == "PLAY")
-                {
-                    // Change button text to "PAUSE" and start the player
-                    playButton.setButtonText("PAUSE");
-                    // Change button color to red
-                    playButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(218, 79, 74));
-                }
-            }
-            else
-            {
-                // Reset loop points if invalid
-                in = 0.0;
-                out = 0.99;
-            }
+        if (ModifierKeys::currentModifiers.isShiftDown())
+        {
+            player->clearHotCue(index);
+            saveHotCues();
+        }
+        else if (player->getHotCues()[(size_t)index] < 0)
+        {
+            setHotCue(index);
         }
         else
         {
-            // Change button text to "LOOP OFF" and disable loop mode
-            loopButton.setButtonText("LOOP OFF");
-            loopMode = false;
-            loopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+            player->triggerHotCue(index);
+            playButton.setButtonText("PAUSE");
+            playButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(218, 79, 74));
         }
     }
-    else if (button == &inLoopButton)
+    else if (button == &loopButton)
     {
-        // Set loop start point to the current player position
-        in = player->getPositionRelative();
-        inLoopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(119, 141, 169));
+        // The loop itself runs on the audio thread, the button only asks to switch it
+        // and shows what the player did once the timer sees it
+        const bool loopOn = !player->isLoopEnabled();
+        player->setLoopEnabled(loopOn);
 
-        // Validate loop points to prevent in being greater than out
-        if (in > out)
+        // Start the player if it is paused so the loop can be heard
+        if (loopOn && playButton.getButtonText() == "PLAY")
         {
-            out = 0.99;
+            player->start();
+            // Change button text to "PAUSE" and button color to red
+            playButton.setButtonText("PAUSE");
+            playButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(218, 79, 74));
         }
     }
+    else if (button == &inLoopButton)
+    {
+        // Set loop start point to the current player position
+        player->setLoopInAtPlayhead();
+        inLoopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(119, 141, 169));
+    }
     else if (button == &outLoopButton)
     {
         // Set loop end point to the current player position
-        out = player->getPositionRelative();
+        player->setLoopOutAtPlayhead();
         outLoopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(119, 141, 169));
+    }
+    else if (button == &highKillButton || button == &midKillButton || button == &lowKillButton)
+    {
+        // Kill or restore the band, the knob keeps its setting for when it comes back
+        auto *kill = static_cast<TextButton *>(button);
+        const int band = kill == &lowKillButton ? 0 : kill == &midKillButton ? 1 : 2;
+        const bool killed = !kill->getToggleState();
+        kill->setToggleState(killed, dontSendNotification);
+        player->setEqKill(band, killed);
+        kill->setColour(TextButton::buttonColourId, killed ? juce::Colour::fromRGB(218, 79, 74) : juce::Colour::fromRGB(13, 27, 42));
+    }
+    else if (button == &keyLockButton)
+    {
+        // Keep the pitch when the speed slider moves
+        const bool lock = !player->isKeyLockEnabled();
+        player->setKeyLock(lock);
+        keyLockButton.setButtonText(lock ? "KEY ON" : "KEY OFF");
+        keyLockButton.setColour(TextButton::buttonColourId, lock ? juce::Colour::fromRGB(1, 110, 205) : juce::Colour::fromRGB(13, 27, 42));
+    }
+    else if (button == &syncButton)
+    {
+        // Follow another deck, or go back to the speed slider at the speed the deck is playing at
+        if (player->getSyncLeader() == nullptr)
+        {
+            auto *leader = chooseSyncLeader != nullptr ? chooseSyncLeader(player) : nullptr;
 
-        // Validate loop points to prevent out being less than in
-        if (out < in)
+            if (leader != nullptr && player->hasBeatGrid())
+            {
+                player->setSyncLeader(leader);
+            }
+        }
+        else
         {
-            in = 0.0;
+            player->setSyncLeader(nullptr);
+            speedSlider.setValue(player->getCurrentSpeed());
         }
+
+        const bool synced = player->getSyncLeader() != nullptr;
+        syncButton.setColour(TextButton::buttonColourId, synced ? juce::Colour::fromRGB(250, 166, 50) : juce::Colour::fromRGB(13, 27, 42));
+    }
+    else if (button == &quantizeButton)
+    {
+        // Line up play, hot cues, loops and beat jumps with the beat grid
+        const bool quantizeOn = !player->isQuantized();
+        player->setQuantize(quantizeOn);
+        quantizeButton.setButtonText(quantizeOn ? "Q ON" : "Q OFF");
+        quantizeButton.setColour(TextButton::buttonColourId, quantizeOn ? juce::Colour::fromRGB(1, 110, 205) : juce::Colour::fromRGB(13, 27, 42));
+    }
+    else if (button == &jumpBackButton || button == &jumpForwardButton)
+    {
+        player->jumpBeats(button == &jumpBackButton ? -beatJumpLength : beatJumpLength);
+    }
+    else if (button == &halveLoopButton)
+    {
+        player->halveLoop();
+    }
+    else if (button == &doubleLoopButton)
+    {
+        player->doubleLoop();
     }
     else if (button == &loadButton)
     {
@@ -311,9 +547,18 @@ void DeckGUI::buttonClicked(Button *button)
         auto fileChooserFlags = FileBrowserComponent::canSelectFiles;
         fChooser.launchAsync(fileChooserFlags, [this](const FileChooser &chooser)
                              {
-            // Load the selected file into the player and waveform display
-            player->loadURL(URL{ chooser.getResult() });
-            waveformDisplay.loadURL(URL{ chooser.getResult() }); });
+            // Load the selected file in the background, unless the chooser was cancelled
+            if (chooser.getResult() != File{})
+                trackLoader.loadTrack(URL{ chooser.getResult() }, this, player->isDecodingIntoMemory()); });
+    }
+    else if (button == &ramButton)
+    {
+        // Toggle decoding into memory; this applies from the next track that is loaded
+        const bool decode = !player->isDecodingIntoMemory();
+        player->setDecodeIntoMemory(decode);
+        trackLoader.setDecodingIntoMemory(this, decode);
+        ramButton.setButtonText(decode ? "RAM ON" : "RAM OFF");
+        ramButton.setColour(TextButton::buttonColourId, decode ? juce::Colour::fromRGB(1, 110, 205) : juce::Colour::fromRGB(13, 27, 42));
     }
     else
     {
@@ -354,6 +599,14 @@ void DeckGUI::sliderValueChanged(Slider *slider)
         // Set the player's low pass filter to the slider's value
         player->setLowPass(slider->getValue());
     }
+
+    else if (slider == &highEqKnob || slider == &midEqKnob || slider == &lowEqKnob)
+    {
+        // Set the EQ band's gain from the knob's dB value
+        const int band = slider == &lowEqKnob ? 0 : slider == &midEqKnob ? 1 : 2;
+        player->setEqGain(band, Decibels::decibelsToGain((float)slider->getValue()));
+    }
+
     // Handle any other sliders
     else
     {
@@ -377,8 +630,127 @@ bool DeckGUI::isInterestedInFileDrag(const StringArray &files)
 // This method is called when the user drops a file onto the DeckGUI
 void DeckGUI::filesDropped(const StringArray &files, int x, int y)
 {
-    player->loadURL(URL{File{files[0]}});
-    waveformDisplay.loadURL(URL{File{files[0]}});
+    // Load the file in the background; the deck keeps playing until it is ready
+    trackLoader.loadTrack(URL{File{files[0]}}, this, player->isDecodingIntoMemory());
+}
+
+// Show the loading progress on the load button
+void DeckGUI::trackLoadProgress(double progress)
+{
+    loadButton.setButtonText("LOADING " + String(roundToInt(progress * 100.0)) + "%");
+}
+
+// The loader has opened the file, so swap it into the deck
+void DeckGUI::trackLoaded(LoadedTrack &track)
+{
+    loadButton.setButtonText("LOAD");
+
+    player->loadTrack(track);
+    waveformDisplay.loadTrack(track);
+
+    // Bring back the track's hot cues
+    loadedTrackKey = track.hashCode;
+    player->setHotCues(hotCueStore.load(loadedTrackKey));
+    updateHotCueButtons();
+
+    // Show the stored tempo, or analyse the track if it is new
+    TrackAnalysis stored;
+
+    if (trackAnalyser.find(loadedTrackKey, stored))
+    {
+        setAnalysis(stored);
+    }
+    else
+    {
+        setAnalysis(TrackAnalysis());
+        trackAnalyser.analyse(track.audioURL, loadedTrackKey, track.decoded,
+                              [safeThis = Component::SafePointer<DeckGUI>(this), key = loadedTrackKey](const TrackAnalysis &result)
+                              {
+                                  if (safeThis != nullptr && safeThis->loadedTrackKey == key)
+                                  {
+                                      safeThis->setAnalysis(result);
+                                  }
+                              });
+    }
+
+    // Loading a new track stops the transport, so reset the play button
+    playButton.setButtonText("PLAY");
+    playButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(90, 183, 92));
+
+    // The new track starts without a loop
+    updateLoopButton();
+    inLoopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    outLoopButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    rolling = false;
+}
+
+// Show whether the player is looping, and only offer the loop once there is one
+void DeckGUI::updateLoopButton()
+{
+    const bool loopOn = player->isLoopEnabled();
+    loopButton.setEnabled(loopOn || player->hasLoop());
+    loopButton.setButtonText(loopOn ? "LOOP ON" : "LOOP OFF");
+    loopButton.setColour(TextButton::buttonColourId, loopOn ? juce::Colour::fromRGB(1, 110, 205) : juce::Colour::fromRGB(13, 27, 42));
+}
+
+// Show the tempo, draw the beat grid and match the loudness of the loaded track
+void DeckGUI::setAnalysis(const TrackAnalysis &newAnalysis)
+{
+    analysis = newAnalysis;
+    player->setBeatGrid(analysis.downbeatSeconds, analysis.hasBeatGrid() ? analysis.beatPeriodSeconds : 0.0);
+    player->setAutoGain(analysis.getAutoGain(autoGainTarget));
+    scrollingWaveform.setBeatGrid(analysis);
+    repaint();
+}
+
+// Set a hot cue at the playhead and keep it with the track
+void DeckGUI::setHotCue(int index)
+{
+    if (loadedTrackKey != 0)
+    {
+        player->setHotCueAtPlayhead(index);
+        saveHotCues();
+    }
+}
+
+// Store the hot cues of the loaded track and colour the pads
+void DeckGUI::saveHotCues()
+{
+    if (loadedTrackKey != 0)
+    {
+        hotCueStore.save(loadedTrackKey, player->getHotCues());
+    }
+
+    updateHotCueButtons();
+}
+
+// Light up the pads, and the cue button, whose cue is set
+void DeckGUI::updateHotCueButtons()
+{
+    const auto &cues = player->getHotCues();
+
+    for (int i = 0; i < HotCueSource::numCues; ++i)
+    {
+        hotCueButtons[i].setColour(TextButton::buttonColourId, cues[(size_t)i] >= 0 ? juce::Colour::fromRGB(250, 166, 50) : juce::Colour::fromRGB(13, 27, 42));
+    }
+
+    if (cues[0] >= 0)
+    {
+        cueButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(250, 166, 50));
+    }
+    else
+    {
+        cueButton.removeColour(TextButton::buttonColourId);
+    }
+}
+
+// The loader couldn't open the file
+void DeckGUI::trackLoadFailed(const URL &audioURL, const String &error)
+{
+    loadButton.setButtonText("LOAD");
+    std::cout << "DeckGUI::Failed to load " << audioURL.toString(false) << ": " << error << std::endl;
+
+    AlertWindow::showMessageBoxAsync(MessageBoxIconType::WarningIcon, "Couldn't load track", error);
 }
 
 // This method is called every 50ms
@@ -388,31 +760,35 @@ void DeckGUI::filesDropped(const StringArray &files, int x, int y)
  *
  * This function is called periodically to perform the following tasks:
  * - Update the rotation angle of a visual element (e.g., a spinning record) if the music is playing.
- * - Handle loop mode by resetting the player's position to the loop start point when it reaches the loop end point.
  * - Update the position slider and waveform display to reflect the current playback position.
  * - Repaint the GUI to reflect these updates.
  */
 void DeckGUI::timerCallback()
 {
-    // Update the rotation angle if the music is playing
+    // Turn the record if the music is playing
     if (playButton.getButtonText() == "PAUSE")
     {
         rotationAngle += 0.05f * speedSlider.getValue(); // Adjust the speed of rotation here
+        repaint(circleBounds);
     }
 
-    // Handle loop mode
-    if (loopMode)
+    // Update position slider and waveform display. The slider only follows the deck here; only
+    // a drag by the user seeks, so this never moves the playhead back or past a loop seam
+    positionSlider.setValue(player->getPositionRelative(), dontSendNotification);
+    waveformDisplay.setPositionRelative(player->getPositionRelative());
+
+    // Follow the loop as the audio thread applies it, including quantized and rolled loops
+    updateLoopButton();
+
+    // Repaint the status lines only when what they show has changed; the waveforms repaint
+    // themselves when the playhead moves
+    if (getBufferText() != bufferText)
     {
-        if (player->getPositionRelative() >= out)
-        {
-            player->setPositionRelative(in);
-        }
+        repaint(bufferTextBounds);
     }
 
-    // Update position slider and waveform display
-    positionSlider.setValue(player->getPositionRelative());
-    waveformDisplay.setPositionRelative(player->getPositionRelative());
-
-    // Repaint the component
-    repaint();
+    if (getTempoText() != tempoText)
+    {
+        repaint(tempoTextBounds);
+    }
 }
@@ -13,6 +13,9 @@
 #include <JuceHeader.h>
 #include "DJAudioPlayer.h"
 #include "WaveformDisplay.h"
+#include "ScrollingWaveform.h"
+#include "TrackLoader.h"
+#include "TrackAnalyser.h"
 
 //==============================================================================
 /*
@@ -25,7 +28,8 @@ class DeckGUI : public juce::Component,
         public juce::Button::Listener,
         public juce::Slider::Listener,
         public juce::FileDragAndDropTarget,
-        public juce::Timer
+        public juce::Timer,
+        public TrackLoader::Listener
 {
 public:
   // Creates a DeckGUI object.
@@ -33,9 +37,15 @@ public:
   //   - player: Pointer to the DJAudioPlayer object.
   //   - formatManagerToUse: Reference to the AudioFormatManager object.
   //   - cacheToUse: Reference to the AudioThumbnailCache object.
+  //   - loader: Reference to the TrackLoader that opens files in the background.
+  //   - waveformStore: Reference to the WaveformStore that keeps waveforms on disk.
+  //   - analyser: Reference to the TrackAnalyser that finds the tempo and beat grid.
   DeckGUI(DJAudioPlayer *player,
       AudioFormatManager &formatManagerToUse,
-      AudioThumbnailCache &cacheToUse);
+      AudioThumbnailCache &cacheToUse,
+      TrackLoader &loader,
+      WaveformStore &waveformStore,
+      TrackAnalyser &analyser);
   
   // Destroys the DeckGUI object.
   ~DeckGUI() override;
@@ -72,29 +82,47 @@ public:
 
   // Timer callback to update the GUI
   void timerCallback() override;
+
+  // Track loader handlers, called on the message thread
+
+  // Show how much of the file has been read
+  // Parameters:
+  //   - progress: Fraction of the file read, from 0.0 to 1.0.
+  void trackLoadProgress(double progress) override;
+
+  // Swap the loaded track into the player and the waveform display
+  // Parameters:
+  //   - track: The track opened by the loader.
+  void trackLoaded(LoadedTrack &track) override;
+
+  // Tell the user the track couldn't be loaded
+  // Parameters:
+  //   - audioURL: The URL that failed to load.
+  //   - error: Description of the problem.
+  void trackLoadFailed(const URL &audioURL, const String &error) override;
   
-  // Cue point for the audio player
-  float cue;
-  
+  // Picks the deck to follow when SYNC is pressed, or returns nullptr if there isn't one.
+  // Set by the component that owns all the decks.
+  std::function<DJAudioPlayer *(DJAudioPlayer *follower)> chooseSyncLeader;
+
   // Rotation angle for visual elements (e.g., spinning record)
   float rotationAngle;
-  
-  // Loop start and end points
-  float in;
-  float out;
-
-  // Loop mode flag
-  bool loopMode;
 
 private:
   // Play button
   TextButton playButton{"PLAY"};
   
-  // Cue button
+  // Cue button, which sets and jumps to the first hot cue
   TextButton cueButton{"CUE"};
+
+  // Hot cue pads: an empty pad sets its cue at the playhead, a set pad jumps to it, shift-click clears it
+  TextButton hotCueButtons[HotCueSource::numCues];
   
   // Load button
   TextButton loadButton{"LOAD"};
+
+  // Toggles decoding whole tracks into memory for instant seeking
+  TextButton ramButton{"RAM OFF"};
   
   // Loop button
   TextButton loopButton{"LOOP OFF"};
@@ -105,6 +133,40 @@ private:
   // Out-loop button
   TextButton outLoopButton{"OUT"};
 
+  // Halves the loop length
+  TextButton halveLoopButton{"/2"};
+
+  // Doubles the loop length
+  TextButton doubleLoopButton{"x2"};
+
+  // Loops a short slice from the playhead while held down
+  TextButton rollButton{"ROLL"};
+
+  // Jump back and forward along the beat grid
+  TextButton jumpBackButton{"<<"};
+  TextButton jumpForwardButton{">>"};
+
+  // Number of beats a beat jump moves
+  static constexpr int beatJumpLength = 16;
+
+  // Toggles key lock, so the speed slider changes tempo without changing pitch
+  TextButton keyLockButton{"KEY OFF"};
+
+  // Makes this deck follow the tempo and beats of another deck
+  TextButton syncButton{"SYNC"};
+
+  // Quality/CPU setting of the key lock time-stretcher
+  ComboBox keyLockQualityBox;
+
+  // Makes play, hot cues, loops and beat jumps wait for the beat grid
+  TextButton quantizeButton{"Q OFF"};
+
+  // Whether the roll button is being held
+  bool rolling = false;
+
+  // Length of a loop roll in seconds
+  static constexpr double loopRollSeconds = 0.25;
+
   // Volume slider
   Slider volSlider;
   
@@ -120,18 +182,72 @@ private:
   // Low-pass filter knob
   Slider lowKnob;
 
-  // Rectangle to store circle bounds for visual elements
-  Rectangle<int> circleBounds;
+  // EQ knobs for the high, mid and low bands, in dB
+  Slider highEqKnob;
+  Slider midEqKnob;
+  Slider lowEqKnob;
+
+  // Kill switches for the EQ bands
+  TextButton highKillButton{"KILL"};
+  TextButton midKillButton{"KILL"};
+  TextButton lowKillButton{"KILL"};
+
+  // Areas of the deck that the timer repaints, laid out in resized() and drawn in paint()
+  Rectangle<int> circleBounds;       // The spinning record
+  Rectangle<int> bufferTextBounds;   // Buffer fill and underruns
+  Rectangle<int> tempoTextBounds;    // Tempo of the track and at the current speed
+  Rectangle<int> loudnessTextBounds; // Loudness and auto gain
+
+  // The status lines as last drawn, so the timer only repaints them when they change
+  String bufferText;
+  String tempoText;
+
+  // Builds the status lines
+  String getBufferText() const;
+  String getTempoText() const;
 
   // Pointer to the DJ audio player
   DJAudioPlayer *player;
 
+  // Opens files in the background so the GUI never blocks on disk
+  TrackLoader &trackLoader;
+
+  // Finds the tempo and beat grid of loaded tracks
+  TrackAnalyser &trackAnalyser;
+
+  // Tempo and beat grid of the loaded track
+  TrackAnalysis analysis;
+
+  // Key of the loaded track, so a late analysis of a previous track is ignored
+  int64 loadedTrackKey = 0;
+
+  // Shows the analysis of the loaded track on the deck and matches its loudness
+  void setAnalysis(const TrackAnalysis &newAnalysis);
+
+  // Keeps each track's hot cues on disk
+  HotCueStore hotCueStore;
+
+  // Sets a hot cue at the playhead and stores it
+  void setHotCue(int index);
+
+  // Stores the hot cues of the loaded track and colours the pads
+  void saveHotCues();
+
+  // Colours the pads by whether their cue is set
+  void updateHotCueButtons();
+
+  // Shows the player's loop state on the loop button and disables it until there is a loop
+  void updateLoopButton();
+
   // File chooser for loading audio files
   juce::FileChooser fChooser{"Select an audio file to play"};
 
   // Waveform display for visualizing the audio waveform
   WaveformDisplay waveformDisplay;
 
+  // Zoomed waveform that scrolls past the playhead
+  ScrollingWaveform scrollingWaveform;
+
   // Macro to prevent copying and ensure leak detection
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeckGUI)
 };
\ No newline at end of file
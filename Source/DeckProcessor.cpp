@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    DeckProcessor.cpp
+    Created: 18 Oct 2026 5:02:37pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "DeckProcessor.h"
+
+// Crossover points of the isolator, the usual split on a DJ mixer.
+static constexpr float lowMidCrossover = 200.0f;
+static constexpr float midHighCrossover = 2500.0f;
+
+// How long gain and cutoff changes take to reach their new value.
+static constexpr double rampSeconds = 0.05;
+
+ThreeBandIsolator::ThreeBandIsolator()
+{
+    // Constructor for ThreeBandIsolator class.
+    lowCrossover.setType(dsp::LinkwitzRileyFilterType::lowpass);
+    highCrossover.setType(dsp::LinkwitzRileyFilterType::lowpass);
+    lowAllpass.setType(dsp::LinkwitzRileyFilterType::allpass);
+    lowCrossover.setCutoffFrequency(lowMidCrossover);
+    highCrossover.setCutoffFrequency(midHighCrossover);
+    lowAllpass.setCutoffFrequency(midHighCrossover);
+
+    for (auto &gain : bandGains)
+    {
+        gain.setCurrentAndTargetValue(1.0f);
+    }
+}
+
+void ThreeBandIsolator::prepare(const dsp::ProcessSpec &spec)
+{
+    lowCrossover.prepare(spec);
+    highCrossover.prepare(spec);
+    lowAllpass.prepare(spec);
+
+    for (auto &gain : bandGains)
+    {
+        gain.reset(spec.sampleRate, rampSeconds);
+    }
+}
+
+void ThreeBandIsolator::reset()
+{
+    lowCrossover.reset();
+    highCrossover.reset();
+    lowAllpass.reset();
+}
+
+void ThreeBandIsolator::process(const dsp::ProcessContextReplacing<float> &context)
+{
+    // Split, weight and sum every sample in one pass, so each sample is only loaded once.
+    auto &block = context.getOutputBlock();
+    const auto numChannels = (int)block.getNumChannels();
+    const auto numSamples = (int)block.getNumSamples();
+
+    if (context.isBypassed)
+    {
+        return;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto lowGain = bandGains[low].getNextValue();
+        const auto midGain = bandGains[mid].getNextValue();
+        const auto highGain = bandGains[high].getNextValue();
+
+        for (int chan = 0; chan < numChannels; ++chan)
+        {
+            auto *data = block.getChannelPointer((size_t)chan);
+            float lowBand, rest, midBand, highBand;
+
+            lowCrossover.processSample(chan, data[i], lowBand, rest);
+            highCrossover.processSample(chan, rest, midBand, highBand);
+            lowBand = lowAllpass.processSample(chan, lowBand);
+
+            data[i] = lowBand * lowGain + midBand * midGain + highBand * highGain;
+        }
+    }
+}
+
+void ThreeBandIsolator::setBandGain(Band band, float gain)
+{
+    bandGains[band].setTargetValue(jmax(0.0f, gain));
+}
+
+DeckProcessor::DeckProcessor()
+{
+    // The filters stay bypassed until a cutoff is set.
+    chain.get<trimIndex>().setGainLinear(1.0f);
+    chain.get<gainIndex>().setGainLinear(1.0f);
+    chain.get<highPassIndex>().setType(dsp::StateVariableTPTFilterType::highpass);
+    chain.get<lowPassIndex>().setType(dsp::StateVariableTPTFilterType::lowpass);
+    chain.setBypassed<highPassIndex>(true);
+    chain.setBypassed<lowPassIndex>(true);
+}
+
+void DeckProcessor::prepare(double sampleRate, int maximumBlockSize, int numChannels)
+{
+    // Prepare every processor in the chain for the device rate.
+    chain.get<trimIndex>().setRampDurationSeconds(rampSeconds);
+    chain.get<gainIndex>().setRampDurationSeconds(rampSeconds);
+    maxCutoff = (float)(sampleRate * 0.45);
+    preparedChannels = numChannels;
+
+    chain.prepare({sampleRate, (uint32)maximumBlockSize, (uint32)numChannels});
+}
+
+void DeckProcessor::reset()
+{
+    chain.reset();
+}
+
+void DeckProcessor::process(const AudioSourceChannelInfo &info)
+{
+    // Process the part of the buffer that the deck has just filled, on the channels it has.
+    dsp::AudioBlock<float> block(*info.buffer, (size_t)info.startSample);
+    const auto numChannels = jmin(block.getNumChannels(), (size_t)preparedChannels);
+    auto subBlock = block.getSubsetChannelBlock(0, numChannels).getSubBlock(0, (size_t)info.numSamples);
+    chain.process(dsp::ProcessContextReplacing<float>(subBlock));
+}
+
+void DeckProcessor::setTrim(float gain)
+{
+    chain.get<trimIndex>().setGainLinear(gain);
+}
+
+void DeckProcessor::setGain(float gain)
+{
+    chain.get<gainIndex>().setGainLinear(gain);
+}
+
+void DeckProcessor::setBandGain(ThreeBandIsolator::Band band, float gain)
+{
+    chain.get<isolatorIndex>().setBandGain(band, gain);
+}
+
+void DeckProcessor::setHighPassCutoff(float frequency)
+{
+    chain.setBypassed<highPassIndex>(frequency <= 0.0f);
+
+    if (frequency > 0.0f)
+    {
+        chain.get<highPassIndex>().setCutoffFrequency(jmin(maxCutoff, frequency));
+    }
+}
+
+void DeckProcessor::setLowPassCutoff(float frequency)
+{
+    chain.setBypassed<lowPassIndex>(frequency <= 0.0f);
+
+    if (frequency > 0.0f)
+    {
+        chain.get<lowPassIndex>().setCutoffFrequency(jmin(maxCutoff, frequency));
+    }
+}
@@ -0,0 +1,155 @@
+/*
+	==============================================================================
+
+	DeckProcessor.h
+	Created: 18 Oct 2026 5:02:37pm
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+	A DJ mixer style 3-band isolator. The signal is split into low, mid and high
+	bands by Linkwitz-Riley crossovers, which sum back flat when all bands are at
+	unity, so each band can be boosted or killed without colouring the others.
+	Works as a processor in a dsp::ProcessorChain.
+*/
+class ThreeBandIsolator
+{
+public:
+	/** The bands of the isolator. */
+	enum Band
+	{
+		low = 0,
+		mid,
+		high
+	};
+
+	/**
+		Constructor.
+	*/
+	ThreeBandIsolator();
+
+	/**
+		Prepares the crossovers for playback.
+		@param spec The sample rate, block size and channel count.
+	*/
+	void prepare(const dsp::ProcessSpec &spec);
+
+	/**
+		Clears the state of the crossovers.
+	*/
+	void reset();
+
+	/**
+		Splits, weights and sums the bands in a single pass over the block.
+		@param context The block to process in place.
+	*/
+	void process(const dsp::ProcessContextReplacing<float> &context);
+
+	/**
+		Sets the gain of a band. Changes are smoothed to avoid zipper noise.
+		@param band The band to change.
+		@param gain The linear gain, where 0 kills the band and 1 leaves it unchanged.
+	*/
+	void setBandGain(Band band, float gain);
+
+private:
+	dsp::LinkwitzRileyFilter<float> lowCrossover;  // Splits off the low band
+	dsp::LinkwitzRileyFilter<float> highCrossover; // Splits the rest into mid and high
+	dsp::LinkwitzRileyFilter<float> lowAllpass;	   // Keeps the low band in phase with the high crossover
+	SmoothedValue<float> bandGains[3];			   // Gain of each band
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ThreeBandIsolator)
+};
+
+/**
+	The per-deck processing stage that runs after the resampler, at the device rate.
+	Trim, the 3-band isolator, the high-pass and low-pass filters and the channel
+	gain are a single dsp::ProcessorChain, so the block is processed in place in
+	one stage instead of a chain of AudioSources with their own buffers.
+
+	All setters are meant to be called from the audio thread, at the start of a block.
+*/
+class DeckProcessor
+{
+public:
+	/**
+		Constructor.
+	*/
+	DeckProcessor();
+
+	/**
+		Prepares the chain for playback.
+		@param sampleRate The device sample rate.
+		@param maximumBlockSize The largest block that will be processed.
+		@param numChannels The most channels a block will have. Blocks with fewer only process those.
+	*/
+	void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+
+	/**
+		Clears all filter state.
+	*/
+	void reset();
+
+	/**
+		Processes a block in place.
+		@param bufferToFill The block to process.
+	*/
+	void process(const AudioSourceChannelInfo &bufferToFill);
+
+	/**
+		Sets the trim, applied before the EQ.
+		@param gain The linear trim gain.
+	*/
+	void setTrim(float gain);
+
+	/**
+		Sets the channel gain, applied last.
+		@param gain The linear gain.
+	*/
+	void setGain(float gain);
+
+	/**
+		Sets the gain of one isolator band.
+		@param band The band to change.
+		@param gain The linear gain, 0 to kill the band.
+	*/
+	void setBandGain(ThreeBandIsolator::Band band, float gain);
+
+	/**
+		Sets the high-pass cutoff. A cutoff of 0 bypasses the filter.
+		@param frequency The cutoff in Hz.
+	*/
+	void setHighPassCutoff(float frequency);
+
+	/**
+		Sets the low-pass cutoff. A cutoff of 0 bypasses the filter.
+		@param frequency The cutoff in Hz.
+	*/
+	void setLowPassCutoff(float frequency);
+
+private:
+	enum
+	{
+		trimIndex,
+		isolatorIndex,
+		highPassIndex,
+		lowPassIndex,
+		gainIndex
+	};
+
+	dsp::ProcessorChain<dsp::Gain<float>,
+						ThreeBandIsolator,
+						dsp::StateVariableTPTFilter<float>,
+						dsp::StateVariableTPTFilter<float>,
+						dsp::Gain<float>>
+		chain;						// The whole deck processing stage
+	float maxCutoff = 20000.0f;		// Highest cutoff the filters accept at the current rate
+	int preparedChannels = 2;		// Channels the filters have state for
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeckProcessor)
+};
@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    DecodedTrackCache.cpp
+    Created: 17 Oct 2026 1:36:52pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "DecodedTrackCache.h"
+
+DecodedTrackSource::DecodedTrackSource(std::shared_ptr<const DecodedTrack> _track) : track(std::move(_track))
+{
+    jassert(track != nullptr);
+}
+
+void DecodedTrackSource::prepareToPlay(int, double)
+{
+    // Nothing to allocate, the whole track is already in memory.
+}
+
+void DecodedTrackSource::releaseResources()
+{
+}
+
+void DecodedTrackSource::getNextAudioBlock(const AudioSourceChannelInfo &info)
+{
+    // Copy straight out of the decoded buffer and pad with silence past the end.
+    const auto &samples = track->samples;
+    const auto pos = position.load();
+    const auto available = (int)jlimit<int64>(0, info.numSamples, samples.getNumSamples() - jmax((int64)0, pos));
+
+    for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+    {
+        if (available > 0 && samples.getNumChannels() > 0)
+        {
+            // Mono tracks are copied to every channel.
+            info.buffer->copyFrom(chan, info.startSample, samples, chan % samples.getNumChannels(), (int)pos, available);
+        }
+
+        if (available < info.numSamples)
+        {
+            info.buffer->clear(chan, info.startSample + available, info.numSamples - available);
+        }
+    }
+
+    // Advance unless the playhead was moved while copying.
+    auto expected = pos;
+    position.compare_exchange_strong(expected, pos + info.numSamples);
+}
+
+void DecodedTrackSource::setNextReadPosition(int64 newPosition)
+{
+    position = newPosition;
+}
+
+int64 DecodedTrackSource::getNextReadPosition() const
+{
+    return position.load();
+}
+
+int64 DecodedTrackSource::getTotalLength() const
+{
+    return track->samples.getNumSamples();
+}
+
+bool DecodedTrackSource::isLooping() const
+{
+    return false;
+}
+
+//==============================================================================
+DecodedTrackCache::DecodedTrackCache(size_t memoryBudgetBytes) : memoryBudget(memoryBudgetBytes)
+{
+    // Constructor for DecodedTrackCache class.
+}
+
+int64 DecodedTrackCache::makeKey(const URL &audioURL)
+{
+    // Identify local files by path, size and modification time.
+    if (audioURL.isLocalFile())
+    {
+        const auto file = audioURL.getLocalFile();
+        return makeKey(file, file.getSize(), file.getLastModificationTime().toMilliseconds());
+    }
+
+    return audioURL.toString(false).hashCode64();
+}
+
+int64 DecodedTrackCache::makeKey(const File &file, int64 size, int64 modificationTime)
+{
+    return (file.getFullPathName() + ":" + String(size) + ":" + String(modificationTime)).hashCode64();
+}
+
+std::shared_ptr<const DecodedTrack> DecodedTrackCache::find(int64 key)
+{
+    // Move the entry to the front so it is the last to be evicted.
+    const ScopedLock sl(lock);
+    auto it = entriesByKey.find(key);
+
+    if (it == entriesByKey.end())
+    {
+        return nullptr;
+    }
+
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->track;
+}
+
+std::shared_ptr<const DecodedTrack> DecodedTrackCache::insert(int64 key, std::unique_ptr<DecodedTrack> track)
+{
+    std::shared_ptr<const DecodedTrack> shared(std::move(track));
+    const auto size = shared->getSizeInBytes();
+
+    const ScopedLock sl(lock);
+
+    // Another load may have decoded the same track in the meantime.
+    auto existing = entriesByKey.find(key);
+
+    if (existing != entriesByKey.end())
+    {
+        memoryUsed -= existing->second->track->getSizeInBytes();
+        entries.erase(existing->second);
+        entriesByKey.erase(existing);
+    }
+
+    if (size > memoryBudget)
+    {
+        return shared;
+    }
+
+    evictToFit(size);
+
+    entries.push_front({key, shared});
+    entriesByKey[key] = entries.begin();
+    memoryUsed += size;
+
+    return shared;
+}
+
+bool DecodedTrackCache::canFit(size_t sizeInBytes) const
+{
+    const ScopedLock sl(lock);
+    return sizeInBytes <= memoryBudget;
+}
+
+void DecodedTrackCache::setMemoryBudget(size_t memoryBudgetBytes)
+{
+    const ScopedLock sl(lock);
+    memoryBudget = memoryBudgetBytes;
+    evictToFit(0);
+}
+
+size_t DecodedTrackCache::getMemoryBudget() const
+{
+    const ScopedLock sl(lock);
+    return memoryBudget;
+}
+
+size_t DecodedTrackCache::getMemoryUsed() const
+{
+    const ScopedLock sl(lock);
+    return memoryUsed;
+}
+
+void DecodedTrackCache::evictToFit(size_t bytesNeeded)
+{
+    // Drop the least recently used tracks until there is room.
+    while (!entries.empty() && memoryUsed + bytesNeeded > memoryBudget)
+    {
+        auto &oldest = entries.back();
+        memoryUsed -= oldest.track->getSizeInBytes();
+        entriesByKey.erase(oldest.key);
+        entries.pop_back();
+    }
+}
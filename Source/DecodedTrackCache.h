@@ -0,0 +1,155 @@
+/*
+	==============================================================================
+
+	DecodedTrackCache.h
+	Created: 17 Oct 2026 1:36:52pm
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+	A track that has been fully decoded into float PCM.
+*/
+struct DecodedTrack
+{
+	AudioBuffer<float> samples; // The whole track at its original sample rate
+	double sampleRate = 0.0;	// Sample rate of the track
+
+	/**
+		Returns how much memory the samples take up.
+	*/
+	size_t getSizeInBytes() const
+	{
+		return (size_t)samples.getNumChannels() * (size_t)samples.getNumSamples() * sizeof(float);
+	}
+};
+
+/**
+	Plays a DecodedTrack straight from memory. Seeking only changes an index, so
+	cue and loop jumps don't have to wait for a decoder.
+*/
+class DecodedTrackSource : public PositionableAudioSource
+{
+public:
+	/**
+		Constructor.
+		@param track The decoded track to play. It is kept alive for as long as this source exists.
+	*/
+	DecodedTrackSource(std::shared_ptr<const DecodedTrack> track);
+
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+	void releaseResources() override;
+
+	/**
+		Copies the next block of samples out of the decoded track.
+		@param bufferToFill The buffer to be filled with audio data.
+	*/
+	void getNextAudioBlock(const AudioSourceChannelInfo &bufferToFill) override;
+
+	void setNextReadPosition(int64 newPosition) override;
+	int64 getNextReadPosition() const override;
+	int64 getTotalLength() const override;
+	bool isLooping() const override;
+
+private:
+	std::shared_ptr<const DecodedTrack> track; // The track being played
+	std::atomic<int64> position{0};			   // Position of the playhead in samples
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DecodedTrackSource)
+};
+
+/**
+	A least-recently-used cache of decoded tracks, shared by the decks and the playlist.
+	The total size of the cached tracks is kept under a configurable memory budget.
+
+	Tracks that are still playing on a deck stay alive after being evicted, as the
+	deck holds its own reference; the cache just forgets about them.
+*/
+class DecodedTrackCache
+{
+public:
+	/**
+		Constructor.
+		@param memoryBudgetBytes The most memory the cached tracks may use.
+	*/
+	DecodedTrackCache(size_t memoryBudgetBytes);
+
+	/**
+		Works out the cache key for a track. Local files include their path, size and
+		modification time, so a file that changed on disk is decoded again. Stored
+		overviews, analyses and hot cues use the same key, so they don't follow a file
+		that is retagged, renamed or moved.
+		@param audioURL The URL of the track.
+		@return The key to use with find() and insert().
+	*/
+	static int64 makeKey(const URL &audioURL);
+
+	/**
+		Works out the cache key for a local file whose size and modification time are
+		already known, like a track in the library index, without reading them from disk.
+		@param file The track.
+		@param size The size of the file in bytes.
+		@param modificationTime When the file was last modified, in milliseconds since 1970.
+		@return The same key makeKey() gives for the file's URL.
+	*/
+	static int64 makeKey(const File &file, int64 size, int64 modificationTime);
+
+	/**
+		Looks up a track and marks it as recently used.
+		@param key The key from makeKey().
+		@return The decoded track, or nullptr if it isn't cached.
+	*/
+	std::shared_ptr<const DecodedTrack> find(int64 key);
+
+	/**
+		Adds a decoded track, evicting the least recently used tracks to stay under budget.
+		@param key The key from makeKey().
+		@param track The decoded track.
+		@return The shared track, whether or not it could be kept in the cache.
+	*/
+	std::shared_ptr<const DecodedTrack> insert(int64 key, std::unique_ptr<DecodedTrack> track);
+
+	/**
+		Returns whether a track of the given size is allowed in the cache at all.
+		@param sizeInBytes The size of the decoded track.
+	*/
+	bool canFit(size_t sizeInBytes) const;
+
+	/**
+		Changes the memory budget, evicting tracks if the cache is now over it.
+		@param memoryBudgetBytes The most memory the cached tracks may use.
+	*/
+	void setMemoryBudget(size_t memoryBudgetBytes);
+
+	/**
+		Returns the memory budget in bytes.
+	*/
+	size_t getMemoryBudget() const;
+
+	/**
+		Returns how much memory the cached tracks are using in bytes.
+	*/
+	size_t getMemoryUsed() const;
+
+private:
+	// A cached track and its key. The most recently used entry is at the front.
+	struct Entry
+	{
+		int64 key;
+		std::shared_ptr<const DecodedTrack> track;
+	};
+
+	void evictToFit(size_t bytesNeeded); // Must be called with the lock held
+
+	std::list<Entry> entries;								   // Cached tracks, most recently used first
+	std::map<int64, std::list<Entry>::iterator> entriesByKey; // Index into entries
+	size_t memoryBudget;									   // Most memory the cache may use
+	size_t memoryUsed = 0;									   // Memory used by the cached tracks
+	CriticalSection lock;									   // Guards the above; never used on the audio thread
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DecodedTrackCache)
+};
@@ -0,0 +1,269 @@
+/*
+  ==============================================================================
+
+    HotCueSource.cpp
+    Created: 21 Oct 2026 9:04:18am
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "HotCueSource.h"
+
+HotCueSource::HotCueSource(PositionableAudioSource &_input) : input(_input)
+{
+    // Constructor for HotCueSource class.
+}
+
+HotCueSource::~HotCueSource()
+{
+    // Destructor for HotCueSource class. The audio thread is done with this source, so owned can go.
+}
+
+void HotCueSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    input.prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+void HotCueSource::releaseResources()
+{
+    input.releaseResources();
+}
+
+void HotCueSource::getNextAudioBlock(const AudioSourceChannelInfo &info)
+{
+    applyPendingUpdates();
+
+    const auto newPosition = pendingPosition.exchange(-1);
+
+    if (newPosition >= 0)
+    {
+        startFrom(newPosition);
+    }
+
+    // Play what is left of the attack buffer first.
+    int done = 0;
+
+    if (playing.samples != nullptr)
+    {
+        const auto offset = (int)(attackPosition.load() - playing.start);
+        done = jmin(info.numSamples, playing.samples->getNumSamples() - offset);
+
+        for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+        {
+            info.buffer->copyFrom(chan, info.startSample, *playing.samples,
+                                  jmin(chan, playing.samples->getNumChannels() - 1), offset, done);
+        }
+
+        if (offset + done >= playing.samples->getNumSamples())
+        {
+            playing = Attack();
+            attackPosition = -1;
+        }
+        else
+        {
+            attackPosition = playing.start + offset + done;
+        }
+    }
+
+    // The track source was already moved to the end of the attack buffer, so it carries on seamlessly.
+    if (done < info.numSamples)
+    {
+        input.getNextAudioBlock(AudioSourceChannelInfo(info.buffer, info.startSample + done, info.numSamples - done));
+    }
+}
+
+void HotCueSource::setNextReadPosition(int64 newPosition)
+{
+    // The track source is moved straight away, so it can start decoding even while the deck is
+    // stopped: to the end of the attack buffer the position is in, or to the position itself.
+    // Whether to play from an attack buffer is decided at the next block.
+    newPosition = jmax((int64)0, newPosition);
+    auto trackPosition = newPosition;
+
+    for (size_t i = 0; i < attackRanges.size(); ++i)
+    {
+        const auto start = attackRanges[i].start.load();
+        const auto end = attackRanges[i].end.load();
+
+        if (newPosition >= start && newPosition < end)
+        {
+            trackPosition = end;
+            break;
+        }
+    }
+
+    pendingPosition = newPosition;
+    input.setNextReadPosition(trackPosition);
+}
+
+int64 HotCueSource::getNextReadPosition() const
+{
+    const auto pending = pendingPosition.load();
+
+    if (pending >= 0)
+    {
+        return pending;
+    }
+
+    const auto inAttack = attackPosition.load();
+    return inAttack >= 0 ? inAttack : input.getNextReadPosition();
+}
+
+int64 HotCueSource::getTotalLength() const
+{
+    return input.getTotalLength();
+}
+
+bool HotCueSource::isLooping() const
+{
+    return false;
+}
+
+void HotCueSource::setAttack(int index, int64 startSample, std::shared_ptr<const AudioBuffer<float>> samples)
+{
+    // Delete the buffers the audio thread has let go of, then send it the new one.
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+
+    const AudioBuffer<float> *done = nullptr;
+
+    while (retired.pop(done))
+    {
+        owned.erase(std::remove_if(owned.begin(), owned.end(), [done](const std::shared_ptr<const AudioBuffer<float>> &buffer)
+                                   { return buffer.get() == done; }),
+                    owned.end());
+    }
+
+    if (index < 0 || index >= numCues)
+    {
+        std::cout << "HotCueSource::Invalid hot cue: " << index << "Hot cue should be 0 to " << numCues - 1 << std::endl;
+        return;
+    }
+
+    if (samples != nullptr && samples->getNumSamples() == 0)
+    {
+        samples = nullptr;
+    }
+
+    if (!updates.push({index, {startSample, samples.get()}}))
+    {
+        return;
+    }
+
+    // Seeks look the range up here, so they can move the track source once without asking the audio thread.
+    attackRanges[(size_t)index].end = samples != nullptr ? startSample + samples->getNumSamples() : (int64)-1;
+    attackRanges[(size_t)index].start = startSample;
+
+    if (samples != nullptr)
+    {
+        owned.push_back(std::move(samples));
+    }
+}
+
+void HotCueSource::applyPendingUpdates()
+{
+    // Runs at the top of every block on the audio thread.
+    Update update;
+
+    while (updates.pop(update))
+    {
+        auto &attack = attacks[(size_t)update.index];
+
+        if (attack.samples != nullptr)
+        {
+            // Stop playing from a buffer that is being replaced, and read the track from the same place.
+            if (attack.samples == playing.samples)
+            {
+                input.setNextReadPosition(attackPosition.load());
+                playing = Attack();
+                attackPosition = -1;
+            }
+
+            // If the queue is full the buffer is simply kept until this source is deleted.
+            retired.push(attack.samples);
+        }
+
+        attack = update.attack;
+    }
+}
+
+void HotCueSource::startFrom(int64 position)
+{
+    // Play from RAM if the position is in an attack buffer, with the track decoding ahead from its end.
+    // setNextReadPosition already moved the track source there; it only has to move again if an
+    // attack buffer changed in between.
+    playing = Attack();
+    attackPosition = -1;
+    auto trackPosition = position;
+
+    for (const auto &attack : attacks)
+    {
+        if (attack.samples != nullptr && position >= attack.start && position < attack.start + attack.samples->getNumSamples())
+        {
+            playing = attack;
+            attackPosition = position;
+            trackPosition = attack.start + attack.samples->getNumSamples();
+            break;
+        }
+    }
+
+    if (input.getNextReadPosition() != trackPosition)
+    {
+        input.setNextReadPosition(trackPosition);
+    }
+}
+
+//==============================================================================
+HotCueStore::HotCueStore(const File &_folder) : folder(_folder)
+{
+    // Keep the cues with the user's application data unless told otherwise.
+    if (folder == File())
+    {
+        folder = File::getSpecialLocation(File::userApplicationDataDirectory).getChildFile("xDecks").getChildFile("Cues");
+    }
+
+    folder.createDirectory();
+}
+
+HotCueSource::Cues HotCueStore::load(int64 key) const
+{
+    // A track that has never had a cue has no file.
+    HotCueSource::Cues cues;
+    cues.fill(-1);
+
+    const auto stored = JSON::parse(getFileForKey(key));
+
+    if (auto *list = stored.getProperty("cues", var()).getArray())
+    {
+        for (int i = 0; i < jmin((int)cues.size(), list->size()); ++i)
+        {
+            cues[(size_t)i] = (int64)(*list)[i];
+        }
+    }
+
+    return cues;
+}
+
+void HotCueStore::save(int64 key, const HotCueSource::Cues &cues) const
+{
+    // Write the whole set of cues, every cue that isn't set as -1.
+    Array<var> list;
+
+    for (const auto cue : cues)
+    {
+        list.add(cue);
+    }
+
+    auto *object = new DynamicObject();
+    object->setProperty("cues", list);
+
+    if (!getFileForKey(key).replaceWithText(JSON::toString(var(object))))
+    {
+        std::cout << "HotCueStore::Couldn't write " << getFileForKey(key).getFullPathName() << std::endl;
+    }
+}
+
+File HotCueStore::getFileForKey(int64 key) const
+{
+    return folder.getChildFile(String::toHexString(key) + ".json");
+}
@@ -0,0 +1,144 @@
+/*
+	==============================================================================
+
+	HotCueSource.h
+	Created: 21 Oct 2026 9:04:18am
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "LockFreeQueue.h"
+
+/**
+	Sits between a deck's track source and its loop engine and plays the start of
+	each hot cue from memory.
+
+	Each hot cue can be given an attack buffer: a second or so of the track decoded
+	from the cue point onwards. When the playhead is moved into an attack buffer the
+	audio comes from RAM on the very next block, and the track source is moved once,
+	straight to the end of the buffer, so a streamed track has the whole buffer's
+	length to decode ahead before it has to take over. Attack buffers are handed to the audio thread
+	through a lock-free queue and only deleted on the message thread.
+*/
+class HotCueSource : public PositionableAudioSource
+{
+public:
+	/** The number of hot cues of a track. */
+	static constexpr int numCues = 8;
+
+	/** The position of each hot cue in samples of the track, -1 if it isn't set. */
+	using Cues = std::array<int64, numCues>;
+
+	/**
+		Constructor.
+		@param input The track source. It must outlive this object.
+	*/
+	HotCueSource(PositionableAudioSource &input);
+
+	/**
+		Destructor.
+	*/
+	~HotCueSource() override;
+
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+	void releaseResources() override;
+
+	/**
+		Reads the next block from the attack buffer the playhead is in, if there is one,
+		and from the track source after it.
+		@param bufferToFill The buffer to be filled with audio data.
+	*/
+	void getNextAudioBlock(const AudioSourceChannelInfo &bufferToFill) override;
+
+	/**
+		Moves the playhead. Whether it plays from an attack buffer is decided at the start of the next block.
+		@param newPosition The new position in samples.
+	*/
+	void setNextReadPosition(int64 newPosition) override;
+	int64 getNextReadPosition() const override;
+	int64 getTotalLength() const override;
+	bool isLooping() const override;
+
+	/**
+		Gives a hot cue the audio from its cue point onwards. Only call this from the message thread.
+		@param index The hot cue, from 0 to numCues - 1.
+		@param startSample The cue point in samples.
+		@param samples The decoded audio from the cue point, or nullptr to drop the cue's attack buffer.
+	*/
+	void setAttack(int index, int64 startSample, std::shared_ptr<const AudioBuffer<float>> samples);
+
+private:
+	// An attack buffer as seen by the audio thread.
+	struct Attack
+	{
+		int64 start = 0;							 // Position of the first sample in the track
+		const AudioBuffer<float> *samples = nullptr; // The audio, or nullptr if the cue has none
+	};
+
+	// Where an attack buffer sits in the track, for seeks. end is -1 if the cue has no buffer.
+	struct AttackRange
+	{
+		std::atomic<int64> start{0};
+		std::atomic<int64> end{-1};
+	};
+
+	// A new attack buffer for a cue, sent from the message thread to the audio thread.
+	struct Update
+	{
+		int index = 0;
+		Attack attack;
+	};
+
+	void applyPendingUpdates();
+	void startFrom(int64 position);
+
+	PositionableAudioSource &input;								   // The track being played
+	LockFreeQueue<Update, 32> updates;							   // Attack buffers waiting for the audio thread
+	LockFreeQueue<const AudioBuffer<float> *, 64> retired;		   // Attack buffers the audio thread no longer uses
+	std::vector<std::shared_ptr<const AudioBuffer<float>>> owned; // Every attack buffer not deleted yet, only touched on the message thread
+	std::array<AttackRange, numCues> attackRanges;				   // Where each cue's attack buffer is, as last set on the message thread
+
+	// State owned by the audio thread
+	std::array<Attack, numCues> attacks;	 // The attack buffer of each cue
+	Attack playing;							 // The attack buffer being played from
+	std::atomic<int64> pendingPosition{-1};	 // Position to move to at the start of the next block, -1 if none
+	std::atomic<int64> attackPosition{-1};	 // Position of the playhead inside the playing attack buffer, -1 when reading the track
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HotCueSource)
+};
+
+/**
+	Keeps the hot cues of each track on disk, as one small JSON file per track in the
+	user's application data folder, named after the DecodedTrackCache key.
+*/
+class HotCueStore
+{
+public:
+	/**
+		Constructor.
+		@param folder Where to keep the cues. Defaults to a folder in the user's application data.
+	*/
+	HotCueStore(const File &folder = File());
+
+	/**
+		Reads the hot cues of a track.
+		@param key The track's key from DecodedTrackCache::makeKey().
+		@return The cues, all -1 if the track has none.
+	*/
+	HotCueSource::Cues load(int64 key) const;
+
+	/**
+		Stores the hot cues of a track.
+		@param key The track's key from DecodedTrackCache::makeKey().
+		@param cues The cues.
+	*/
+	void save(int64 key, const HotCueSource::Cues &cues) const;
+
+private:
+	File getFileForKey(int64 key) const;
+
+	File folder; // Where the cues are kept
+};
@@ -0,0 +1,74 @@
+/*
+	==============================================================================
+
+	LockFreeQueue.h
+	Created: 18 Oct 2026 9:41:33am
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+	A fixed-size single-producer, single-consumer queue built on AbstractFifo.
+	The message thread pushes commands and the audio thread pops them at the top
+	of getNextAudioBlock, without either side ever taking a lock or allocating.
+*/
+template <typename ItemType, int capacity>
+class LockFreeQueue
+{
+public:
+	/**
+		Adds an item to the queue. Only call this from one thread.
+		@param item The item to add.
+		@return False if the queue was full and the item was dropped.
+	*/
+	bool push(const ItemType &item)
+	{
+		const auto scope = fifo.write(1);
+
+		if (scope.blockSize1 > 0)
+		{
+			items[(size_t)scope.startIndex1] = item;
+			return true;
+		}
+
+		if (scope.blockSize2 > 0)
+		{
+			items[(size_t)scope.startIndex2] = item;
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+		Takes the oldest item off the queue. Only call this from one thread.
+		@param item Receives the item.
+		@return False if the queue was empty.
+	*/
+	bool pop(ItemType &item)
+	{
+		const auto scope = fifo.read(1);
+
+		if (scope.blockSize1 > 0)
+		{
+			item = items[(size_t)scope.startIndex1];
+			return true;
+		}
+
+		if (scope.blockSize2 > 0)
+		{
+			item = items[(size_t)scope.startIndex2];
+			return true;
+		}
+
+		return false;
+	}
+
+private:
+	AbstractFifo fifo{capacity};			// Tracks the read and write positions
+	std::array<ItemType, capacity> items{}; // Storage for the queued items
+};
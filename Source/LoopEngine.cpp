@@ -0,0 +1,451 @@
+/*
+  ==============================================================================
+
+    LoopEngine.cpp
+    Created: 18 Oct 2026 9:58:02am
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "LoopEngine.h"
+
+// Length of the crossfade over the loop seam. Short enough not to smear
+// transients, long enough to hide the click of the jump.
+static constexpr double seamFadeSeconds = 0.003;
+
+// Halving stops at this length so a loop never collapses to nothing.
+static constexpr int64 minimumLoopLength = 64;
+
+LoopEngine::LoopEngine(PositionableAudioSource &_input) : input(_input)
+{
+    // Constructor for LoopEngine class.
+}
+
+void LoopEngine::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    // Allocate the crossfade buffer here so the audio thread never has to.
+    input.prepareToPlay(samplesPerBlockExpected, sampleRate);
+
+    fadeLength = jmax(1, roundToInt(sampleRate * seamFadeSeconds));
+    tail.setSize(2, fadeLength);
+    tail.clear();
+    tailLength = 0;
+    tailOffset = 0;
+}
+
+void LoopEngine::releaseResources()
+{
+    input.releaseResources();
+    tail.setSize(2, 0);
+    tailLength = 0;
+}
+
+void LoopEngine::getNextAudioBlock(const AudioSourceChannelInfo &info)
+{
+    // A seek from the message thread moves the scheduled changes to the grid around the new position.
+    if (numScheduled > 0 && input.getNextReadPosition() != expectedPosition)
+    {
+        reschedule();
+    }
+
+    applyPendingCommands();
+
+    int done = 0;
+
+    while (done < info.numSamples)
+    {
+        runScheduledCommands();
+
+        const auto pos = input.getNextReadPosition();
+        auto num = info.numSamples - done;
+        bool reachesSeam = false;
+
+        if (loopIsActive())
+        {
+            const auto loopLength = loopOut - loopIn;
+
+            // The playhead is past the out point, e.g. after halving the loop,
+            // so wrap it back into the loop at the same phase.
+            if (pos >= loopOut)
+            {
+                jumpWithCrossfade(loopIn + (pos - loopIn) % loopLength);
+                continue;
+            }
+
+            // Stop reading exactly at the out point.
+            if (loopOut - pos <= num)
+            {
+                num = (int)(loopOut - pos);
+                reachesSeam = true;
+            }
+        }
+
+        // Stop reading at the next scheduled change as well, so it happens on its exact sample.
+        const auto next = getNextScheduledPosition();
+
+        if (next - pos < num)
+        {
+            num = (int)(next - pos);
+            reachesSeam = false;
+        }
+
+        readFromInput(AudioSourceChannelInfo(info.buffer, info.startSample + done, num));
+        done += num;
+
+        // The timeline keeps running underneath a roll.
+        if (rolling)
+        {
+            rollReturnPosition += num;
+        }
+
+        if (reachesSeam)
+        {
+            // Changes due at the out point happen before the jump back, so the loop can be left at its end.
+            runScheduledCommands();
+
+            if (loopIsActive() && input.getNextReadPosition() >= loopOut)
+            {
+                jumpWithCrossfade(loopIn);
+            }
+        }
+    }
+
+    expectedPosition = input.getNextReadPosition();
+    publishedIn = loopIn;
+    publishedOut = loopOut;
+    publishedEnabled = enabled;
+}
+
+void LoopEngine::setNextReadPosition(int64 newPosition)
+{
+    input.setNextReadPosition(newPosition);
+}
+
+int64 LoopEngine::getNextReadPosition() const
+{
+    return input.getNextReadPosition();
+}
+
+int64 LoopEngine::getTotalLength() const
+{
+    return input.getTotalLength();
+}
+
+bool LoopEngine::isLooping() const
+{
+    return false;
+}
+
+void LoopEngine::setLoopInAtPlayhead(Timing timing)
+{
+    commands.push({Command::setIn, 0, 0, timing});
+}
+
+void LoopEngine::setLoopOutAtPlayhead(Timing timing)
+{
+    commands.push({Command::setOut, 0, 0, timing});
+}
+
+void LoopEngine::setLoopPoints(int64 inSample, int64 outSample)
+{
+    commands.push({Command::setPoints, inSample, outSample});
+}
+
+void LoopEngine::setLoopEnabled(bool shouldLoop, Timing timing)
+{
+    commands.push({shouldLoop ? Command::enable : Command::disable, 0, 0, timing});
+}
+
+void LoopEngine::halveLoop()
+{
+    commands.push({Command::halve, 0, 0});
+}
+
+void LoopEngine::doubleLoop()
+{
+    commands.push({Command::doubleLength, 0, 0});
+}
+
+void LoopEngine::startLoopRoll(int64 lengthInSamples)
+{
+    commands.push({Command::startRoll, lengthInSamples, 0});
+}
+
+void LoopEngine::stopLoopRoll()
+{
+    commands.push({Command::stopRoll, 0, 0});
+}
+
+void LoopEngine::jumpTo(int64 position, bool crossfade, Timing timing)
+{
+    commands.push({Command::jump, position, crossfade ? 1 : 0, timing});
+}
+
+void LoopEngine::jumpBeats(int beats, bool crossfade, Timing timing)
+{
+    commands.push({Command::jumpBeats, beats, crossfade ? 1 : 0, timing});
+}
+
+void LoopEngine::setBeatGrid(double downbeatSample, double beatLength)
+{
+    // Read by the audio thread whenever a change is scheduled.
+    gridDownbeat = downbeatSample;
+    gridBeatLength = jmax(0.0, beatLength);
+}
+
+int64 LoopEngine::getLoopInSample() const
+{
+    return publishedIn.load();
+}
+
+int64 LoopEngine::getLoopOutSample() const
+{
+    return publishedOut.load();
+}
+
+bool LoopEngine::isLoopEnabled() const
+{
+    return publishedEnabled.load();
+}
+
+void LoopEngine::applyPendingCommands()
+{
+    // Runs at the top of every block on the audio thread. Changes timed to the beat grid
+    // wait in scheduled until the playhead reaches their position.
+    Command command;
+
+    while (commands.pop(command))
+    {
+        if (command.timing != Timing::now && gridBeatLength.load() > 0.0 && numScheduled < maxScheduled)
+        {
+            command.at = getScheduledPosition(input.getNextReadPosition(), command.timing);
+            scheduled[(size_t)numScheduled++] = command;
+        }
+        else
+        {
+            applyCommand(command);
+        }
+    }
+}
+
+void LoopEngine::applyCommand(const Command &command)
+{
+    // Only called on the audio thread, either from the queue or when a scheduled change is due.
+    const auto pos = input.getNextReadPosition();
+    const auto totalLength = input.getTotalLength();
+
+    switch (command.type)
+    {
+    case Command::setIn:
+        loopIn = pos;
+        if (loopOut <= loopIn)
+        {
+            loopOut = 0;
+        }
+        break;
+    case Command::setOut:
+        loopOut = pos;
+        if (loopOut <= loopIn)
+        {
+            loopIn = 0;
+        }
+        break;
+    case Command::setPoints:
+        loopIn = jmax((int64)0, command.first);
+        loopOut = jmin(totalLength, command.second);
+        break;
+    case Command::enable:
+        enabled = true;
+        break;
+    case Command::disable:
+        enabled = false;
+        break;
+    case Command::halve:
+        if (loopOut > loopIn)
+        {
+            loopOut = loopIn + jmax(minimumLoopLength, (loopOut - loopIn) / 2);
+        }
+        break;
+    case Command::doubleLength:
+        if (loopOut > loopIn)
+        {
+            loopOut = jmin(totalLength, loopIn + (loopOut - loopIn) * 2);
+        }
+        break;
+    case Command::startRoll:
+        // Remember the real loop, then loop from the playhead.
+        if (!rolling)
+        {
+            savedIn = loopIn;
+            savedOut = loopOut;
+            savedEnabled = enabled;
+            rollReturnPosition = pos;
+            rolling = true;
+        }
+        loopIn = pos;
+        loopOut = jmin(totalLength, pos + jmax(minimumLoopLength, command.first));
+        enabled = true;
+        break;
+    case Command::stopRoll:
+        // Restore the real loop and carry on where the track would have been.
+        if (rolling)
+        {
+            rolling = false;
+            loopIn = savedIn;
+            loopOut = savedOut;
+            enabled = savedEnabled;
+            jumpWithCrossfade(rollReturnPosition);
+        }
+        break;
+    case Command::jump:
+    case Command::jumpBeats:
+    {
+        // A beat jump keeps the playhead's place in the beat.
+        const auto beatLength = gridBeatLength.load();
+
+        if (command.type == Command::jumpBeats && beatLength <= 0.0)
+        {
+            break;
+        }
+
+        const auto target = command.type == Command::jump ? command.first
+                                                          : jmax((int64)0, pos + (int64)std::llround((double)command.first * beatLength));
+
+        if (command.second != 0)
+        {
+            jumpWithCrossfade(target);
+        }
+        else
+        {
+            tailLength = 0;
+            input.setNextReadPosition(target);
+            reschedule();
+        }
+        break;
+    }
+    }
+}
+
+void LoopEngine::runScheduledCommands()
+{
+    // Run every scheduled change the playhead has reached, oldest first. A change can move
+    // the playhead, so the search starts again after each one.
+    for (int i = 0; i < numScheduled;)
+    {
+        if (scheduled[(size_t)i].at > input.getNextReadPosition())
+        {
+            ++i;
+            continue;
+        }
+
+        const auto command = scheduled[(size_t)i];
+        std::move(scheduled.begin() + i + 1, scheduled.begin() + numScheduled, scheduled.begin() + i);
+        --numScheduled;
+        applyCommand(command);
+        i = 0;
+    }
+}
+
+void LoopEngine::reschedule()
+{
+    // The playhead has jumped, so each waiting change goes to the next beat or bar from there.
+    const auto pos = input.getNextReadPosition();
+
+    for (int i = 0; i < numScheduled; ++i)
+    {
+        scheduled[(size_t)i].at = getScheduledPosition(pos, scheduled[(size_t)i].timing);
+    }
+}
+
+int64 LoopEngine::getScheduledPosition(int64 position, Timing timing) const
+{
+    // Round up to the next beat or bar line; a playhead that is already on one goes straight away.
+    const auto beatLength = gridBeatLength.load();
+
+    if (timing == Timing::now || beatLength <= 0.0)
+    {
+        return position;
+    }
+
+    const auto origin = gridDownbeat.load();
+    const auto step = timing == Timing::nextBar ? beatLength * 4.0 : beatLength;
+    auto at = (int64)std::llround(origin + std::ceil((double)(position - origin) / step) * step);
+
+    // Inside a loop the grid line may never be reached, so the out point is the latest it can happen.
+    if (loopIsActive() && position < loopOut)
+    {
+        at = jmin(at, loopOut);
+    }
+
+    return jmax(position, at);
+}
+
+int64 LoopEngine::getNextScheduledPosition() const
+{
+    auto next = std::numeric_limits<int64>::max();
+
+    for (int i = 0; i < numScheduled; ++i)
+    {
+        next = jmin(next, scheduled[(size_t)i].at);
+    }
+
+    return next;
+}
+
+bool LoopEngine::loopIsActive() const
+{
+    return enabled && loopOut > loopIn;
+}
+
+void LoopEngine::jumpWithCrossfade(int64 newPosition)
+{
+    // Keep the audio that follows the current position so it can be faded out
+    // while the audio at the new position fades in.
+    auto length = fadeLength;
+
+    if (loopIsActive())
+    {
+        length = (int)jmin((int64)length, (loopOut - loopIn) / 2);
+    }
+
+    length = jmin(length, tail.getNumSamples());
+
+    if (length > 0)
+    {
+        input.getNextAudioBlock(AudioSourceChannelInfo(&tail, 0, length));
+    }
+
+    tailLength = length;
+    tailOffset = 0;
+    input.setNextReadPosition(newPosition);
+    reschedule();
+}
+
+void LoopEngine::readFromInput(const AudioSourceChannelInfo &info)
+{
+    if (info.numSamples <= 0)
+    {
+        return;
+    }
+
+    input.getNextAudioBlock(info);
+
+    // Crossfade from the audio past the seam into the audio after the jump.
+    if (tailOffset < tailLength)
+    {
+        const auto num = jmin(info.numSamples, tailLength - tailOffset);
+        const auto startGain = (float)tailOffset / (float)tailLength;
+        const auto endGain = (float)(tailOffset + num) / (float)tailLength;
+
+        for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+        {
+            info.buffer->applyGainRamp(chan, info.startSample, num, startGain, endGain);
+            info.buffer->addFromWithRamp(chan, info.startSample,
+                                         tail.getReadPointer(jmin(chan, tail.getNumChannels() - 1), tailOffset),
+                                         num, 1.0f - startGain, 1.0f - endGain);
+        }
+
+        tailOffset += num;
+    }
+}
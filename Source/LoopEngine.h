@@ -0,0 +1,219 @@
+/*
+	==============================================================================
+
+	LoopEngine.h
+	Created: 18 Oct 2026 9:58:02am
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "LockFreeQueue.h"
+
+/**
+	Sits between a deck's track source and its transport and applies loops on the
+	audio thread with sample accuracy.
+
+	Loop points are stored in samples of the track. When the playhead reaches the
+	out point it jumps back to the in point within the same block, and the seam is
+	covered by a short crossfade. Loop changes are sent from the message thread
+	through a lock-free queue and applied at the start of the next block, so halving,
+	doubling and rolls never wait for the GUI timer.
+
+	A change can also be scheduled for the next beat or bar of the track's beat grid.
+	It is resolved to a sample of the track when it reaches the audio thread, and the
+	block is split there so it happens on that exact sample. Inside an active loop a
+	change that would fall past the out point happens at the out point instead, so a
+	loop can always be left at its end.
+*/
+class LoopEngine : public PositionableAudioSource
+{
+public:
+	/** When a change sent to the loop engine happens. */
+	enum class Timing
+	{
+		now,	  // At the start of the next block
+		nextBeat, // When the playhead reaches the next beat of the grid
+		nextBar	  // When the playhead reaches the next downbeat of a bar
+	};
+
+	/**
+		Constructor.
+		@param input The track source to loop. It must outlive this object.
+	*/
+	LoopEngine(PositionableAudioSource &input);
+
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+	void releaseResources() override;
+
+	/**
+		Reads the next block from the track, jumping back to the in point whenever
+		the out point is reached.
+		@param bufferToFill The buffer to be filled with audio data.
+	*/
+	void getNextAudioBlock(const AudioSourceChannelInfo &bufferToFill) override;
+
+	void setNextReadPosition(int64 newPosition) override;
+	int64 getNextReadPosition() const override;
+	int64 getTotalLength() const override;
+	bool isLooping() const override;
+
+	/**
+		Sets the loop in point to the playhead position.
+		If the out point is before it, the out point is cleared.
+		@param timing When to take the playhead position.
+	*/
+	void setLoopInAtPlayhead(Timing timing = Timing::now);
+
+	/**
+		Sets the loop out point to the playhead position.
+		If the in point is after it, the in point is moved to the start of the track.
+		@param timing When to take the playhead position.
+	*/
+	void setLoopOutAtPlayhead(Timing timing = Timing::now);
+
+	/**
+		Sets both loop points.
+		@param inSample The loop in point in samples.
+		@param outSample The loop out point in samples.
+	*/
+	void setLoopPoints(int64 inSample, int64 outSample);
+
+	/**
+		Turns the loop on or off. A loop is only active if its out point is after its in point.
+		@param shouldLoop True to loop.
+		@param timing When to turn it on or off.
+	*/
+	void setLoopEnabled(bool shouldLoop, Timing timing = Timing::now);
+
+	/**
+		Halves the length of the loop, keeping the in point.
+	*/
+	void halveLoop();
+
+	/**
+		Doubles the length of the loop, keeping the in point.
+	*/
+	void doubleLoop();
+
+	/**
+		Starts a loop roll: a temporary loop from the playhead while the timeline keeps
+		running underneath, so playback continues where it would have been when the roll stops.
+		@param lengthInSamples The length of the rolled loop.
+	*/
+	void startLoopRoll(int64 lengthInSamples);
+
+	/**
+		Ends the loop roll and jumps to where the track would have been without it.
+	*/
+	void stopLoopRoll();
+
+	/**
+		Moves the playhead, for hot cues.
+		@param position The new position in samples.
+		@param crossfade True to fade out the audio being left, false if nothing was playing.
+		@param timing When to jump.
+	*/
+	void jumpTo(int64 position, bool crossfade, Timing timing = Timing::now);
+
+	/**
+		Moves the playhead a number of beats along the beat grid. Nothing happens if
+		the track has no beat grid.
+		@param beats How far to jump, negative to jump back.
+		@param crossfade True to fade out the audio being left, false if nothing was playing.
+		@param timing When to jump.
+	*/
+	void jumpBeats(int beats, bool crossfade, Timing timing = Timing::now);
+
+	/**
+		Sets the beat grid that scheduled changes are timed against. Without a beat grid
+		every change happens at the start of the next block.
+		@param downbeatSample The position of the first downbeat in samples.
+		@param beatLength The length of a beat in samples, or 0 if the track has no beat grid.
+	*/
+	void setBeatGrid(double downbeatSample, double beatLength);
+
+	/**
+		Returns the loop in point as last applied by the audio thread.
+	*/
+	int64 getLoopInSample() const;
+
+	/**
+		Returns the loop out point as last applied by the audio thread.
+	*/
+	int64 getLoopOutSample() const;
+
+	/**
+		Returns whether the loop is on, as last applied by the audio thread.
+	*/
+	bool isLoopEnabled() const;
+
+private:
+	// A change to the loop, sent from the message thread to the audio thread.
+	struct Command
+	{
+		enum Type
+		{
+			setIn,
+			setOut,
+			setPoints,
+			enable,
+			disable,
+			halve,
+			doubleLength,
+			startRoll,
+			stopRoll,
+			jump,
+			jumpBeats
+		};
+
+		Type type = enable;
+		int64 first = 0;
+		int64 second = 0;
+		Timing timing = Timing::now;
+		int64 at = 0; // Where a scheduled change happens, in samples of the track
+	};
+
+	// The most changes that can wait for their beat at once.
+	static constexpr int maxScheduled = 16;
+
+	void applyPendingCommands();
+	void applyCommand(const Command &command);
+	void runScheduledCommands();
+	void reschedule();
+	int64 getScheduledPosition(int64 position, Timing timing) const;
+	int64 getNextScheduledPosition() const;
+	bool loopIsActive() const;
+	void jumpWithCrossfade(int64 newPosition);
+	void readFromInput(const AudioSourceChannelInfo &info);
+
+	PositionableAudioSource &input;					// The track being played
+	LockFreeQueue<Command, 64> commands;			// Loop changes waiting for the audio thread
+	std::atomic<double> gridDownbeat{0.0};			// Position of the first downbeat in samples
+	std::atomic<double> gridBeatLength{0.0};		// Length of a beat in samples, 0 without a beat grid
+
+	// State owned by the audio thread
+	int64 loopIn = 0;								// Loop in point in samples
+	int64 loopOut = 0;								// Loop out point in samples
+	bool enabled = false;							// Whether the loop is on
+	bool rolling = false;							// Whether a loop roll is in progress
+	int64 rollReturnPosition = 0;					// Where the timeline would be without the roll
+	int64 savedIn = 0, savedOut = 0;				// Loop points to restore after a roll
+	bool savedEnabled = false;						// Loop state to restore after a roll
+	AudioBuffer<float> tail;						// Audio just past the seam, faded out after a jump
+	int fadeLength = 0;								// Length of the seam crossfade in samples
+	int tailLength = 0;								// How much of tail is being used for the current crossfade
+	int tailOffset = 0;								// How much of the current crossfade has been played
+	std::array<Command, maxScheduled> scheduled;	// Changes waiting for their beat, oldest first
+	int numScheduled = 0;							// How many of scheduled are in use
+	int64 expectedPosition = 0;						// Where the playhead was left by the last block
+
+	// Published for the message thread
+	std::atomic<int64> publishedIn{0};
+	std::atomic<int64> publishedOut{0};
+	std::atomic<bool> publishedEnabled{false};
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopEngine)
+};
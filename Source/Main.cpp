@@ -10,6 +10,8 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MainComponent.h"
+#include "OfflineRenderer.h"
+#include "ResamplerBenchmark.h"
 
 //==============================================================================
 class xDecksApplication : public JUCEApplication
@@ -26,7 +28,31 @@ public:
     {
         // This method is where you should put your application's initialisation code..
 
-        mainWindow.reset(new MainWindow(getApplicationName()));
+        auto args = StringArray::fromTokens(commandLine, true);
+
+        // "--render timeline.json" renders a mix without opening a window or an audio device
+        if (args.contains("--render"))
+        {
+            OfflineRenderer renderer;
+            setApplicationReturnValue(renderer.runFromCommandLine(args));
+            quit();
+            return;
+        }
+
+        // "--benchmark-resampler" compares the deck's resampler with the old two-pass chain
+        if (args.contains("--benchmark-resampler"))
+        {
+            ResamplerBenchmark benchmark;
+            setApplicationReturnValue(benchmark.runFromCommandLine(args));
+            quit();
+            return;
+        }
+
+        // "--decks 4" opens the app with four decks instead of two
+        const int deckIndex = args.indexOf("--decks");
+        const int numberOfDecks = deckIndex >= 0 ? args[deckIndex + 1].getIntValue() : 2;
+
+        mainWindow.reset(new MainWindow(getApplicationName(), numberOfDecks));
     }
 
     void shutdown() override
@@ -59,13 +85,13 @@ public:
     class MainWindow : public DocumentWindow
     {
     public:
-        MainWindow(String name) : DocumentWindow(name,
+        MainWindow(String name, int numberOfDecks) : DocumentWindow(name,
             Desktop::getInstance().getDefaultLookAndFeel()
             .findColour(ResizableWindow::backgroundColourId),
             DocumentWindow::allButtons)
         {
             setUsingNativeTitleBar(true);
-            setContentOwned(new MainComponent(), true);
+            setContentOwned(new MainComponent(numberOfDecks), true);
 
 #if JUCE_IOS || JUCE_ANDROID
             setFullScreen(true);
@@ -10,45 +10,89 @@
 
 //==============================================================================
 
-MainComponent::MainComponent() : AudioAppComponent::AudioAppComponent()
+MainComponent::MainComponent(int numberOfDecks) : AudioAppComponent::AudioAppComponent()
 {
-    // Make sure you set the size of the component after
-    // you add any child components.
-    setSize(1000, 750);
-  
-    // Specify the number of input and output channels that we want to open
-    setAudioChannels(0, 2, nullptr);
-    // }
-    addAndMakeVisible(deckGUI1);
-    addAndMakeVisible(deckGUI2);
+    // The decks decode compressed files on this thread instead of the audio callback
+    decodeThread.startThread(Thread::Priority::high);
+
+    // Create the decks and the mixer before the audio device starts asking for audio
+    numberOfDecks = jlimit(2, MixerEngine::maxChannels, numberOfDecks);
+    Array<AudioSource *> mixerInputs;
+
+    for (int i = 0; i < numberOfDecks; ++i)
+    {
+        auto *player = players.add(new DJAudioPlayer(formatManager, &decodeThread));
+        addAndMakeVisible(deckGUIs.add(new DeckGUI(player, formatManager, thumbnailCache, trackLoader, waveformStore, trackAnalyser)));
+        mixerInputs.add(player);
+    }
+
+    // SYNC follows the first other deck that is playing a track with a beat grid,
+    // or failing that any other deck with a beat grid
+    for (auto *deckGUI : deckGUIs)
+    {
+        deckGUI->chooseSyncLeader = [this](DJAudioPlayer *follower) -> DJAudioPlayer *
+        {
+            DJAudioPlayer *fallback = nullptr;
+
+            for (auto *candidate : players)
+            {
+                if (candidate != follower && candidate->hasBeatGrid() && candidate->getSyncLeader() != follower)
+                {
+                    if (candidate->isPlaying())
+                    {
+                        return candidate;
+                    }
+
+                    fallback = fallback != nullptr ? fallback : candidate;
+                }
+            }
+
+            return fallback;
+        };
+    }
+
+    mixer.reset(new MixerEngine(mixerInputs));
+    mixerComponent.reset(new MixerComponent(*mixer, mixRecorder));
+    addAndMakeVisible(*mixerComponent);
     addAndMakeVisible(playlistComponent);
 
     formatManager.registerBasicFormats();
 
+    // Look for tracks that were added, changed or removed since the library was last indexed
+    trackLibrary.rescan();
+
+    // Make sure you set the size of the component after
+    // you add any child components.
+    setSize(1000, numberOfDecks > 2 ? 1000 : 750);
+
+    // Specify the number of input and output channels that we want to open
+    setAudioChannels(0, 2, nullptr);
 }
 
 MainComponent::~MainComponent()
 {
     // This shuts down the audio device and clears the audio source.
     shutdownAudio();
+    decodeThread.stopThread(2000);
 
 }
 
 //==============================================================================
 void MainComponent::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
 {
-    player1.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    player2.prepareToPlay(samplesPerBlockExpected, sampleRate);
-
-    mixerSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    
-    mixerSource.addInputSource(&player1, false);
-    mixerSource.addInputSource(&player2, false);
+    // The mixer prepares each deck, for as many channels as the device plays
+    const auto *device = deviceManager.getCurrentAudioDevice();
+    mixer->setNumOutputChannels(device != nullptr ? device->getActiveOutputChannels().countNumberOfSetBits() : 2);
+    mixer->prepareToPlay(samplesPerBlockExpected, sampleRate);
+    mixRecorder.prepareToPlay(sampleRate);
 }
 
 void MainComponent::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
 {
-    mixerSource.getNextAudioBlock(bufferToFill);
+    mixer->getNextAudioBlock(bufferToFill);
+
+    // The recorder only copies the master into its ring buffer; the disk is written on its own thread
+    mixRecorder.write(bufferToFill);
 }
 
 void MainComponent::releaseResources()
@@ -57,10 +101,7 @@ void MainComponent::releaseResources()
     // restarted due to a setting change.
 
     // For more details, see the help for AudioProcessor::releaseResources()
-    player1.releaseResources();
-    player2.releaseResources();
-
-    mixerSource.releaseResources();
+    mixer->releaseResources();
 }
 
 //==============================================================================
@@ -75,8 +116,17 @@ void MainComponent::paint(Graphics& g)
 
 void MainComponent::resized()
 {
-    deckGUI1.setBounds(0, 0, getWidth()/2, getHeight()* 2/3);
-    deckGUI2.setBounds(getWidth()/2, 0, getWidth()/2, getHeight()* 2/3);
+    // Decks in two columns, then the mixer strip, then the playlist
+    const int mixerHeight = 60;
+    const int deckRows = (deckGUIs.size() + 1) / 2;
+    const int deckHeight = (getHeight() * 2 / 3 - mixerHeight) / deckRows;
+
+    for (int i = 0; i < deckGUIs.size(); ++i)
+    {
+        deckGUIs[i]->setBounds((i % 2) * getWidth() / 2, (i / 2) * deckHeight, getWidth() / 2, deckHeight);
+    }
+
+    mixerComponent->setBounds(0, deckRows * deckHeight, getWidth(), mixerHeight);
     playlistComponent.setBounds(0, getHeight()* 2/3, getWidth(), getHeight()* 1/3);
 
     DBG("MainComponent::resized");
@@ -12,6 +12,9 @@
 #include "DJAudioPlayer.h"
 #include "DeckGUI.h"
 #include "PlaylistComponent.h"
+#include "MixerEngine.h"
+#include "MixerComponent.h"
+#include "MixRecorder.h"
 
 //==============================================================================
 /*
@@ -29,8 +32,10 @@ class MainComponent : public AudioAppComponent
 public:
   /**
    * @brief Constructs a MainComponent object.
+   *
+   * @param numberOfDecks The number of decks, from 2 to 4.
    */
-  MainComponent();
+  MainComponent(int numberOfDecks = 2);
 
   /**
    * @brief Destructs the MainComponent object.
@@ -80,15 +85,20 @@ private:
 
   AudioFormatManager formatManager;        /**< The audio format manager. */
   AudioThumbnailCache thumbnailCache{100}; /**< The audio thumbnail cache. */
-
-  DJAudioPlayer player1{formatManager};                      /**< The audio player for deck 1. */
-  DeckGUI deckGUI1{&player1, formatManager, thumbnailCache}; /**< The GUI component for deck 1. */
-
-  DJAudioPlayer player2{formatManager};                      /**< The audio player for deck 2. */
-  DeckGUI deckGUI2{&player2, formatManager, thumbnailCache}; /**< The GUI component for deck 2. */
-
-  MixerAudioSource mixerSource;        /**< The mixer audio source. */
-  PlaylistComponent playlistComponent; /**< The playlist component. */
+  TimeSliceThread decodeThread{"Deck decoding"}; /**< Background thread shared by the decks for decoding ahead of the playhead. */
+  DecodedTrackCache decodedCache{(size_t)1024 * 1024 * 1024}; /**< Decoded tracks shared by the decks and the playlist, with a 1 GB budget. */
+  TrackLoader trackLoader{formatManager, decodedCache};        /**< Opens tracks for the decks in the background. */
+  WaveformStore waveformStore{formatManager};                  /**< Precomputed waveforms kept on disk across restarts. */
+  TrackAnalyser trackAnalyser{formatManager};                  /**< Finds and stores the tempo and beat grid of every track. */
+  TrackLibrary trackLibrary{formatManager};                    /**< The tracks in the user's music folders, indexed on disk. */
+
+  OwnedArray<DJAudioPlayer> players; /**< The audio player of each deck. */
+  OwnedArray<DeckGUI> deckGUIs;      /**< The GUI component of each deck. */
+
+  std::unique_ptr<MixerEngine> mixer;                 /**< Mixes the decks through the crossfader and limiter. */
+  MixRecorder mixRecorder;                            /**< Records the master output to disk. */
+  std::unique_ptr<MixerComponent> mixerComponent;     /**< The crossfader and meters. */
+  PlaylistComponent playlistComponent{trackLibrary, trackLoader, trackAnalyser}; /**< The playlist component. */
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent) /**< Macro to declare the class as non-copyable with leak detector. */
 };
\ No newline at end of file
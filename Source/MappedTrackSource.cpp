@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    MappedTrackSource.cpp
+    Created: 17 Oct 2026 3:20:07pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "MappedTrackSource.h"
+
+// How often the background thread checks back once the window ahead is touched. Seeks don't wake
+// the thread, since that takes its lock, so this bounds how long they wait to be seen.
+static constexpr int idleCheckMilliseconds = 5;
+
+// Works out how many samples fit in half a memory page, so stepping by that
+// amount touches every page at least once.
+static int getTouchStride(const AudioFormatReader &reader)
+{
+    const auto bytesPerFrame = jmax(1, (int)reader.numChannels * (int)reader.bitsPerSample / 8);
+    return jmax(1, 2048 / bytesPerFrame);
+}
+
+MappedTrackSource::MappedTrackSource(MemoryMappedAudioFormatReader *_reader,
+                                     TimeSliceThread &thread,
+                                     double _readAheadSeconds)
+    : reader(_reader),
+      backgroundThread(thread),
+      touchStride(getTouchStride(*_reader)),
+      readAheadSeconds(_readAheadSeconds)
+{
+    jassert(reader->getMappedSection().getLength() == reader->lengthInSamples);
+}
+
+MappedTrackSource::~MappedTrackSource()
+{
+    // Make sure the background thread is no longer touching the file.
+    releaseResources();
+}
+
+void MappedTrackSource::prepareToPlay(int, double)
+{
+    // Start keeping the pages ahead of the playhead resident.
+    if (!isPrepared)
+    {
+        backgroundThread.addTimeSliceClient(this);
+        isPrepared = true;
+    }
+}
+
+void MappedTrackSource::releaseResources()
+{
+    if (isPrepared)
+    {
+        backgroundThread.removeTimeSliceClient(this);
+        isPrepared = false;
+    }
+}
+
+void MappedTrackSource::getNextAudioBlock(const AudioSourceChannelInfo &info)
+{
+    // The reader converts straight from the mapped memory, there is no stream to read from.
+    const auto pos = position.load();
+    const auto available = (int)jlimit<int64>(0, info.numSamples, reader->lengthInSamples - jmax((int64)0, pos));
+
+    if (available > 0)
+    {
+        reader->read(info.buffer, info.startSample, available, pos, true, true);
+    }
+
+    if (available < info.numSamples)
+    {
+        info.buffer->clear(info.startSample + available, info.numSamples - available);
+    }
+
+    // Advance unless the playhead was moved while reading.
+    auto expected = pos;
+    position.compare_exchange_strong(expected, pos + info.numSamples);
+}
+
+void MappedTrackSource::setNextReadPosition(int64 newPosition)
+{
+    // Short backward jumps such as loops land on pages that were just played.
+    // Anything else starts touching pages from the new position straight away.
+    const auto window = (int64)(readAheadSeconds.load() * reader->sampleRate);
+    const auto isResident = newPosition >= position.load() - window && newPosition < touchedUpTo.load();
+
+    position = newPosition;
+
+    // The background thread sees the reset on its next check; waking it would take its lock.
+    if (!isResident)
+    {
+        touchedUpTo = newPosition;
+    }
+}
+
+int64 MappedTrackSource::getNextReadPosition() const
+{
+    return position.load();
+}
+
+int64 MappedTrackSource::getTotalLength() const
+{
+    return reader->lengthInSamples;
+}
+
+bool MappedTrackSource::isLooping() const
+{
+    return false;
+}
+
+void MappedTrackSource::setReadAheadSeconds(double seconds)
+{
+    readAheadSeconds = seconds;
+}
+
+float MappedTrackSource::getFillLevel() const
+{
+    // How much of the window ahead of the playhead is known to be resident.
+    const auto pos = position.load();
+    const auto window = (int64)(readAheadSeconds.load() * reader->sampleRate);
+    const auto touched = touchedUpTo.load();
+
+    if (touched >= reader->lengthInSamples || window <= 0)
+    {
+        return 1.0f;
+    }
+
+    return jlimit(0.0f, 1.0f, (float)(touched - pos) / (float)window);
+}
+
+int MappedTrackSource::useTimeSlice()
+{
+    // Touch the next chunk of pages ahead of the playhead. Returns how long to wait before the next call.
+    constexpr int64 chunkSize = 1 << 16;
+
+    const auto pos = jmax((int64)0, position.load());
+    const auto end = jmin(reader->lengthInSamples, pos + (int64)(readAheadSeconds.load() * reader->sampleRate));
+    auto from = touchedUpTo.load();
+
+    // Start again from the playhead if it jumped outside what was touched.
+    if (from < pos || from > end)
+    {
+        from = pos;
+    }
+
+    const auto to = jmin(end, from + chunkSize);
+
+    for (auto sample = from; sample < to; sample += touchStride)
+    {
+        reader->touchSample(sample);
+    }
+
+    touchedUpTo = to;
+    return to < end ? 1 : idleCheckMilliseconds;
+}
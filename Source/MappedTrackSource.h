@@ -0,0 +1,79 @@
+/*
+	==============================================================================
+
+	MappedTrackSource.h
+	Created: 17 Oct 2026 3:20:07pm
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+	Plays an uncompressed WAV or AIFF file straight from a memory-mapped reader, so
+	playback doesn't go through buffered stream reads or system calls.
+
+	The OS page cache decides what stays resident. To stop the audio thread from
+	taking page faults, the shared background thread touches the pages just ahead
+	of the playhead so they are already in memory when they are played.
+*/
+class MappedTrackSource : public PositionableAudioSource,
+						  private TimeSliceClient
+{
+public:
+	/**
+		Constructor.
+		@param reader A reader that has already mapped the whole file. This object takes ownership of it.
+		@param thread The background thread that touches the pages ahead of the playhead.
+		@param readAheadSeconds How far ahead of the playhead to keep pages resident.
+	*/
+	MappedTrackSource(MemoryMappedAudioFormatReader *reader,
+					  TimeSliceThread &thread,
+					  double readAheadSeconds);
+
+	/**
+		Destructor.
+	*/
+	~MappedTrackSource() override;
+
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+	void releaseResources() override;
+
+	/**
+		Converts the next block of samples straight out of the mapped file.
+		@param bufferToFill The buffer to be filled with audio data.
+	*/
+	void getNextAudioBlock(const AudioSourceChannelInfo &bufferToFill) override;
+
+	void setNextReadPosition(int64 newPosition) override;
+	int64 getNextReadPosition() const override;
+	int64 getTotalLength() const override;
+	bool isLooping() const override;
+
+	/**
+		Changes how far ahead of the playhead the pages are touched.
+		@param seconds The read-ahead size in seconds.
+	*/
+	void setReadAheadSeconds(double seconds);
+
+	/**
+		Returns how much of the read-ahead window has been touched.
+		@return The fill level, where 0.0 is nothing and 1.0 is the whole window.
+	*/
+	float getFillLevel() const;
+
+private:
+	int useTimeSlice() override;
+
+	std::unique_ptr<MemoryMappedAudioFormatReader> reader; // The mapped file
+	TimeSliceThread &backgroundThread;					   // Thread that touches the pages
+	const int touchStride;								   // Samples between touches, so every page is touched once
+	std::atomic<int64> position{0};						   // Position of the playhead in samples
+	std::atomic<int64> touchedUpTo{0};					   // Pages are resident from the playhead up to here
+	std::atomic<double> readAheadSeconds;				   // How far ahead to touch
+	bool isPrepared = false;							   // Whether this object is registered with the thread
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MappedTrackSource)
+};
@@ -0,0 +1,250 @@
+/*
+  ==============================================================================
+
+    MixRecorder.cpp
+    Created: 21 Oct 2026 4:18:52pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "MixRecorder.h"
+
+// How much audio the ring buffer holds, which is how long the disk can stall before
+// samples are dropped.
+static constexpr double ringBufferSeconds = 5.0;
+
+// How often the WAV header is rewritten, so a crash loses at most this much.
+static constexpr double flushIntervalSeconds = 10.0;
+
+// Recordings are written at 24 bits, which keeps the limiter's output intact.
+static constexpr int recordingBitDepth = 24;
+
+MixRecorder::MixRecorder()
+{
+    // Constructor for MixRecorder class.
+    writerThread.startThread(Thread::Priority::normal);
+}
+
+MixRecorder::~MixRecorder()
+{
+    // Destructor for MixRecorder class.
+    stop();
+    writerThread.stopThread(2000);
+}
+
+void MixRecorder::prepareToPlay(double sampleRate)
+{
+    // A file has one sample rate, so after a change the running recording takes no audio
+    // until the message thread carries it on in a new file.
+    deviceSampleRate = sampleRate;
+}
+
+bool MixRecorder::start(const File &file, String &error)
+{
+    // Open the file and size the ring buffer here, so the audio thread only ever copies.
+    stop();
+
+    const auto sampleRate = deviceSampleRate.load();
+
+    if (sampleRate <= 0.0)
+    {
+        error = "The audio device isn't running";
+        return false;
+    }
+
+    std::unique_ptr<AudioFormat> format;
+
+    if (file.hasFileExtension("flac"))
+    {
+        format.reset(new FlacAudioFormat());
+    }
+    else
+    {
+        format.reset(new WavAudioFormat());
+    }
+
+    file.getParentDirectory().createDirectory();
+    file.deleteFile();
+    std::unique_ptr<FileOutputStream> stream(file.createOutputStream());
+
+    if (stream == nullptr)
+    {
+        error = "Couldn't create " + file.getFullPathName();
+        return false;
+    }
+
+    // The fastest FLAC setting keeps the writer thread light; it is lossless either way.
+    std::unique_ptr<AudioFormatWriter> newWriter(format->createWriterFor(stream.get(), sampleRate, 2, recordingBitDepth, {}, 0));
+
+    if (newWriter == nullptr)
+    {
+        error = "Couldn't create a " + format->getFormatName() + " writer for " + file.getFullPathName();
+        return false;
+    }
+
+    stream.release(); // The writer owns the stream now
+
+    const auto ringSize = roundToInt(sampleRate * ringBufferSeconds);
+    ringBuffer.setSize(2, ringSize);
+    fifo.setTotalSize(ringSize);
+    recordedSamples = 0;
+    droppedSamples = 0;
+    recordingSampleRate = sampleRate;
+    recordingFile = file;
+
+    {
+        const ScopedLock lock(writerLock);
+        writer = std::move(newWriter);
+        samplesSinceFlush = 0;
+    }
+
+    writerThread.addTimeSliceClient(this);
+    recording = true;
+
+    std::cout << "MixRecorder::Recording to " << file.getFullPathName() << std::endl;
+    return true;
+}
+
+void MixRecorder::stop()
+{
+    // Take the ring buffer away from the audio thread and wait until it has finished the block
+    // it may be copying, then write out the rest and close the file.
+    if (!recording.exchange(false))
+    {
+        return;
+    }
+
+    while (audioThreadWriting.load())
+    {
+        Thread::sleep(1);
+    }
+
+    writerThread.removeTimeSliceClient(this);
+
+    const ScopedLock lock(writerLock);
+    drain();
+    writer.reset();
+
+    std::cout << "MixRecorder::Recorded " << getRecordedSeconds() << " seconds, dropped " << droppedSamples.load() << " samples" << std::endl;
+}
+
+bool MixRecorder::isRecording() const
+{
+    return recording.load();
+}
+
+bool MixRecorder::splitIfSampleRateChanged(String &error)
+{
+    // Finish the file at the old rate and go on in a new one, in the same format.
+    if (!recording.load() || deviceSampleRate.load() == recordingSampleRate.load())
+    {
+        return false;
+    }
+
+    const auto extension = recordingFile.getFileExtension();
+    stop();
+
+    std::cout << "MixRecorder::Sample rate changed to " << deviceSampleRate.load() << ", continuing in a new file" << std::endl;
+    return start(getDefaultFile(extension).getNonexistentSibling(), error);
+}
+
+void MixRecorder::write(const AudioSourceChannelInfo &info)
+{
+    // Copy the whole block or none of it, so a dropped block is a clean gap and is counted.
+    // Nothing is copied at a rate the file wasn't started at.
+    audioThreadWriting = true;
+
+    if (recording.load() && deviceSampleRate.load() == recordingSampleRate.load())
+    {
+        if (fifo.getFreeSpace() < info.numSamples)
+        {
+            droppedSamples += info.numSamples;
+        }
+        else
+        {
+            const auto scope = fifo.write(info.numSamples);
+
+            for (int chan = 0; chan < ringBuffer.getNumChannels(); ++chan)
+            {
+                const auto source = jmin(chan, info.buffer->getNumChannels() - 1);
+
+                if (scope.blockSize1 > 0)
+                {
+                    ringBuffer.copyFrom(chan, scope.startIndex1, *info.buffer, source, info.startSample, scope.blockSize1);
+                }
+
+                if (scope.blockSize2 > 0)
+                {
+                    ringBuffer.copyFrom(chan, scope.startIndex2, *info.buffer, source, info.startSample + scope.blockSize1, scope.blockSize2);
+                }
+            }
+
+            recordedSamples += info.numSamples;
+        }
+    }
+
+    audioThreadWriting = false;
+}
+
+double MixRecorder::getRecordedSeconds() const
+{
+    const auto sampleRate = recordingSampleRate.load();
+    return sampleRate > 0.0 ? (double)recordedSamples.load() / sampleRate : 0.0;
+}
+
+int64 MixRecorder::getDroppedSamples() const
+{
+    return droppedSamples.load();
+}
+
+File MixRecorder::getDefaultFile(const String &extension)
+{
+    return File::getSpecialLocation(File::userMusicDirectory)
+        .getChildFile("xDecks Recordings")
+        .getChildFile("Mix " + Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S") + extension);
+}
+
+int MixRecorder::useTimeSlice()
+{
+    // Write out what is ready, and come back before the ring buffer can get near full.
+    const ScopedLock lock(writerLock);
+
+    if (writer == nullptr)
+    {
+        return 100;
+    }
+
+    drain();
+
+    // Rewrite the header now and then, so the file is readable up to here if the app dies.
+    if (samplesSinceFlush >= recordingSampleRate.load() * flushIntervalSeconds)
+    {
+        writer->flush();
+        samplesSinceFlush = 0;
+    }
+
+    return 20;
+}
+
+void MixRecorder::drain()
+{
+    if (writer == nullptr)
+    {
+        return;
+    }
+
+    const auto scope = fifo.read(fifo.getNumReady());
+
+    if (scope.blockSize1 > 0)
+    {
+        writer->writeFromAudioSampleBuffer(ringBuffer, scope.startIndex1, scope.blockSize1);
+    }
+
+    if (scope.blockSize2 > 0)
+    {
+        writer->writeFromAudioSampleBuffer(ringBuffer, scope.startIndex2, scope.blockSize2);
+    }
+
+    samplesSinceFlush += scope.blockSize1 + scope.blockSize2;
+}
@@ -0,0 +1,130 @@
+/*
+	==============================================================================
+
+	MixRecorder.h
+	Created: 21 Oct 2026 4:18:52pm
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+	Records the master output to a WAV or FLAC file.
+
+	The audio thread copies each block into a ring buffer of a few seconds, built on
+	AbstractFifo, and never takes a lock, allocates or touches the disk. A background
+	thread drains the ring buffer into the file. The ring buffer is allocated when a
+	recording starts and doesn't grow, so a recording can run for hours in the same
+	memory. If the disk falls so far behind that a block doesn't fit, the block is
+	dropped and counted, rather than making the audio thread wait.
+
+	WAV files are switched to RF64 by JUCE once they pass 4 GB, and their header is
+	rewritten every few seconds so a recording survives a crash.
+
+	A file can only have one sample rate. If the device's rate changes during a recording,
+	the audio thread stops filling the ring buffer, and the message thread finishes the
+	file and carries on in a new one with splitIfSampleRateChanged().
+*/
+class MixRecorder : private TimeSliceClient
+{
+public:
+	/**
+		Constructor.
+	*/
+	MixRecorder();
+
+	/**
+		Destructor. Finishes any recording that is still running.
+	*/
+	~MixRecorder() override;
+
+	/**
+		Tells the recorder the rate of the master output. A recording keeps the rate it was started at,
+		and takes no more audio after a change until it is split.
+		@param sampleRate The sample rate of the audio device.
+	*/
+	void prepareToPlay(double sampleRate);
+
+	/**
+		Starts recording to a file, finishing any recording that is already running.
+		Only call this from the message thread.
+		@param file The file to write. Files ending in .flac are written as FLAC, others as WAV.
+		@param error Receives a description of the problem if the recording can't start.
+		@return True if the recording started.
+	*/
+	bool start(const File &file, String &error);
+
+	/**
+		Stops recording, writes out what is left in the ring buffer and closes the file.
+		Only call this from the message thread.
+	*/
+	void stop();
+
+	/**
+		Returns whether a recording is running.
+	*/
+	bool isRecording() const;
+
+	/**
+		Finishes the running recording and starts a new file at the device's rate, if the rate
+		has changed since the recording started. Only call this from the message thread.
+		@param error Receives a description of the problem if the new file can't start.
+		@return True if the recording was split, false if there was nothing to do or the new file couldn't start.
+	*/
+	bool splitIfSampleRateChanged(String &error);
+
+	/**
+		Copies a block of the master output into the ring buffer. Only call this from the audio thread.
+		@param bufferToFill The block that was just rendered.
+	*/
+	void write(const AudioSourceChannelInfo &bufferToFill);
+
+	/**
+		Returns how long the running or last recording is, in seconds.
+	*/
+	double getRecordedSeconds() const;
+
+	/**
+		Returns how many samples of the running or last recording were dropped because the
+		ring buffer was full.
+	*/
+	int64 getDroppedSamples() const;
+
+	/**
+		Returns a new file name for a recording in the user's music folder, stamped with the current time.
+		@param extension The file extension, like ".wav" or ".flac".
+	*/
+	static File getDefaultFile(const String &extension);
+
+private:
+	/**
+		Writes out whatever the audio thread has put in the ring buffer. Called on the writer thread.
+		@return How long to wait before the next call, in milliseconds.
+	*/
+	int useTimeSlice() override;
+
+	/**
+		Moves everything that is ready from the ring buffer into the file. Call with writerLock held.
+	*/
+	void drain();
+
+	TimeSliceThread writerThread{"Mix recording"}; // Writes the ring buffer to disk
+	CriticalSection writerLock;					   // Keeps the writer thread and the message thread off the file at the same time
+	std::unique_ptr<AudioFormatWriter> writer;	   // The file being written, nullptr when not recording
+	AudioBuffer<float> ringBuffer;				   // Audio waiting to be written
+	AbstractFifo fifo{1};						   // Read and write positions in ringBuffer
+	int samplesSinceFlush = 0;					   // Samples written since the header was last updated
+	File recordingFile;							   // The running or last recording, only touched on the message thread
+
+	std::atomic<double> deviceSampleRate{0.0};	   // Rate of the master output
+	std::atomic<double> recordingSampleRate{0.0};  // Rate of the running or last recording
+	std::atomic<bool> recording{false};			   // Whether the audio thread should fill the ring buffer
+	std::atomic<bool> audioThreadWriting{false};   // Whether the audio thread is inside write()
+	std::atomic<int64> recordedSamples{0};		   // Samples put in the ring buffer since the recording started
+	std::atomic<int64> droppedSamples{0};		   // Samples that didn't fit in the ring buffer
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MixRecorder)
+};
@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    MixerComponent.cpp
+    Created: 19 Oct 2026 11:48:30am
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "MixerComponent.h"
+
+// Returns the text shown on a side button.
+static String getSideText(MixerEngine::Side side)
+{
+    return side == MixerEngine::Side::a ? "A" : side == MixerEngine::Side::b ? "B" : "THRU";
+}
+
+//==============================================================================
+MixerComponent::MixerComponent(MixerEngine &_mixer, MixRecorder &_recorder) : mixer(_mixer), recorder(_recorder)
+{
+    // Crossfader in the middle, fully on side A at the left
+    crossfaderSlider.setRange(0.0, 1.0);
+    crossfaderSlider.setValue(mixer.getCrossfader(), dontSendNotification);
+    crossfaderSlider.setSliderStyle(Slider::LinearHorizontal);
+    crossfaderSlider.setTextBoxStyle(Slider::NoTextBox, false, 0, 0);
+    crossfaderSlider.setDoubleClickReturnValue(true, 0.5);
+    crossfaderSlider.onValueChange = [this]
+    { mixer.setCrossfader((float)crossfaderSlider.getValue()); };
+    addAndMakeVisible(crossfaderSlider);
+
+    // Crossfader curves, ids follow MixerEngine::Curve plus one
+    curveBox.addItem("SMOOTH", 1);
+    curveBox.addItem("LINEAR", 2);
+    curveBox.addItem("SHARP", 3);
+    curveBox.setSelectedId(1, dontSendNotification);
+    curveBox.onChange = [this]
+    { mixer.setCrossfaderCurve((MixerEngine::Curve)(curveBox.getSelectedId() - 1)); };
+    addAndMakeVisible(curveBox);
+
+    // One side button per deck, cycling A -> THRU -> B
+    for (int i = 0; i < mixer.getNumChannels(); ++i)
+    {
+        auto *button = sideButtons.add(new TextButton(getSideText(mixer.getCrossfaderSide(i))));
+        button->setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+        button->onClick = [this, i, button]
+        {
+            const auto side = (MixerEngine::Side)(((int)mixer.getCrossfaderSide(i) + 1) % 3);
+            mixer.setCrossfaderSide(i, side);
+            button->setButtonText(getSideText(side));
+        };
+        addAndMakeVisible(button);
+
+        channelPeaks.add(0.0f);
+        channelRms.add(0.0f);
+    }
+
+    // Recording to a new file in the music folder, as WAV or FLAC
+    recordButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    recordButton.onClick = [this]
+    { toggleRecording(); };
+    addAndMakeVisible(recordButton);
+
+    recordFormatBox.addItem("WAV", 1);
+    recordFormatBox.addItem("FLAC", 2);
+    recordFormatBox.setSelectedId(1, dontSendNotification);
+    addAndMakeVisible(recordFormatBox);
+
+    // Meters are refreshed at about 30 frames per second
+    startTimerHz(30);
+}
+
+MixerComponent::~MixerComponent()
+{
+    stopTimer();
+}
+
+void MixerComponent::paint(juce::Graphics &g)
+{
+    g.fillAll(juce::Colour::fromRGB(27, 38, 59));
+
+    const auto numMeters = channelPeaks.size() + 1;
+    const auto meterWidth = meterArea.getWidth() / numMeters;
+
+    for (int i = 0; i < channelPeaks.size(); ++i)
+    {
+        drawMeter(g, meterArea.withX(meterArea.getX() + i * meterWidth).withWidth(meterWidth - 4),
+                  channelRms[i], channelPeaks[i], String(i + 1));
+    }
+
+    drawMeter(g, meterArea.withX(meterArea.getX() + channelPeaks.size() * meterWidth).withWidth(meterWidth - 4),
+              masterRms, masterPeak, "M");
+}
+
+void MixerComponent::drawMeter(juce::Graphics &g, Rectangle<int> bounds, float rms, float peak, const String &label)
+{
+    // Horizontal bar: RMS filled, peak as a line, red once the level reaches full scale
+    auto labelBounds = bounds.removeFromLeft(14);
+    g.setColour(juce::Colours::white);
+    g.setFont(juce::FontOptions(11.0f));
+    g.drawText(label, labelBounds, juce::Justification::centred, false);
+
+    g.setColour(juce::Colour::fromRGB(13, 27, 42));
+    g.fillRect(bounds);
+
+    // Show -60 dB to 0 dB across the bar
+    auto toProportion = [](float level)
+    { return jlimit(0.0f, 1.0f, (Decibels::gainToDecibels(level, -60.0f) + 60.0f) / 60.0f); };
+
+    g.setColour(juce::Colour::fromRGB(90, 183, 92));
+    g.fillRect(bounds.withWidth(roundToInt(bounds.getWidth() * toProportion(rms))));
+
+    const auto peakX = bounds.getX() + roundToInt(bounds.getWidth() * toProportion(peak));
+    g.setColour(peak >= 1.0f ? juce::Colour::fromRGB(218, 79, 74) : juce::Colour::fromRGB(250, 166, 50));
+    g.drawVerticalLine(jmin(peakX, bounds.getRight() - 1), (float)bounds.getY(), (float)bounds.getBottom());
+}
+
+void MixerComponent::resized()
+{
+    // Side buttons and meters on the left, the crossfader in the middle, the curve and the recorder on the right
+    auto area = getLocalBounds().reduced(4);
+    auto buttonArea = area.removeFromLeft(area.getWidth() / 4);
+    const auto buttonWidth = buttonArea.getWidth() / jmax(1, sideButtons.size());
+
+    for (auto *button : sideButtons)
+    {
+        button->setBounds(buttonArea.removeFromLeft(buttonWidth).reduced(2));
+    }
+
+    auto rightArea = area.removeFromRight(area.getWidth() / 4);
+    curveBox.setBounds(rightArea.removeFromTop(rightArea.getHeight() / 2).reduced(2));
+    recordFormatBox.setBounds(rightArea.removeFromRight(rightArea.getWidth() / 3).reduced(2));
+    recordButton.setBounds(rightArea.reduced(2));
+    meterArea = area.removeFromTop(area.getHeight() / 2).reduced(2);
+    crossfaderSlider.setBounds(area);
+}
+
+void MixerComponent::timerCallback()
+{
+    // Hold each peak for a moment and let it fall, so short peaks are still visible
+    for (int i = 0; i < channelPeaks.size(); ++i)
+    {
+        const auto reading = mixer.readChannelMeter(i);
+        channelPeaks.set(i, jmax(reading.peak, channelPeaks[i] * 0.85f));
+        channelRms.set(i, reading.rms);
+    }
+
+    const auto master = mixer.readMasterMeter();
+    masterPeak = jmax(master.peak, masterPeak * 0.85f);
+    masterRms = master.rms;
+
+    // A new device sample rate needs a new file; if that can't be started, the recording has stopped
+    String error;
+
+    if (!recorder.splitIfSampleRateChanged(error) && error.isNotEmpty())
+    {
+        showRecordingStopped();
+        AlertWindow::showMessageBoxAsync(MessageBoxIconType::WarningIcon, "Recording stopped", error);
+    }
+
+    // Show how long the recording is, and how much of it the disk couldn't keep up with
+    if (recorder.isRecording())
+    {
+        const auto seconds = (int)recorder.getRecordedSeconds();
+        auto text = "STOP " + String::formatted("%d:%02d:%02d", seconds / 3600, (seconds / 60) % 60, seconds % 60);
+
+        if (recorder.getDroppedSamples() > 0)
+        {
+            text << "  DROPPED " << recorder.getDroppedSamples();
+        }
+
+        recordButton.setButtonText(text);
+    }
+
+    repaint();
+}
+
+void MixerComponent::toggleRecording()
+{
+    // Stop a running recording, or start a new file named after the current time
+    if (recorder.isRecording())
+    {
+        recorder.stop();
+        showRecordingStopped();
+        return;
+    }
+
+    String error;
+
+    if (recorder.start(MixRecorder::getDefaultFile(recordFormatBox.getSelectedId() == 2 ? ".flac" : ".wav"), error))
+    {
+        recordButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(218, 79, 74));
+        recordFormatBox.setEnabled(false);
+    }
+    else
+    {
+        AlertWindow::showMessageBoxAsync(MessageBoxIconType::WarningIcon, "Couldn't start recording", error);
+    }
+}
+
+void MixerComponent::showRecordingStopped()
+{
+    // Put the record button and the format back for the next recording
+    recordButton.setButtonText("REC");
+    recordButton.setColour(TextButton::buttonColourId, juce::Colour::fromRGB(13, 27, 42));
+    recordFormatBox.setEnabled(true);
+}
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    MixerComponent.h
+    Created: 19 Oct 2026 11:48:30am
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MixerEngine.h"
+#include "MixRecorder.h"
+
+//==============================================================================
+/*
+ * MixerComponent class
+ * The mixer strip between the decks and the playlist: the crossfader, its curve,
+ * which side each deck is on, the channel and master meters, and the recorder.
+ */
+class MixerComponent : public juce::Component,
+                       public juce::Timer
+{
+public:
+  /**
+   * @brief Constructs a MixerComponent object.
+   *
+   * @param mixer The mixer engine to control and meter.
+   * @param recorder The recorder of the master output.
+   */
+  MixerComponent(MixerEngine &mixer, MixRecorder &recorder);
+
+  /**
+   * @brief Destructs the MixerComponent object.
+   */
+  ~MixerComponent() override;
+
+  /**
+   * @brief Paints the meters.
+   *
+   * @param g The Graphics object used for painting.
+   */
+  void paint(juce::Graphics &g) override;
+
+  /**
+   * @brief Lays out the crossfader and the side buttons.
+   */
+  void resized() override;
+
+  /**
+   * @brief Reads the meters from the mixer and the recorder's progress, and repaints them.
+   */
+  void timerCallback() override;
+
+private:
+  /**
+   * @brief Draws one meter bar with its RMS level and peak.
+   */
+  void drawMeter(juce::Graphics &g, Rectangle<int> bounds, float rms, float peak, const String &label);
+
+  /**
+   * @brief Starts or stops recording the master output.
+   */
+  void toggleRecording();
+
+  /**
+   * @brief Puts the record button back to REC once a recording has stopped.
+   */
+  void showRecordingStopped();
+
+  MixerEngine &mixer;     /**< The mixer being controlled. */
+  MixRecorder &recorder;  /**< Records the master output. */
+
+  Slider crossfaderSlider;  /**< The crossfader. */
+  ComboBox curveBox;        /**< The crossfader curve. */
+  OwnedArray<TextButton> sideButtons; /**< Cycles each deck between A, THRU and B. */
+  TextButton recordButton{"REC"};     /**< Starts and stops recording, and shows its length and dropped samples. */
+  ComboBox recordFormatBox;           /**< Whether recordings are WAV or FLAC. */
+
+  Array<float> channelPeaks; /**< Displayed peak of each channel, decaying between readings. */
+  Array<float> channelRms;   /**< Displayed RMS of each channel. */
+  float masterPeak = 0.0f;   /**< Displayed master peak. */
+  float masterRms = 0.0f;    /**< Displayed master RMS. */
+
+  Rectangle<int> meterArea; /**< Where the meters are drawn. */
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MixerComponent)
+};
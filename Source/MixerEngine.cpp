@@ -0,0 +1,257 @@
+/*
+  ==============================================================================
+
+    MixerEngine.cpp
+    Created: 19 Oct 2026 10:26:14am
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "MixerEngine.h"
+
+// Time constant of the RMS meters.
+static constexpr double rmsSeconds = 0.3;
+
+// How long crossfader moves take to reach their new gain.
+static constexpr double crossfaderRampSeconds = 0.01;
+
+// The limiter keeps the master just below full scale.
+static constexpr float limiterThresholdDb = -0.3f;
+static constexpr float limiterReleaseMs = 50.0f;
+
+// Adds up the squares of the samples with SIMD registers, with scalar loops
+// for the unaligned start and the leftover end.
+static float getSumOfSquares(const float *data, int numSamples)
+{
+    using Register = dsp::SIMDRegister<float>;
+
+    const auto *aligned = Register::getNextSIMDAlignedPtr(const_cast<float *>(data));
+    const auto head = jmin(numSamples, (int)(aligned - data));
+    float sum = 0.0f;
+    int i = 0;
+
+    for (; i < head; ++i)
+    {
+        sum += data[i] * data[i];
+    }
+
+    auto accumulator = Register::expand(0.0f);
+
+    for (; i + (int)Register::SIMDNumElements <= numSamples; i += (int)Register::SIMDNumElements)
+    {
+        const auto values = Register::fromRawArray(data + i);
+        accumulator += values * values;
+    }
+
+    sum += accumulator.sum();
+
+    for (; i < numSamples; ++i)
+    {
+        sum += data[i] * data[i];
+    }
+
+    return sum;
+}
+
+MixerEngine::MixerEngine(const Array<AudioSource *> &channels) : inputs(channels)
+{
+    jassert(inputs.size() >= 2 && inputs.size() <= maxChannels);
+
+    // Odd decks start on side A and even decks on side B, like a two-deck mixer.
+    for (int i = 0; i < maxChannels; ++i)
+    {
+        sides[(size_t)i] = i % 2 == 0 ? Side::a : Side::b;
+    }
+}
+
+void MixerEngine::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    // Prepare the decks, the channel buffer and the limiter.
+    currentSampleRate = sampleRate;
+    channelBuffer.setSize(numOutputChannels, samplesPerBlockExpected);
+
+    for (int i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i]->prepareToPlay(samplesPerBlockExpected, sampleRate);
+        channelGains[(size_t)i].reset(sampleRate, crossfaderRampSeconds);
+        channelGains[(size_t)i].setCurrentAndTargetValue(getChannelGain(i));
+    }
+
+    limiter.setThreshold(limiterThresholdDb);
+    limiter.setRelease(limiterReleaseMs);
+    limiter.prepare({sampleRate, (uint32)samplesPerBlockExpected, (uint32)numOutputChannels});
+}
+
+void MixerEngine::releaseResources()
+{
+    for (auto *input : inputs)
+    {
+        input->releaseResources();
+    }
+
+    channelBuffer.setSize(numOutputChannels, 0);
+    limiter.reset();
+}
+
+void MixerEngine::getNextAudioBlock(const AudioSourceChannelInfo &info)
+{
+    info.clearActiveBufferRegion();
+
+    if (channelBuffer.getNumSamples() == 0)
+    {
+        return;
+    }
+
+    // Blocks larger than expected are mixed in pieces, so the channel buffer never has to grow.
+    for (int offset = 0; offset < info.numSamples; offset += channelBuffer.getNumSamples())
+    {
+        const auto num = jmin(channelBuffer.getNumSamples(), info.numSamples - offset);
+
+        for (int i = 0; i < inputs.size(); ++i)
+        {
+            auto &gain = channelGains[(size_t)i];
+            gain.setTargetValue(getChannelGain(i));
+
+            inputs[i]->getNextAudioBlock(AudioSourceChannelInfo(&channelBuffer, 0, num));
+            measure(channelBuffer, 0, num, channelMeters[(size_t)i]);
+
+            const auto startGain = gain.getCurrentValue();
+            const auto endGain = gain.skip(num);
+
+            for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+            {
+                info.buffer->addFromWithRamp(chan, info.startSample + offset,
+                                             channelBuffer.getReadPointer(jmin(chan, channelBuffer.getNumChannels() - 1)),
+                                             num, startGain, endGain);
+            }
+        }
+    }
+
+    // Limit the master so overlapping loud tracks don't clip.
+    dsp::AudioBlock<float> block(*info.buffer, (size_t)info.startSample);
+    auto masterBlock = block.getSubBlock(0, (size_t)info.numSamples);
+    limiter.process(dsp::ProcessContextReplacing<float>(masterBlock));
+
+    measure(*info.buffer, info.startSample, info.numSamples, masterMeter);
+}
+
+void MixerEngine::setNumOutputChannels(int numChannels)
+{
+    numOutputChannels = jlimit(1, 2, numChannels);
+}
+
+int MixerEngine::getNumChannels() const
+{
+    return inputs.size();
+}
+
+void MixerEngine::setCrossfader(float position)
+{
+    // Set the crossfader position.
+    if (position < 0 || position > 1)
+    {
+        std::cout << "MixerEngine::Invalid crossfader value: " << position << "Crossfader should be between 0 and 1" << std::endl;
+    }
+    else
+    {
+        crossfader = position;
+    }
+}
+
+float MixerEngine::getCrossfader() const
+{
+    return crossfader.load();
+}
+
+void MixerEngine::setCrossfaderCurve(Curve newCurve)
+{
+    curve = newCurve;
+}
+
+void MixerEngine::setCrossfaderSide(int channel, Side side)
+{
+    // Assign a channel to a side of the crossfader.
+    if (!isPositiveAndBelow(channel, inputs.size()))
+    {
+        std::cout << "MixerEngine::Invalid channel: " << channel << "Channel should be between 0 and " << inputs.size() - 1 << std::endl;
+    }
+    else
+    {
+        sides[(size_t)channel] = side;
+    }
+}
+
+MixerEngine::Side MixerEngine::getCrossfaderSide(int channel) const
+{
+    return sides[(size_t)channel].load();
+}
+
+MixerEngine::MeterReading MixerEngine::readChannelMeter(int channel)
+{
+    auto &meter = channelMeters[(size_t)channel];
+    return {meter.peak.exchange(0.0f), meter.rms.load()};
+}
+
+MixerEngine::MeterReading MixerEngine::readMasterMeter()
+{
+    return {masterMeter.peak.exchange(0.0f), masterMeter.rms.load()};
+}
+
+void MixerEngine::measure(const AudioBuffer<float> &buffer, int startSample, int numSamples, Meter &meter)
+{
+    // Update a meter from a block: the peak is held until the GUI reads it,
+    // and the RMS is smoothed with a one-pole filter on the mean square.
+    if (numSamples <= 0)
+    {
+        return;
+    }
+
+    float peak = 0.0f;
+    float sumOfSquares = 0.0f;
+
+    for (int chan = 0; chan < buffer.getNumChannels(); ++chan)
+    {
+        const auto *data = buffer.getReadPointer(chan, startSample);
+        const auto range = FloatVectorOperations::findMinAndMax(data, numSamples);
+        peak = jmax(peak, -range.getStart(), range.getEnd());
+        sumOfSquares += getSumOfSquares(data, numSamples);
+    }
+
+    const auto meanSquare = sumOfSquares / (float)(numSamples * jmax(1, buffer.getNumChannels()));
+    const auto coefficient = 1.0f - (float)std::exp(-numSamples / (rmsSeconds * currentSampleRate));
+    meter.meanSquare += coefficient * (meanSquare - meter.meanSquare);
+
+    meter.rms = std::sqrt(meter.meanSquare);
+
+    if (peak > meter.peak.load())
+    {
+        meter.peak = peak;
+    }
+}
+
+float MixerEngine::getChannelGain(int channel) const
+{
+    // Work out the crossfader gain of a channel from its side, the position and the curve.
+    const auto side = sides[(size_t)channel].load();
+
+    if (side == Side::thru)
+    {
+        return 1.0f;
+    }
+
+    // Distance from the channel's own end of the crossfader, 0 at its end and 1 at the far end.
+    const auto position = crossfader.load();
+    const auto distance = side == Side::a ? position : 1.0f - position;
+
+    switch (curve.load())
+    {
+    case Curve::linear:
+        return 1.0f - distance;
+    case Curve::sharp:
+        return jlimit(0.0f, 1.0f, (1.0f - distance) * 16.0f);
+    case Curve::smooth:
+    default:
+        return std::cos(distance * MathConstants<float>::halfPi);
+    }
+}
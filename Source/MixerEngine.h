@@ -0,0 +1,156 @@
+/*
+	==============================================================================
+
+	MixerEngine.h
+	Created: 19 Oct 2026 10:26:14am
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+	Mixes two to four decks through a crossfader into the master output.
+
+	Each deck is assigned to side A, side B or straight through (thru). The crossfader
+	gains are ramped across each block, and a limiter on the master stops two loud
+	tracks from clipping when they overlap. Peak and RMS levels of every channel and
+	of the master are measured on the audio thread and published through atomics,
+	so the GUI can read them without locking.
+*/
+class MixerEngine : public AudioSource
+{
+public:
+	/** The largest number of decks the mixer supports. */
+	static constexpr int maxChannels = 4;
+
+	/** The shape of the crossfader. */
+	enum class Curve
+	{
+		smooth, // Constant power, no dip in the middle
+		linear, // Linear, about 6 dB down in the middle
+		sharp	// Scratch cut, both sides full until the very ends
+	};
+
+	/** Which side of the crossfader a channel is on. */
+	enum class Side
+	{
+		a,
+		thru,
+		b
+	};
+
+	/** A meter reading. Levels are linear gains, 1.0 is full scale. */
+	struct MeterReading
+	{
+		float peak = 0.0f; // Highest absolute sample since the last reading
+		float rms = 0.0f;  // RMS level, averaged over about 300 ms
+	};
+
+	/**
+		Constructor.
+		@param channels The decks to mix, between 2 and 4. They must outlive this object.
+	*/
+	MixerEngine(const Array<AudioSource *> &channels);
+
+	/**
+		Prepares the decks, the channel buffer and the limiter.
+		@param samplesPerBlockExpected The number of samples per block expected.
+		@param sampleRate The sample rate of the audio.
+	*/
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+
+	/**
+		Releases the decks' resources.
+	*/
+	void releaseResources() override;
+
+	/**
+		Renders every deck, applies the crossfader, sums into the master and limits it.
+		@param bufferToFill The buffer to be filled with the master output.
+	*/
+	void getNextAudioBlock(const AudioSourceChannelInfo &bufferToFill) override;
+
+	/**
+		Sets how many output channels the device has. Call before prepareToPlay(). The decks and
+		the master are rendered in mono for a mono device and in stereo otherwise.
+		@param numChannels The number of active output channels.
+	*/
+	void setNumOutputChannels(int numChannels);
+
+	/**
+		Returns the number of channels being mixed.
+	*/
+	int getNumChannels() const;
+
+	/**
+		Sets the crossfader position.
+		@param position From 0.0, fully on side A, to 1.0, fully on side B.
+	*/
+	void setCrossfader(float position);
+
+	/**
+		Returns the crossfader position.
+	*/
+	float getCrossfader() const;
+
+	/**
+		Sets the shape of the crossfader.
+		@param newCurve The new curve.
+	*/
+	void setCrossfaderCurve(Curve newCurve);
+
+	/**
+		Assigns a channel to a side of the crossfader.
+		@param channel The channel index.
+		@param side The side to put it on.
+	*/
+	void setCrossfaderSide(int channel, Side side);
+
+	/**
+		Returns the side of the crossfader a channel is on.
+		@param channel The channel index.
+	*/
+	Side getCrossfaderSide(int channel) const;
+
+	/**
+		Reads a channel's meter, measured after the deck and before the crossfader.
+		Reading resets the peak, so each reading shows the peak since the one before.
+		@param channel The channel index.
+	*/
+	MeterReading readChannelMeter(int channel);
+
+	/**
+		Reads the master meter, measured after the limiter.
+		Reading resets the peak, so each reading shows the peak since the one before.
+	*/
+	MeterReading readMasterMeter();
+
+private:
+	// A level meter, written by the audio thread and read by the GUI
+	struct Meter
+	{
+		std::atomic<float> peak{0.0f}; // Highest peak since the last reading
+		std::atomic<float> rms{0.0f};  // Published RMS level
+		float meanSquare = 0.0f;	   // Running mean square, only used by the audio thread
+	};
+
+	void measure(const AudioBuffer<float> &buffer, int startSample, int numSamples, Meter &meter);
+	float getChannelGain(int channel) const;
+
+	Array<AudioSource *> inputs;								// The decks being mixed
+	AudioBuffer<float> channelBuffer;							// Each deck is rendered into this in turn
+	int numOutputChannels = 2;									// Channels the decks and the master are rendered in, 1 or 2
+	double currentSampleRate = 44100.0;							// Sample rate used for the meter ballistics
+	std::atomic<float> crossfader{0.5f};						// Crossfader position
+	std::atomic<Curve> curve{Curve::smooth};					// Crossfader shape
+	std::array<std::atomic<Side>, maxChannels> sides;			// Crossfader side of each channel
+	std::array<SmoothedValue<float>, maxChannels> channelGains; // Ramped crossfader gain of each channel
+	std::array<Meter, maxChannels> channelMeters;				// Meter of each channel
+	Meter masterMeter;											// Meter of the master output
+	dsp::Limiter<float> limiter;								// Keeps the master below full scale
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MixerEngine)
+};
@@ -0,0 +1,315 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 19 Oct 2026 2:37:55pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+OfflineRenderer::OfflineRenderer()
+{
+    // Constructor for OfflineRenderer class.
+    formatManager.registerBasicFormats();
+}
+
+int OfflineRenderer::runFromCommandLine(const StringArray &args)
+{
+    // Read "--render <timeline>" and the optional "--output <file>".
+    const auto renderIndex = args.indexOf("--render");
+    const auto outputIndex = args.indexOf("--output");
+
+    if (renderIndex < 0 || args[renderIndex + 1].isEmpty())
+    {
+        std::cout << "Usage: xDecks --render <timeline.json> [--output <mix.wav>]" << std::endl;
+        return 1;
+    }
+
+    const auto timelineFile = File::getCurrentWorkingDirectory().getChildFile(args[renderIndex + 1].unquoted());
+    const auto outputFile = outputIndex >= 0 ? File::getCurrentWorkingDirectory().getChildFile(args[outputIndex + 1].unquoted()) : File();
+    String error;
+
+    if (!render(timelineFile, outputFile, error))
+    {
+        std::cout << "OfflineRenderer::Render failed: " << error << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+bool OfflineRenderer::render(const File &timelineFile, File outputFile, String &error)
+{
+    // Read the timeline.
+    const auto timeline = JSON::parse(timelineFile);
+
+    if (!timeline.isObject())
+    {
+        error = "Couldn't read the timeline " + timelineFile.getFullPathName();
+        return false;
+    }
+
+    baseFolder = timelineFile.getParentDirectory();
+    decodedTracks.clear();
+
+    const auto sampleRate = (double)timeline.getProperty("sampleRate", 44100.0);
+    const auto blockSize = (int)timeline.getProperty("blockSize", 512);
+    const auto numberOfDecks = (int)timeline.getProperty("decks", 2);
+    const auto lengthInSeconds = (double)timeline.getProperty("length", 0.0);
+
+    if (sampleRate <= 0.0 || blockSize <= 0 || lengthInSeconds <= 0.0 || numberOfDecks < 2 || numberOfDecks > MixerEngine::maxChannels)
+    {
+        error = "The timeline needs a positive sampleRate, blockSize and length, and 2 to 4 decks";
+        return false;
+    }
+
+    if (outputFile == File())
+    {
+        outputFile = baseFolder.getChildFile(timeline.getProperty("output", "mix.wav").toString());
+    }
+
+    // Events are sorted by time; events at the same time keep their order in the file.
+    std::vector<Event> events;
+
+    if (auto *list = timeline.getProperty("events", var()).getArray())
+    {
+        for (const auto &item : *list)
+        {
+            Event event;
+            event.sample = (int64)std::llround((double)item.getProperty("time", 0.0) * sampleRate);
+            event.deck = (int)item.getProperty("deck", 0);
+            event.action = item.getProperty("action", "").toString();
+            event.value = item.getProperty("value", var());
+            event.band = item.getProperty("band", var());
+            event.file = item.getProperty("file", "").toString();
+            events.push_back(event);
+        }
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b)
+                     { return a.sample < b.sample; });
+
+    // Build the same graph as the app: a DJAudioPlayer per deck into the MixerEngine.
+    OwnedArray<DJAudioPlayer> players;
+    Array<AudioSource *> mixerInputs;
+
+    for (int i = 0; i < numberOfDecks; ++i)
+    {
+        mixerInputs.add(players.add(new DJAudioPlayer(formatManager, nullptr)));
+    }
+
+    MixerEngine mixer(mixerInputs);
+    mixer.prepareToPlay(blockSize, sampleRate);
+
+    outputFile.deleteFile();
+    std::unique_ptr<FileOutputStream> stream(outputFile.createOutputStream());
+
+    if (stream == nullptr)
+    {
+        error = "Couldn't create " + outputFile.getFullPathName();
+        return false;
+    }
+
+    WavAudioFormat wavFormat;
+    std::unique_ptr<AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), sampleRate, 2, 24, {}, 0));
+
+    if (writer == nullptr)
+    {
+        error = "Couldn't create a WAV writer for " + outputFile.getFullPathName();
+        return false;
+    }
+
+    stream.release(); // The writer owns the stream now
+
+    // Render block by block, splitting blocks so every event lands on its exact sample.
+    AudioBuffer<float> buffer(2, blockSize);
+    const auto totalSamples = (int64)std::llround(lengthInSeconds * sampleRate);
+    const auto startTime = Time::getMillisecondCounterHiRes();
+    size_t nextEvent = 0;
+    int64 position = 0;
+
+    while (position < totalSamples)
+    {
+        while (nextEvent < events.size() && events[nextEvent].sample <= position)
+        {
+            if (!applyEvent(events[nextEvent++], players, mixer, error))
+            {
+                mixer.releaseResources();
+                return false;
+            }
+        }
+
+        auto numSamples = (int)jmin((int64)blockSize, totalSamples - position);
+
+        if (nextEvent < events.size())
+        {
+            numSamples = (int)jmin((int64)numSamples, events[nextEvent].sample - position);
+        }
+
+        mixer.getNextAudioBlock(AudioSourceChannelInfo(&buffer, 0, numSamples));
+        writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+        position += numSamples;
+    }
+
+    // Report the throughput, which is what benchmarking the DSP chain is about.
+    const auto elapsedSeconds = jmax(0.001, (Time::getMillisecondCounterHiRes() - startTime) / 1000.0);
+    std::cout << "Rendered " << String(lengthInSeconds, 2) << " s to " << outputFile.getFullPathName()
+              << " in " << String(elapsedSeconds, 3) << " s ("
+              << String(lengthInSeconds / elapsedSeconds, 1) << "x realtime)" << std::endl;
+
+    mixer.releaseResources();
+    return true;
+}
+
+bool OfflineRenderer::applyEvent(const Event &event, OwnedArray<DJAudioPlayer> &players, MixerEngine &mixer, String &error)
+{
+    // Mixer events don't belong to a deck.
+    if (event.action == "crossfader")
+    {
+        mixer.setCrossfader((float)event.value);
+        return true;
+    }
+
+    if (!isPositiveAndBelow(event.deck, players.size()))
+    {
+        error = "Event '" + event.action + "' is for deck " + String(event.deck) + ", which doesn't exist";
+        return false;
+    }
+
+    auto *player = players[event.deck];
+
+    if (event.action == "load")
+    {
+        const auto file = baseFolder.getChildFile(event.file);
+        auto decoded = decodeFile(file, error);
+
+        if (decoded == nullptr)
+        {
+            return false;
+        }
+
+        LoadedTrack track;
+        track.audioURL = URL(file);
+        track.decoded = decoded;
+        player->loadTrack(track);
+    }
+    else if (event.action == "play")
+    {
+        player->start();
+    }
+    else if (event.action == "stop")
+    {
+        player->stop();
+    }
+    else if (event.action == "seek")
+    {
+        player->setPosition((float)event.value);
+    }
+    else if (event.action == "gain")
+    {
+        player->setGain((float)event.value);
+    }
+    else if (event.action == "trim")
+    {
+        player->setTrim((float)event.value);
+    }
+    else if (event.action == "speed")
+    {
+        player->setSpeed((float)event.value);
+    }
+    else if (event.action == "highPass")
+    {
+        player->setHighPass((double)event.value);
+    }
+    else if (event.action == "lowPass")
+    {
+        player->setLowPass((double)event.value);
+    }
+    else if (event.action == "eq")
+    {
+        player->setEqGain((int)event.band, (float)event.value);
+    }
+    else if (event.action == "kill")
+    {
+        player->setEqKill((int)event.band, (bool)event.value);
+    }
+    else if (event.action == "loopIn")
+    {
+        player->setLoopInAtPlayhead();
+    }
+    else if (event.action == "loopOut")
+    {
+        player->setLoopOutAtPlayhead();
+    }
+    else if (event.action == "loop")
+    {
+        player->setLoopEnabled((bool)event.value);
+    }
+    else if (event.action == "halveLoop")
+    {
+        player->halveLoop();
+    }
+    else if (event.action == "doubleLoop")
+    {
+        player->doubleLoop();
+    }
+    else if (event.action == "roll")
+    {
+        if ((double)event.value > 0.0)
+        {
+            player->startLoopRoll((double)event.value);
+        }
+        else
+        {
+            player->stopLoopRoll();
+        }
+    }
+    else if (event.action == "keyLock")
+    {
+        player->setKeyLock((bool)event.value);
+    }
+    else
+    {
+        error = "Unknown action '" + event.action + "'";
+        return false;
+    }
+
+    return true;
+}
+
+std::shared_ptr<const DecodedTrack> OfflineRenderer::decodeFile(const File &file, String &error)
+{
+    // Decode the whole file up front, and only once per render.
+    const auto key = file.getFullPathName();
+    const auto found = decodedTracks.find(key);
+
+    if (found != decodedTracks.end())
+    {
+        return found->second;
+    }
+
+    std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr)
+    {
+        error = "Couldn't open " + key;
+        return nullptr;
+    }
+
+    if (reader->lengthInSamples <= 0 || reader->lengthInSamples > std::numeric_limits<int>::max())
+    {
+        error = "Can't decode " + key + " into memory";
+        return nullptr;
+    }
+
+    auto decoded = std::make_shared<DecodedTrack>();
+    decoded->sampleRate = reader->sampleRate;
+    decoded->samples.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
+    reader->read(&decoded->samples, 0, (int)reader->lengthInSamples, 0, true, true);
+
+    decodedTracks[key] = decoded;
+    return decoded;
+}
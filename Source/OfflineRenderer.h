@@ -0,0 +1,91 @@
+/*
+	==============================================================================
+
+	OfflineRenderer.h
+	Created: 19 Oct 2026 2:37:55pm
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "DJAudioPlayer.h"
+#include "MixerEngine.h"
+
+/**
+	Runs the decks and the mixer without an audio device, as fast as the CPU allows,
+	from a scripted timeline, and writes the mix to a WAV file.
+
+	This is what "xDecks --render timeline.json [--output mix.wav]" runs. It is meant
+	for regression tests on machines without a sound card and for measuring how
+	many times faster than real time the DSP chain runs.
+
+	The timeline is a JSON file like this:
+
+		{
+			"sampleRate": 48000, "blockSize": 128, "decks": 2, "length": 30.0,
+			"output": "mix.wav",
+			"events": [
+				{ "time": 0.0, "deck": 0, "action": "load", "file": "a.wav" },
+				{ "time": 0.0, "deck": 0, "action": "play" },
+				{ "time": 4.0, "deck": 0, "action": "loopIn" },
+				{ "time": 6.0, "deck": 0, "action": "loopOut" },
+				{ "time": 6.0, "deck": 0, "action": "loop", "value": true },
+				{ "time": 12.0, "action": "crossfader", "value": 1.0 }
+			]
+		}
+
+	Deck actions are load, play, stop, seek (seconds), gain, trim, speed, highPass,
+	lowPass, eq and kill (both with "band"), loopIn, loopOut, loop, halveLoop,
+	doubleLoop, roll (seconds, 0 to end the roll) and keyLock. The mixer action is
+	crossfader. Events are applied at their exact sample, and relative file paths are
+	resolved against the timeline's folder. Tracks are decoded into memory before they
+	play, so a render never depends on disk or thread timing, and the decks run
+	without a decode thread.
+*/
+class OfflineRenderer
+{
+public:
+	/**
+		Constructor.
+	*/
+	OfflineRenderer();
+
+	/**
+		Renders the timeline named on the command line.
+		@param args The command line arguments, containing "--render <timeline>" and optionally "--output <file>".
+		@return The process exit code: 0 on success.
+	*/
+	int runFromCommandLine(const StringArray &args);
+
+	/**
+		Renders a timeline to a WAV file.
+		@param timelineFile The JSON timeline.
+		@param outputFile Where to write the mix. If this is File(), the timeline's "output" is used.
+		@param error Receives a description of the problem if the render fails.
+		@return True if the mix was written.
+	*/
+	bool render(const File &timelineFile, File outputFile, String &error);
+
+private:
+	// One timeline event.
+	struct Event
+	{
+		int64 sample = 0; // When the event happens, in output samples
+		int deck = 0;	  // Which deck it applies to
+		String action;	  // What to do
+		var value;		  // The event's value, if it has one
+		var band;		  // The EQ band, for eq events
+		String file;	  // The file, for load events
+	};
+
+	bool applyEvent(const Event &event, OwnedArray<DJAudioPlayer> &players, MixerEngine &mixer, String &error);
+	std::shared_ptr<const DecodedTrack> decodeFile(const File &file, String &error);
+
+	AudioFormatManager formatManager;									 // Opens the tracks in the timeline
+	std::map<String, std::shared_ptr<const DecodedTrack>> decodedTracks; // Tracks already decoded for this render
+	File baseFolder;													 // Folder that relative paths are resolved against
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineRenderer)
+};
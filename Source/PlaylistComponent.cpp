@@ -10,22 +10,75 @@
 
 #include <JuceHeader.h>
 #include "PlaylistComponent.h"
-#include <Windows.h>
-#include <filesystem>
 
 //==============================================================================
-PlaylistComponent::PlaylistComponent()
+PlaylistComponent::PlaylistComponent(TrackLibrary &library, TrackLoader &loader, TrackAnalyser &analyser) : trackLibrary(library), trackLoader(loader), trackAnalyser(analyser)
 {
     // In your constructor, you should add any child components, and
     // initialise any special settings that your component needs.
 
-    // Iterate through the music folder and populate the track list
-    iterateMusicFolder("C:/Users/pawel/Music");
+    // Show the library as it was indexed; tracks that changed since come in when it is rescanned
+    refreshTracks();
+    analyseTracks();
+
+    // Stored tempos and keys are read in the background, so fill them in once they are there
+    trackAnalyser.onLoaded = [this]
+    {
+        refreshTracks();
+    };
+
+    trackLibrary.onChanged = [this](const TrackLibrary::Changes &)
+    {
+        refreshTracks();
+        analyseTracks();
+    };
+
+    // Fill in the tags of rows as the import reads them
+    trackLibrary.onTagsRead = [this](const std::vector<LibraryTrack> &tracks)
+    {
+        const auto numRows = trackTable.getNumRows();
+
+        for (const auto &track : tracks)
+        {
+            const auto position = trackTable.setTags(track);
+
+            if (position >= 0)
+            {
+                tableComponent.repaintRow(position);
+            }
+        }
+
+        // Rows that started or stopped matching the search move the rest of the view
+        if (trackTable.getNumRows() != numRows)
+        {
+            tableComponent.updateContent();
+            tableComponent.repaint();
+        }
+    };
+
+    // Let the user add folders to the library
+    addFolderButton.addListener(this);
+    addAndMakeVisible(addFolderButton);
+
+    // Narrow the table down on every keystroke
+    searchBox.setTextToShowWhenEmpty("Search title, artist, album or file, or bpm:120-128 key:8A", Colour::fromRGB(119, 141, 169));
+    searchBox.onTextChange = [this]
+    {
+        trackTable.setSearch(searchBox.getText());
+        tableComponent.updateContent();
+        tableComponent.repaint();
+    };
+    addAndMakeVisible(searchBox);
 
     // Add columns to the table header
-    tableComponent.getHeader().addColumn("Title", 1, 300);
-    tableComponent.getHeader().addColumn("Size", 2, 100);
-    // tableComponent.getHeader().addColumn("Artist", 3, 200);
+    tableComponent.getHeader().addColumn("Title", 1, 250);
+    tableComponent.getHeader().addColumn("Artist", 5, 150);
+    tableComponent.getHeader().addColumn("Album", 6, 150);
+    tableComponent.getHeader().addColumn("Length", 7, 60);
+    tableComponent.getHeader().addColumn("BPM", 9, 60);
+    tableComponent.getHeader().addColumn("Key", 3, 60);
+    tableComponent.getHeader().addColumn("kbps", 8, 60);
+    tableComponent.getHeader().addColumn("Size", 2, 60);
     // tableComponent.getHeader().addColumn("Play", 4, 50);
 
     // Set the table model to this component
@@ -37,6 +90,9 @@ PlaylistComponent::PlaylistComponent()
 
 PlaylistComponent::~PlaylistComponent()
 {
+    trackLibrary.onChanged = nullptr;
+    trackLibrary.onTagsRead = nullptr;
+    trackAnalyser.onLoaded = nullptr;
 }
 
 void PlaylistComponent::paint(Graphics &g)
@@ -64,14 +120,16 @@ void PlaylistComponent::paint(Graphics &g)
 
 void PlaylistComponent::resized()
 {
-    // Set the bounds of the table component to fill the entire area
-    tableComponent.setBounds(0, 0, getWidth(), getHeight());
+    // Put the search box and folder button above the table, and let the table fill the rest
+    searchBox.setBounds(0, 0, getWidth() - 120, 24);
+    addFolderButton.setBounds(getWidth() - 120, 0, 120, 24);
+    tableComponent.setBounds(0, 24, getWidth(), getHeight() - 24);
 }
 
 int PlaylistComponent::getNumRows()
 {
-    // Return the number of rows in the table, which is the size of the track list
-    return trackTitles.size();
+    // Return the number of rows in the table, which is the number of tracks in the view
+    return trackTable.getNumRows();
 }
 
 void PlaylistComponent::paintRowBackground(Graphics &g, int rowNumber, int width, int height, bool rowIsSelected)
@@ -93,24 +151,12 @@ void PlaylistComponent::paintCell(Graphics &g, int rowNumber, int columnId, int
     g.setColour(juce::Colours::black);
     g.setFont(14.0f);
 
-    // Check if the row number is within the bounds of the track list
-    if (rowNumber < trackTitles.size())
+    // Only the rows in view are painted, so only their text is ever formatted
+    const auto column = getColumn(columnId);
+
+    if (column != TrackTable::numColumns)
     {
-        // Draw the appropriate text based on the column ID
-        switch (columnId)
-        {
-        case 1:
-            g.drawText(trackTitles[rowNumber][0], 2, 0, width - 4, height, juce::Justification::centredLeft, true);
-            break;
-        case 2:
-            g.drawText(trackTitles[rowNumber][1], 2, 0, width - 4, height, juce::Justification::centredLeft, true);
-            break;
-        case 3:
-            g.drawText(trackTitles[rowNumber][2], 2, 0, width - 4, height, juce::Justification::centredLeft, true);
-            break;
-        default:
-            break;
-        }
+        g.drawText(trackTable.getText(rowNumber, column), 2, 0, width - 4, height, juce::Justification::centredLeft, true);
     }
 }
 
@@ -136,42 +182,111 @@ Component *PlaylistComponent::refreshComponentForCell(int rowNumber,
     return existingComponentToUpdate;
 }
 
+void PlaylistComponent::sortOrderChanged(int newSortColumnId, bool isForwards)
+{
+    // The table keeps each column's order, so this is usually just reading it forwards or backwards
+    const auto column = getColumn(newSortColumnId);
+
+    if (column != TrackTable::numColumns)
+    {
+        trackTable.sort(column, isForwards);
+        tableComponent.updateContent();
+        tableComponent.repaint();
+    }
+}
+
+void PlaylistComponent::selectedRowsChanged(int lastRowSelected)
+{
+    // Decode the selected track in the background so it loads instantly into a deck that decodes into memory
+    const auto file = trackTable.getFile(lastRowSelected);
+
+    if (file != File())
+    {
+        trackLoader.prefetch(URL{file});
+    }
+}
+
 void PlaylistComponent::buttonClicked(Button *button)
 {
+    // Ask for a folder to add to the library
+    if (button == &addFolderButton)
+    {
+        folderChooser = std::make_unique<FileChooser>("Add a folder to the library", File::getSpecialLocation(File::userMusicDirectory));
+        folderChooser->launchAsync(FileBrowserComponent::openMode | FileBrowserComponent::canSelectDirectories,
+                                   [this](const FileChooser &chooser)
+                                   {
+                                       if (chooser.getResult().isDirectory())
+                                       {
+                                           trackLibrary.addRoot(chooser.getResult());
+                                       }
+                                   });
+        return;
+    }
+
     // Get the row number from the button's component ID
     int id = std::stoi(button->getComponentID().toStdString());
     std::cout << "Button clicked" << std::endl;
 }
 
-/**
- * Iterates through the specified folder and adds each file to the track list.
- * !!! This function was AI generated. !!!
- *
- * @param folderPath The path of the music folder to iterate through.
- */
-void PlaylistComponent::iterateMusicFolder(const std::string folderPath)
+// Show a track's key once its analysis has finished
+void PlaylistComponent::setTrackAnalysis(const File &file, const TrackAnalysis &analysis)
 {
-    try
-    {
-        // Check if the specified path exists and is a directory
-        if (std::filesystem::exists(folderPath) && std::filesystem::is_directory(folderPath))
-        {
-            // Iterate through the directory and add each file to the track list
-            for (const auto &entry : std::filesystem::directory_iterator(folderPath))
-            {
-                const auto &filePath = entry.path();
+    const auto numRows = trackTable.getNumRows();
+    const auto position = trackTable.setAnalysis(file, analysis);
 
-                // Add the file name, size, and a placeholder artist to the track list
-                trackTitles.push_back({entry.path().filename().string(), std::to_string(std::filesystem::file_size(filePath) / 10000), "Artist 1"});
-            }
-        }
-        else
-        {
-            std::cerr << "The specified path is not a valid directory." << std::endl;
-        }
+    // A row that started or stopped matching the search moves the rest of the view
+    if (trackTable.getNumRows() != numRows)
+    {
+        tableComponent.updateContent();
+        tableComponent.repaint();
+    }
+    else if (position >= 0)
+    {
+        tableComponent.repaintRow(position);
     }
-    catch (const std::filesystem::filesystem_error &e)
+}
+
+// Map the table's column ids to the columns of the track table
+TrackTable::Column PlaylistComponent::getColumn(int columnId)
+{
+    switch (columnId)
     {
-        std::cerr << "Filesystem error: " << e.what() << std::endl;
+    case 1:
+        return TrackTable::title;
+    case 2:
+        return TrackTable::size;
+    case 3:
+        return TrackTable::key;
+    case 5:
+        return TrackTable::artist;
+    case 6:
+        return TrackTable::album;
+    case 7:
+        return TrackTable::length;
+    case 8:
+        return TrackTable::bitrate;
+    case 9:
+        return TrackTable::bpm;
+    default:
+        return TrackTable::numColumns;
     }
-}
\ No newline at end of file
+}
+
+// Rebuild the rows from the library, keeping the table sorted the way it was
+void PlaylistComponent::refreshTracks()
+{
+    trackTable.setTracks(trackLibrary.getTracks(), trackAnalyser);
+    tableComponent.updateContent();
+    tableComponent.repaint();
+}
+
+// Work out the tempo and key of any of the tracks that haven't been analysed yet, filling in rows as they finish
+void PlaylistComponent::analyseTracks()
+{
+    trackAnalyser.analyseLibrary(trackLibrary.getTracks(), [safeThis = Component::SafePointer<PlaylistComponent>(this)](const File &file, const TrackAnalysis &analysis)
+                                 {
+                                     if (safeThis != nullptr)
+                                     {
+                                         safeThis->setTrackAnalysis(file, analysis);
+                                     } });
+}
@@ -1,9 +1,17 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TrackLibrary.h"
+#include "TrackTable.h"
+#include "TrackLoader.h"
+#include "TrackAnalyser.h"
+
 class PlaylistComponent : public juce::Component,
                           public juce::TableListBoxModel,
                           public juce::Button::Listener
 {
 public:
-    PlaylistComponent(); // Constructor for the PlaylistComponent class
+    PlaylistComponent(TrackLibrary &library, TrackLoader &loader, TrackAnalyser &analyser); // Constructor, takes the library to show, the loader used to prefetch selected tracks and the analyser for imported tracks
 
     ~PlaylistComponent() override; // Destructor for the PlaylistComponent class
 
@@ -26,21 +34,42 @@ public:
                    int height,
                    bool rowIsSelected) override;
 
+    // Function to sort the rows when a column header is clicked
+    void sortOrderChanged(int newSortColumnId, bool isForwards) override;
+
+    // Function to decode the selected track into the shared cache ahead of loading it
+    void selectedRowsChanged(int lastRowSelected) override;
+
     // Function to refresh the component for a specific cell in the table
     Component *refreshComponentForCell(int rowNumber,
                                        int columnId,
                                        bool isRowSelected,
                                        Component *existingComponentToUpdate) override;
 
-    // Function to iterate through the music folder and populate the table with track titles
-    void iterateMusicFolder(const std::string folderPath);
-
     // Function to handle button click events
     void buttonClicked(Button *button) override;
 
 private:
+    // Function to fill the table with the tracks in the library
+    void refreshTracks();
+
+    // Function to analyse the tracks in the library that haven't been analysed yet
+    void analyseTracks();
+
+    // Function to fill in the key of a track once it has been analysed
+    void setTrackAnalysis(const File &file, const TrackAnalysis &analysis);
+
+    // Function to get the track table column shown in a table column, or numColumns if there isn't one
+    static TrackTable::Column getColumn(int columnId);
+
     TableListBox tableComponent;                  // Table component to display the playlist
-    std::vector<std::vector<String>> trackTitles; // Vector to store track titles
+    TrackTable trackTable;                        // The tracks in the library, stored by column
+    TextEditor searchBox;                         // Search field that filters the table as you type
+    TextButton addFolderButton{"Add Folder"};     // Button to add a folder to the library
+    std::unique_ptr<FileChooser> folderChooser;   // Chooser for the folder, kept alive while it is open
+    TrackLibrary &trackLibrary;                   // The tracks in the user's music folders
+    TrackLoader &trackLoader;                     // Loader used to prefetch tracks into the decoded cache
+    TrackAnalyser &trackAnalyser;                 // Analyses the tempo and key of imported tracks in the background
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PlaylistComponent)
     // Macro to declare the class as non-copyable and enable leak detection
@@ -0,0 +1,397 @@
+/*
+  ==============================================================================
+
+    ReadAheadBuffer.cpp
+    Created: 17 Oct 2026 9:12:40am
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "ReadAheadBuffer.h"
+
+// The largest number of samples decoded in one go, so a single chunk never
+// hogs the shared thread while another deck is waiting for data.
+static constexpr int maxChunkSize = 2048;
+
+// How often the background thread checks back while the buffer is full. Seeks and size changes
+// don't wake the thread, since that takes its lock, so this bounds how long they wait to be seen.
+static constexpr int idleCheckMilliseconds = 5;
+
+ReadAheadBuffer::ReadAheadBuffer(PositionableAudioSource *_source,
+                                 TimeSliceThread &thread,
+                                 bool deleteSourceWhenDeleted,
+                                 double _sourceSampleRate,
+                                 double _readAheadSeconds,
+                                 int _numberOfChannels)
+    : source(_source, deleteSourceWhenDeleted),
+      backgroundThread(thread),
+      sourceSampleRate(_sourceSampleRate > 0.0 ? _sourceSampleRate : 44100.0),
+      numberOfChannels(_numberOfChannels),
+      readAheadSeconds(_readAheadSeconds)
+{
+    jassert(source.get() != nullptr);
+}
+
+ReadAheadBuffer::~ReadAheadBuffer()
+{
+    // Make sure the background thread is no longer using this object.
+    releaseResources();
+}
+
+void ReadAheadBuffer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    // Stop the background thread from touching the buffer while it is reallocated.
+    if (isPrepared)
+    {
+        backgroundThread.removeTimeSliceClient(this);
+    }
+
+    buffer.setSize(numberOfChannels, getBufferSizeFor(readAheadSeconds.load() + historySeconds.load()));
+    buffer.clear();
+
+    {
+        const ScopedLock sl(bufferRangeLock);
+        bufferValidStart = 0;
+        bufferValidEnd = 0;
+        fillLevel = 0.0f;
+    }
+
+    source->prepareToPlay(samplesPerBlockExpected, sampleRate);
+    refillPending = true;
+    isPrepared = true;
+
+    backgroundThread.addTimeSliceClient(this);
+}
+
+void ReadAheadBuffer::releaseResources()
+{
+    // Unregister from the background thread before freeing anything it uses.
+    if (isPrepared)
+    {
+        backgroundThread.removeTimeSliceClient(this);
+        isPrepared = false;
+    }
+
+    buffer.setSize(numberOfChannels, 0);
+    source->releaseResources();
+}
+
+void ReadAheadBuffer::getNextAudioBlock(const AudioSourceChannelInfo &info)
+{
+    // Only copies from the ring buffer; the lock is never held by the decoder
+    // for longer than it takes to update the valid range.
+    const ScopedLock sl(bufferRangeLock);
+
+    auto pos = nextPlayPos.load();
+    const auto validStart = (int)(jlimit(bufferValidStart, bufferValidEnd, pos) - pos);
+    const auto validEnd = (int)(jlimit(bufferValidStart, bufferValidEnd, pos + info.numSamples) - pos);
+
+    if (validStart >= validEnd)
+    {
+        info.clearActiveBufferRegion();
+    }
+    else
+    {
+        if (validStart > 0)
+        {
+            info.buffer->clear(info.startSample, validStart);
+        }
+
+        if (validEnd < info.numSamples)
+        {
+            info.buffer->clear(info.startSample + validEnd, info.numSamples - validEnd);
+        }
+
+        const auto ringSize = buffer.getNumSamples();
+        const auto ringStart = (int)((pos + validStart) % ringSize);
+        const auto numToCopy = validEnd - validStart;
+        const auto firstPart = jmin(numToCopy, ringSize - ringStart);
+
+        for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+        {
+            if (chan >= numberOfChannels)
+            {
+                info.buffer->clear(chan, info.startSample, info.numSamples);
+                continue;
+            }
+
+            info.buffer->copyFrom(chan, info.startSample + validStart, buffer, chan, ringStart, firstPart);
+
+            if (firstPart < numToCopy)
+            {
+                info.buffer->copyFrom(chan, info.startSample + validStart + firstPart, buffer, chan, 0, numToCopy - firstPart);
+            }
+        }
+    }
+
+    // A gap before the end of the source means the decoder fell behind. The
+    // gap straight after a seek is expected and is not counted.
+    const auto wanted = (int)jlimit<int64>(0, info.numSamples, source->getTotalLength() - pos);
+
+    if ((validStart > 0 || validEnd < wanted) && !refillPending.load())
+    {
+        ++underrunCount;
+    }
+
+    // Advance the playhead unless a seek happened while we were copying.
+    if (nextPlayPos.compare_exchange_strong(pos, pos + info.numSamples))
+    {
+        pos += info.numSamples;
+    }
+
+    updateFillLevel(pos);
+}
+
+void ReadAheadBuffer::setNextReadPosition(int64 newPosition)
+{
+    // Jumps that land inside the buffer, such as loops into the history, don't need
+    // the decoder. Anything else flags a refill, which the background thread sees on its next check.
+    const ScopedLock sl(bufferRangeLock);
+
+    if (newPosition < bufferValidStart || newPosition >= bufferValidEnd)
+    {
+        refillPending = true;
+    }
+
+    nextPlayPos = newPosition;
+}
+
+int64 ReadAheadBuffer::getNextReadPosition() const
+{
+    return nextPlayPos.load();
+}
+
+int64 ReadAheadBuffer::getTotalLength() const
+{
+    return source->getTotalLength();
+}
+
+bool ReadAheadBuffer::isLooping() const
+{
+    return source->isLooping();
+}
+
+void ReadAheadBuffer::setReadAheadSeconds(double seconds)
+{
+    // The buffer itself is reallocated on the background thread, on its next check.
+    if (seconds <= 0.0)
+    {
+        std::cout << "ReadAheadBuffer::Invalid read-ahead size: " << seconds << " Size should be above 0" << std::endl;
+    }
+    else
+    {
+        readAheadSeconds = seconds;
+    }
+}
+
+double ReadAheadBuffer::getReadAheadSeconds() const
+{
+    return readAheadSeconds.load();
+}
+
+void ReadAheadBuffer::setHistorySeconds(double seconds)
+{
+    // The buffer grows to hold the history on the background thread, on its next check.
+    historySeconds = jmax(0.0, seconds);
+}
+
+float ReadAheadBuffer::getFillLevel() const
+{
+    return fillLevel.load();
+}
+
+int ReadAheadBuffer::getUnderrunCount() const
+{
+    return underrunCount.load();
+}
+
+void ReadAheadBuffer::resetUnderrunCount()
+{
+    underrunCount = 0;
+}
+
+int ReadAheadBuffer::useTimeSlice()
+{
+    // Called repeatedly by the background thread. Returns how long to wait before the next call.
+    resizeBufferIfNeeded();
+    return readNextBufferChunk() ? 1 : idleCheckMilliseconds;
+}
+
+int ReadAheadBuffer::getBufferSizeFor(double seconds) const
+{
+    // Never smaller than a few decoding chunks, otherwise the buffer can't keep up.
+    return jmax(maxChunkSize * 4, roundToInt(seconds * sourceSampleRate));
+}
+
+int64 ReadAheadBuffer::getHistorySamples() const
+{
+    // Never let the history take more than half of the buffer.
+    return jmin((int64)(historySeconds.load() * sourceSampleRate), (int64)buffer.getNumSamples() / 2);
+}
+
+void ReadAheadBuffer::resizeBufferIfNeeded()
+{
+    // Only the background thread writes into the ring buffer, so the old contents
+    // can be copied across without holding the lock.
+    const auto newSize = getBufferSizeFor(readAheadSeconds.load() + historySeconds.load());
+    const auto oldSize = buffer.getNumSamples();
+
+    if (newSize == oldSize || oldSize == 0)
+    {
+        return;
+    }
+
+    int64 validStart, validEnd;
+    {
+        const ScopedLock sl(bufferRangeLock);
+        validStart = jmax(bufferValidStart, nextPlayPos.load());
+        validEnd = jmin(bufferValidEnd, validStart + newSize - 4);
+    }
+
+    AudioBuffer<float> newBuffer(numberOfChannels, newSize);
+    newBuffer.clear();
+
+    for (auto pos = validStart; pos < validEnd;)
+    {
+        const auto from = (int)(pos % oldSize);
+        const auto to = (int)(pos % newSize);
+        const auto num = (int)jmin<int64>(validEnd - pos, oldSize - from, newSize - to);
+
+        for (int chan = 0; chan < numberOfChannels; ++chan)
+        {
+            newBuffer.copyFrom(chan, to, buffer, chan, from, num);
+        }
+
+        pos += num;
+    }
+
+    {
+        const ScopedLock sl(bufferRangeLock);
+        std::swap(buffer, newBuffer);
+        bufferValidStart = validStart < validEnd ? validStart : 0;
+        bufferValidEnd = validStart < validEnd ? validEnd : 0;
+        updateFillLevel(nextPlayPos.load());
+    }
+}
+
+bool ReadAheadBuffer::readNextBufferChunk()
+{
+    // Works out which part of the ring buffer needs decoding next, decodes it
+    // without holding the lock, then publishes the new valid range.
+    int64 newBVS, newBVE, sectionToReadStart, sectionToReadEnd;
+
+    {
+        const ScopedLock sl(bufferRangeLock);
+
+        const auto pos = jmax((int64)0, nextPlayPos.load());
+        sectionToReadStart = 0;
+        sectionToReadEnd = 0;
+
+        if (pos < bufferValidStart || pos >= bufferValidEnd)
+        {
+            // The playhead jumped outside the buffer, start again from there.
+            newBVS = pos;
+            newBVE = jmin(pos + buffer.getNumSamples() - 4, pos + maxChunkSize);
+
+            sectionToReadStart = newBVS;
+            sectionToReadEnd = newBVE;
+
+            bufferValidStart = 0;
+            bufferValidEnd = 0;
+        }
+        else
+        {
+            // Keep the history behind the playhead and top up the end of the buffer.
+            const auto wantedStart = jmax((int64)0, pos - getHistorySamples());
+            const auto wantedEnd = wantedStart + buffer.getNumSamples() - 4;
+
+            newBVS = jmax(bufferValidStart, wantedStart);
+            newBVE = bufferValidEnd;
+
+            if (wantedEnd - bufferValidEnd > 512)
+            {
+                newBVE = jmin(wantedEnd, bufferValidEnd + maxChunkSize);
+
+                sectionToReadStart = bufferValidEnd;
+                sectionToReadEnd = newBVE;
+
+                bufferValidStart = newBVS;
+            }
+        }
+    }
+
+    // Nothing more to decode past the end of the source.
+    sectionToReadEnd = jmin(sectionToReadEnd, jmax(sectionToReadStart, source->getTotalLength()));
+
+    if (sectionToReadStart >= sectionToReadEnd)
+    {
+        refillPending = false;
+        return false;
+    }
+
+    const auto ringSize = buffer.getNumSamples();
+    const auto bufferIndexStart = (int)(sectionToReadStart % ringSize);
+    const auto bufferIndexEnd = (int)(sectionToReadEnd % ringSize);
+
+    if (bufferIndexStart < bufferIndexEnd)
+    {
+        readBufferSection(sectionToReadStart, (int)(sectionToReadEnd - sectionToReadStart), bufferIndexStart);
+    }
+    else
+    {
+        const auto initialSize = ringSize - bufferIndexStart;
+        readBufferSection(sectionToReadStart, initialSize, bufferIndexStart);
+        readBufferSection(sectionToReadStart + initialSize, (int)(sectionToReadEnd - sectionToReadStart) - initialSize, 0);
+    }
+
+    {
+        const ScopedLock sl(bufferRangeLock);
+
+        // Only publish the new range if the playhead didn't jump while we were decoding.
+        const auto pos = nextPlayPos.load();
+
+        if (pos >= newBVS && pos <= sectionToReadEnd)
+        {
+            bufferValidStart = newBVS;
+            bufferValidEnd = sectionToReadEnd;
+            refillPending = false;
+        }
+
+        updateFillLevel(pos);
+    }
+
+    return true;
+}
+
+void ReadAheadBuffer::readBufferSection(int64 start, int length, int bufferOffset)
+{
+    // Decode a section of the source straight into the ring buffer.
+    if (source->getNextReadPosition() != start)
+    {
+        source->setNextReadPosition(start);
+    }
+
+    AudioSourceChannelInfo info(&buffer, bufferOffset, length);
+    source->getNextAudioBlock(info);
+}
+
+void ReadAheadBuffer::updateFillLevel(int64 playPosition)
+{
+    // Only the part of the buffer ahead of the playhead counts. Decoded all the
+    // way to the end of the track counts as full.
+    const auto capacity = buffer.getNumSamples() - 4 - getHistorySamples();
+
+    if (capacity <= 0)
+    {
+        fillLevel = 0.0f;
+    }
+    else if (bufferValidEnd >= source->getTotalLength() && playPosition >= bufferValidStart)
+    {
+        fillLevel = 1.0f;
+    }
+    else
+    {
+        fillLevel = jlimit(0.0f, 1.0f, (float)(bufferValidEnd - playPosition) / (float)capacity);
+    }
+}
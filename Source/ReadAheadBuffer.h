@@ -0,0 +1,155 @@
+/*
+	==============================================================================
+
+	ReadAheadBuffer.h
+	Created: 17 Oct 2026 9:12:40am
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+	Decodes a PositionableAudioSource ahead of the playhead on a shared background
+	thread, so that the audio callback only ever copies already-decoded PCM.
+
+	This works like JUCE's BufferingAudioSource, but the audio thread never waits for
+	the decoder: samples that are not ready yet are played as silence and counted as
+	an underrun. The fill level of the buffer is published so the GUI can show it.
+
+	Some already-played audio can be kept behind the playhead as history, so that
+	short backward jumps such as loops are served from the buffer without a refill.
+*/
+class ReadAheadBuffer : public PositionableAudioSource,
+						private TimeSliceClient
+{
+public:
+	/**
+		Constructor.
+		@param source The source to decode from, usually an AudioFormatReaderSource.
+		@param thread The background thread that does the decoding. It can be shared by several buffers.
+		@param deleteSourceWhenDeleted Whether this object takes ownership of the source.
+		@param sourceSampleRate The sample rate of the source, used to size the buffer.
+		@param readAheadSeconds How many seconds of audio to keep decoded ahead of the playhead.
+		@param numberOfChannels The number of channels to buffer.
+	*/
+	ReadAheadBuffer(PositionableAudioSource *source,
+					TimeSliceThread &thread,
+					bool deleteSourceWhenDeleted,
+					double sourceSampleRate,
+					double readAheadSeconds,
+					int numberOfChannels = 2);
+
+	/**
+		Destructor.
+	*/
+	~ReadAheadBuffer() override;
+
+	/**
+		Allocates the buffer and registers this object with the background thread.
+		@param samplesPerBlockExpected The number of samples per block expected.
+		@param sampleRate The sample rate of the audio.
+	*/
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+
+	/**
+		Unregisters this object from the background thread and frees the buffer.
+	*/
+	void releaseResources() override;
+
+	/**
+		Copies the next block of decoded audio into the buffer. Any samples that the
+		background thread has not decoded yet are cleared and counted as an underrun.
+		@param bufferToFill The buffer to be filled with audio data.
+	*/
+	void getNextAudioBlock(const AudioSourceChannelInfo &bufferToFill) override;
+
+	/**
+		Moves the playhead. If the new position isn't buffered, a refill is flagged and
+		the background thread starts it on its next check, within a few milliseconds.
+		This never takes the background thread's lock, so it is safe on the audio thread.
+		@param newPosition The new position in samples.
+	*/
+	void setNextReadPosition(int64 newPosition) override;
+
+	/**
+		Returns the position of the playhead in samples.
+	*/
+	int64 getNextReadPosition() const override;
+
+	/**
+		Returns the length of the source in samples.
+	*/
+	int64 getTotalLength() const override;
+
+	/**
+		Returns whether the source is looping.
+	*/
+	bool isLooping() const override;
+
+	/**
+		Changes the amount of audio kept ahead of the playhead. The buffer is
+		reallocated on the background thread, keeping whatever was already decoded.
+		@param seconds The read-ahead size in seconds.
+	*/
+	void setReadAheadSeconds(double seconds);
+
+	/**
+		Returns the read-ahead size in seconds.
+	*/
+	double getReadAheadSeconds() const;
+
+	/**
+		Changes how much already-played audio is kept behind the playhead.
+		@param seconds The history size in seconds.
+	*/
+	void setHistorySeconds(double seconds);
+
+	/**
+		Returns how full the read-ahead buffer is.
+		@return The fill level, where 0.0 is empty and 1.0 is full (or decoded up to the end of the source).
+	*/
+	float getFillLevel() const;
+
+	/**
+		Returns the number of audio blocks that had to be padded with silence
+		because the background thread had not decoded them in time.
+	*/
+	int getUnderrunCount() const;
+
+	/**
+		Resets the underrun counter to zero.
+	*/
+	void resetUnderrunCount();
+
+private:
+	int useTimeSlice() override;
+
+	int getBufferSizeFor(double seconds) const;
+	int64 getHistorySamples() const;
+	void resizeBufferIfNeeded();
+	bool readNextBufferChunk();
+	void readBufferSection(int64 start, int length, int bufferOffset);
+	void updateFillLevel(int64 playPosition); // Must be called with bufferRangeLock held
+
+	OptionalScopedPointer<PositionableAudioSource> source; // The source being decoded
+	TimeSliceThread &backgroundThread;					   // The shared decoding thread
+	const double sourceSampleRate;						   // Sample rate of the source
+	const int numberOfChannels;							   // Number of channels that are buffered
+
+	AudioBuffer<float> buffer;				   // Ring buffer holding the decoded audio, only written by the background thread
+	CriticalSection bufferRangeLock;		   // Guards the valid range and buffer swaps; never held while decoding
+	int64 bufferValidStart = 0;				   // First source sample held in the ring buffer
+	int64 bufferValidEnd = 0;				   // One past the last source sample held in the ring buffer
+	std::atomic<int64> nextPlayPos{0};		   // Position of the playhead in source samples
+	std::atomic<double> readAheadSeconds;	   // Requested read-ahead size
+	std::atomic<double> historySeconds{0.0};   // Requested history size
+	std::atomic<float> fillLevel{0.0f};		   // Published fill level for the GUI
+	std::atomic<int> underrunCount{0};		   // Number of blocks that were not ready in time
+	std::atomic<bool> refillPending{true};	   // Set after a seek, so the background thread refills and the refill is not counted as an underrun
+	bool isPrepared = false;				   // Whether prepareToPlay has been called
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ReadAheadBuffer)
+};
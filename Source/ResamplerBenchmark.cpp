@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    ResamplerBenchmark.cpp
+    Created: 20 Oct 2026 10:12:31pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "ResamplerBenchmark.h"
+
+// The case being measured: a 44.1 kHz track sped up by 8% on a 48 kHz device.
+static constexpr double trackRate = 44100.0;
+static constexpr double deviceRate = 48000.0;
+static constexpr double speed = 1.08;
+
+// A low tone and one near the top of the band, where interpolation noise and aliasing show up.
+static constexpr double testFrequencies[] = {1000.0, 15000.0};
+
+// Ten seconds is a whole number of cycles of both tones, so the looped tone has no seam.
+static constexpr double toneSeconds = 10.0;
+
+// The start of each output is left out of the SNR, while the chains settle.
+static constexpr double settleSeconds = 0.5;
+
+int ResamplerBenchmark::runFromCommandLine(const StringArray &args)
+{
+    // Read the optional "--seconds <n>" and "--block <n>".
+    const auto secondsIndex = args.indexOf("--seconds");
+    const auto blockIndex = args.indexOf("--block");
+
+    if (secondsIndex >= 0)
+    {
+        outputSeconds = args[secondsIndex + 1].getDoubleValue();
+    }
+
+    if (blockIndex >= 0)
+    {
+        blockSize = args[blockIndex + 1].getIntValue();
+    }
+
+    if (outputSeconds <= settleSeconds || blockSize <= 0)
+    {
+        std::cout << "Usage: xDecks --benchmark-resampler [--seconds <more than 0.5>] [--block <samples>]" << std::endl;
+        return 1;
+    }
+
+    std::cout << "44.1 kHz track at speed " << speed << " on a 48 kHz device, " << outputSeconds << " s in blocks of " << blockSize << std::endl;
+    std::cout << "chain\tCPU ms per s\tSNR 1 kHz dB\tSNR 15 kHz dB" << std::endl;
+
+    const StringArray names{"transport + ResamplingAudioSource", "sinc low", "sinc medium", "sinc high"};
+
+    for (int chain = 0; chain < names.size(); ++chain)
+    {
+        String snrText;
+        double cpu = 0.0;
+
+        for (const auto frequency : testFrequencies)
+        {
+            // A stereo tone at the track's rate, the same on both channels.
+            AudioBuffer<float> tone(2, (int)(toneSeconds * trackRate));
+
+            for (int i = 0; i < tone.getNumSamples(); ++i)
+            {
+                const auto value = (float)(0.5 * std::sin(MathConstants<double>::twoPi * frequency * i / trackRate));
+                tone.setSample(0, i, value);
+                tone.setSample(1, i, value);
+            }
+
+            const auto result = chain == 0 ? runOldChain(tone, frequency)
+                                           : runSincChain(tone, frequency, (SincResamplingAudioSource::Quality)(chain - 1));
+            cpu += result.cpuMillisecondsPerSecond / (double)std::size(testFrequencies);
+            snrText << "\t" << String(result.snrDecibels, 1);
+        }
+
+        std::cout << names[chain] << "\t" << String(cpu, 3) << snrText << std::endl;
+    }
+
+    return 0;
+}
+
+ResamplerBenchmark::Result ResamplerBenchmark::runOldChain(AudioBuffer<float> &tone, double frequency)
+{
+    // The transport converts the track's rate to the device's, then the speed is applied on top.
+    MemoryAudioSource source(tone, false, true);
+    AudioTransportSource transportSource;
+    transportSource.setSource(&source, 0, nullptr, trackRate);
+
+    // The speed is set after preparing, as the deck did: ResamplingAudioSource prepares its input at
+    // the device rate times its ratio, which would make the transport undo the speed.
+    ResamplingAudioSource resamplingSource(&transportSource, false, 2);
+    resamplingSource.prepareToPlay(blockSize, deviceRate);
+    resamplingSource.setResamplingRatio(speed);
+    transportSource.start();
+
+    const auto result = render(resamplingSource, frequency * speed);
+    resamplingSource.releaseResources();
+    transportSource.setSource(nullptr);
+    return result;
+}
+
+ResamplerBenchmark::Result ResamplerBenchmark::runSincChain(AudioBuffer<float> &tone, double frequency, SincResamplingAudioSource::Quality quality)
+{
+    // One pass with the combined ratio, as a deck now does it.
+    MemoryAudioSource source(tone, false, true);
+    SincResamplingAudioSource resampler(&source, false, 2);
+    resampler.setQuality(quality);
+    resampler.prepareToPlay(blockSize, deviceRate);
+    resampler.setResamplingRatio(speed * trackRate / deviceRate);
+
+    const auto result = render(resampler, frequency * speed);
+    resampler.releaseResources();
+    return result;
+}
+
+ResamplerBenchmark::Result ResamplerBenchmark::render(AudioSource &chain, double outputFrequency)
+{
+    // Only the chain's own calls are timed, block by block, as the audio callback would make them.
+    AudioBuffer<float> output(2, (int)(outputSeconds * deviceRate));
+    int64 ticks = 0;
+
+    for (int start = 0; start < output.getNumSamples(); start += blockSize)
+    {
+        const auto num = jmin(blockSize, output.getNumSamples() - start);
+        const auto before = Time::getHighResolutionTicks();
+        chain.getNextAudioBlock(AudioSourceChannelInfo(&output, start, num));
+        ticks += Time::getHighResolutionTicks() - before;
+    }
+
+    Result result;
+    result.cpuMillisecondsPerSecond = Time::highResolutionTicksToSeconds(ticks) * 1000.0 / outputSeconds;
+    result.snrDecibels = measureSnr(output, (int)(settleSeconds * deviceRate), outputFrequency, deviceRate);
+    return result;
+}
+
+double ResamplerBenchmark::measureSnr(const AudioBuffer<float> &output, int startSample, double frequency, double sampleRate)
+{
+    // Fit a*cos + b*sin at the frequency to the left channel, by solving the 2x2 normal equations.
+    const auto *data = output.getReadPointer(0);
+    const auto num = output.getNumSamples();
+    double cc = 0.0, ss = 0.0, cs = 0.0, xc = 0.0, xs = 0.0;
+
+    for (int i = startSample; i < num; ++i)
+    {
+        const auto angle = MathConstants<double>::twoPi * frequency * i / sampleRate;
+        const auto c = std::cos(angle);
+        const auto s = std::sin(angle);
+        cc += c * c;
+        ss += s * s;
+        cs += c * s;
+        xc += data[i] * c;
+        xs += data[i] * s;
+    }
+
+    const auto determinant = cc * ss - cs * cs;
+
+    if (determinant <= 0.0)
+    {
+        return 0.0;
+    }
+
+    const auto a = (xc * ss - xs * cs) / determinant;
+    const auto b = (xs * cc - xc * cs) / determinant;
+
+    // Everything the sine doesn't explain is noise.
+    double signal = 0.0, noise = 0.0;
+
+    for (int i = startSample; i < num; ++i)
+    {
+        const auto angle = MathConstants<double>::twoPi * frequency * i / sampleRate;
+        const auto fitted = a * std::cos(angle) + b * std::sin(angle);
+        signal += fitted * fitted;
+        noise += (data[i] - fitted) * (data[i] - fitted);
+    }
+
+    return noise > 0.0 ? 10.0 * std::log10(signal / noise) : 200.0;
+}
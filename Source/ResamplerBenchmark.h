@@ -0,0 +1,55 @@
+/*
+	==============================================================================
+
+	ResamplerBenchmark.h
+	Created: 20 Oct 2026 10:12:31pm
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "SincResamplingAudioSource.h"
+
+/**
+	Compares the old two-pass resampling of a deck with the SincResamplingAudioSource.
+
+	This is what "xDecks --benchmark-resampler [--seconds 20] [--block 256]" runs. A
+	44.1 kHz sine is played at a speed of 1.08 to a 48 kHz output through:
+
+		- the old chain: an AudioTransportSource converting 44.1 to 48 kHz, then a
+		  ResamplingAudioSource applying the speed,
+		- the SincResamplingAudioSource at each quality setting, in one pass.
+
+	For each it prints the CPU time per second of output audio and the signal-to-noise
+	ratio at two test frequencies. The SNR is measured by fitting a sine at the expected
+	output frequency to the output by least squares and comparing the power of the fit
+	with the power of what is left, so it counts both aliasing and interpolation noise.
+*/
+class ResamplerBenchmark
+{
+public:
+	/**
+		Runs the benchmark and prints the results.
+		@param args The command line arguments, optionally containing "--seconds <n>" and "--block <n>".
+		@return The process exit code: 0 on success.
+	*/
+	int runFromCommandLine(const StringArray &args);
+
+private:
+	// The results of one chain at one frequency.
+	struct Result
+	{
+		double cpuMillisecondsPerSecond = 0.0; // CPU time per second of output
+		double snrDecibels = 0.0;			   // Signal-to-noise ratio of the output
+	};
+
+	Result runOldChain(AudioBuffer<float> &tone, double frequency);
+	Result runSincChain(AudioBuffer<float> &tone, double frequency, SincResamplingAudioSource::Quality quality);
+	Result render(AudioSource &chain, double outputFrequency);
+	static double measureSnr(const AudioBuffer<float> &output, int startSample, double frequency, double sampleRate);
+
+	double outputSeconds = 20.0; // Length of output rendered for each measurement
+	int blockSize = 256;		 // Block size the chains are rendered in
+};
@@ -0,0 +1,159 @@
+/*
+  ==============================================================================
+
+    ScrollingWaveform.cpp
+    Created: 19 Oct 2026 8:41:05pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ScrollingWaveform.h"
+
+//==============================================================================
+ScrollingWaveform::ScrollingWaveform(DJAudioPlayer &_player) : player(_player)
+{
+    // Every pixel is painted, so nothing behind the waveform has to be redrawn with it
+    setOpaque(true);
+}
+
+ScrollingWaveform::~ScrollingWaveform()
+{
+}
+
+// Blit the tiles that are in view, offset so the playhead is in the centre
+void ScrollingWaveform::paint(juce::Graphics &g)
+{
+    g.fillAll(Colour::fromRGB(13, 27, 42));
+
+    if (overview != nullptr)
+    {
+        const auto left = getPlayheadPixel() - getWidth() / 2.0;
+        const auto firstTile = (int)std::floor(left / tileWidth);
+        const auto lastTile = (int)std::floor((left + getWidth()) / tileWidth);
+
+        for (int index = firstTile; index <= lastTile; ++index)
+        {
+            g.drawImageAt(getTile(index), roundToInt(index * tileWidth - left), 0);
+        }
+
+        // Tiles that have scrolled well out of view aren't needed any more
+        for (auto it = tiles.begin(); it != tiles.end();)
+        {
+            it = (it->first < firstTile - 1 || it->first > lastTile + 1) ? tiles.erase(it) : std::next(it);
+        }
+    }
+
+    // Beat markers are only lines, so they are drawn every frame instead of into the tiles
+    if (overview != nullptr && analysis.hasBeatGrid())
+    {
+        const auto pixelsPerSecond = overview->getSampleRate() / getSamplesPerPixel();
+        const auto leftSeconds = (getPlayheadPixel() - getWidth() / 2.0) / pixelsPerSecond;
+        const auto firstBeat = (int)std::ceil(analysis.getBeatAt(leftSeconds));
+        const auto lastBeat = (int)std::floor(analysis.getBeatAt(leftSeconds + getWidth() / pixelsPerSecond));
+
+        for (int beat = firstBeat; beat <= lastBeat; ++beat)
+        {
+            // Downbeats are brighter and taller than the other beats
+            const auto isDownbeat = beat % 4 == 0;
+            const auto x = (float)((analysis.getBeatTime(beat) - leftSeconds) * pixelsPerSecond);
+            g.setColour(Colours::white.withAlpha(isDownbeat ? 0.8f : 0.35f));
+            g.drawLine(x, 0.0f, x, getHeight() * (isDownbeat ? 1.0f : 0.25f));
+        }
+    }
+
+    // Draw the outline and the fixed playhead in the centre
+    g.setColour(Colour::fromRGB(119, 141, 169));
+    g.drawRect(getLocalBounds(), 1);
+    g.setColour(Colours::white);
+    g.fillRect(getWidth() / 2 - 1, 0, 2, getHeight());
+}
+
+void ScrollingWaveform::resized()
+{
+    // Tiles are drawn for a height and a zoom, and the zoom depends on the width
+    tiles.clear();
+    lastPlayheadPixel = -1;
+}
+
+// Scrolling up zooms in, scrolling down zooms out
+void ScrollingWaveform::mouseWheelMove(const MouseEvent &, const MouseWheelDetails &wheel)
+{
+    setVisibleSeconds(visibleSeconds * (wheel.deltaY > 0 ? 0.8 : 1.25));
+}
+
+// Show a new track, or the overview of the current one once it has been generated
+void ScrollingWaveform::setOverview(std::shared_ptr<const WaveformOverview> newOverview)
+{
+    overview = std::move(newOverview);
+    tiles.clear();
+    repaint();
+}
+
+// Draw the beat grid of the loaded track
+void ScrollingWaveform::setBeatGrid(const TrackAnalysis &newAnalysis)
+{
+    analysis = newAnalysis;
+    repaint();
+}
+
+// Set how much of the track is visible
+void ScrollingWaveform::setVisibleSeconds(double seconds)
+{
+    seconds = jlimit(2.0, 32.0, seconds);
+
+    if (seconds != visibleSeconds)
+    {
+        visibleSeconds = seconds;
+        tiles.clear();
+        repaint();
+    }
+}
+
+// Repaint only when the playhead has moved by at least a pixel
+void ScrollingWaveform::update()
+{
+    if (overview == nullptr)
+    {
+        return;
+    }
+
+    const auto playheadPixel = roundToInt(getPlayheadPixel());
+
+    if (playheadPixel != lastPlayheadPixel)
+    {
+        lastPlayheadPixel = playheadPixel;
+        repaint();
+    }
+}
+
+// Draw a tile the first time it comes into view
+const Image &ScrollingWaveform::getTile(int index)
+{
+    auto it = tiles.find(index);
+
+    if (it == tiles.end())
+    {
+        Image tile(Image::RGB, tileWidth, jmax(1, getHeight()), false);
+        Graphics g(tile);
+        g.fillAll(Colour::fromRGB(13, 27, 42));
+
+        const auto samplesPerPixel = getSamplesPerPixel();
+        overview->draw(g, tile.getBounds(), index * tileWidth * samplesPerPixel, samplesPerPixel);
+
+        it = tiles.emplace(index, tile).first;
+    }
+
+    return it->second;
+}
+
+double ScrollingWaveform::getSamplesPerPixel() const
+{
+    return overview->getSampleRate() * visibleSeconds / jmax(1, getWidth());
+}
+
+double ScrollingWaveform::getPlayheadPixel() const
+{
+    return player.getPositionRelative() * (double)overview->getLengthInSamples() / getSamplesPerPixel();
+}
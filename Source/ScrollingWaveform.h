@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    ScrollingWaveform.h
+    Created: 19 Oct 2026 8:41:05pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+#include "WaveformStore.h"
+#include "TrackAnalyser.h"
+
+//==============================================================================
+/*
+ * ScrollingWaveform class
+ * A zoomed-in waveform that scrolls past a fixed playhead in the centre, like the
+ * big waveform on a CDJ. The waveform is drawn once into image tiles as they come
+ * into view, so each frame only blits a few tiles at a new offset and draws the
+ * playhead on top. Frames follow the display's refresh rate.
+ */
+class ScrollingWaveform : public juce::Component
+{
+public:
+  /**
+   * @brief Constructs a ScrollingWaveform object.
+   *
+   * @param player The deck whose playhead is followed.
+   */
+  ScrollingWaveform(DJAudioPlayer &player);
+
+  /**
+   * @brief Destructs the ScrollingWaveform object.
+   */
+  ~ScrollingWaveform() override;
+
+  /**
+   * @brief Paints the visible tiles and the playhead.
+   *
+   * @param g The Graphics object used for painting.
+   */
+  void paint(juce::Graphics &g) override;
+
+  /**
+   * @brief Drops the tiles, as they depend on the size of the component.
+   */
+  void resized() override;
+
+  /**
+   * @brief Zooms in and out with the mouse wheel.
+   */
+  void mouseWheelMove(const MouseEvent &event, const MouseWheelDetails &wheel) override;
+
+  /**
+   * @brief Sets the overview the waveform is drawn from.
+   *
+   * @param newOverview The overview of the loaded track, or nullptr if there isn't one yet.
+   */
+  void setOverview(std::shared_ptr<const WaveformOverview> newOverview);
+
+  /**
+   * @brief Sets the beat grid drawn over the waveform.
+   *
+   * @param newAnalysis The analysis of the loaded track. Nothing is drawn if it has no beat grid.
+   */
+  void setBeatGrid(const TrackAnalysis &newAnalysis);
+
+  /**
+   * @brief Sets how much of the track is visible across the component.
+   *
+   * @param seconds The visible length in seconds, from 2 to 32.
+   */
+  void setVisibleSeconds(double seconds);
+
+private:
+  /**
+   * @brief Called once per display frame; repaints only if the playhead has moved a pixel.
+   */
+  void update();
+
+  /**
+   * @brief Returns a tile, drawing it first if it isn't cached.
+   *
+   * @param index The tile's index, counting tiles from the start of the track.
+   */
+  const Image &getTile(int index);
+
+  /**
+   * @brief Returns how many samples of the track one pixel covers at the current zoom.
+   */
+  double getSamplesPerPixel() const;
+
+  /**
+   * @brief Returns the playhead's position in pixels from the start of the track.
+   */
+  double getPlayheadPixel() const;
+
+  static constexpr int tileWidth = 256; /**< Width of a tile in pixels. */
+
+  DJAudioPlayer &player;                            /**< The deck being followed. */
+  std::shared_ptr<const WaveformOverview> overview; /**< What the tiles are drawn from. */
+  std::map<int, Image> tiles;                       /**< Tiles that have been drawn, by index. */
+  TrackAnalysis analysis;                           /**< Beat grid of the loaded track. */
+  double visibleSeconds = 8.0;                      /**< How much of the track is visible. */
+  int lastPlayheadPixel = -1;                       /**< Playhead pixel of the last repaint. */
+  VBlankAttachment vBlankAttachment{this, [this] { update(); }}; /**< Calls update() for every display frame. */
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScrollingWaveform)
+};
@@ -0,0 +1,234 @@
+/*
+  ==============================================================================
+
+    SincResamplingAudioSource.cpp
+    Created: 20 Oct 2026 9:26:44pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "SincResamplingAudioSource.h"
+
+// The kernel table is read with linear interpolation between this many phases per zero crossing.
+static constexpr int phasesPerZeroCrossing = 512;
+
+// The range of ratios, and the widest kernel, which together size the input buffer.
+static constexpr double minRatio = 1.0 / 16.0;
+static constexpr double maxRatio = 8.0;
+static constexpr int maxZeroCrossings = 16;
+
+// The most input samples the kernel reaches on either side of an output sample.
+static const int maxHalfWidth = (int)std::ceil(maxZeroCrossings * maxRatio) + 1;
+
+// Zeroth-order modified Bessel function of the first kind, for the Kaiser window.
+static double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; k < 64 && term > sum * 1.0e-12; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+
+    return sum;
+}
+
+SincResamplingAudioSource::SincResamplingAudioSource(AudioSource *_input, bool deleteInputWhenDeleted, int _numberOfChannels)
+    : input(_input, deleteInputWhenDeleted),
+      numberOfChannels(_numberOfChannels)
+{
+    jassert(input.get() != nullptr);
+    jassert(numberOfChannels == 1 || numberOfChannels == 2);
+
+    // Wider kernels get a stronger window and a cutoff closer to Nyquist.
+    kernels[(size_t)Quality::low] = makeKernel(4, 5.0, 0.90);
+    kernels[(size_t)Quality::medium] = makeKernel(8, 7.0, 0.94);
+    kernels[(size_t)Quality::high] = makeKernel(maxZeroCrossings, 9.0, 0.97);
+    kernel = &kernels[(size_t)Quality::medium];
+}
+
+SincResamplingAudioSource::~SincResamplingAudioSource()
+{
+    // Destructor for SincResamplingAudioSource class.
+}
+
+void SincResamplingAudioSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    // Output is made in chunks of at most a block, so the input a chunk needs has a known limit.
+    maxChunk = jmax(1, samplesPerBlockExpected);
+    inputBuffer.setSize(numberOfChannels, 2 * maxHalfWidth + (int)std::ceil(maxChunk * maxRatio) + 4);
+    weights.malloc(2 * maxHalfWidth + 2);
+
+    input->prepareToPlay(samplesPerBlockExpected, sampleRate);
+    reset();
+}
+
+void SincResamplingAudioSource::releaseResources()
+{
+    input->releaseResources();
+    inputBuffer.setSize(numberOfChannels, 0);
+    weights.free();
+}
+
+void SincResamplingAudioSource::getNextAudioBlock(const AudioSourceChannelInfo &info)
+{
+    if (inputBuffer.getNumSamples() == 0)
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
+    // Every kernel was made up front, so a quality change is only a pointer swap.
+    kernel = &kernels[(size_t)requestedQuality.load()];
+
+    // Above a ratio of one the kernel is stretched, so its cutoff sits below the output's Nyquist frequency.
+    const auto step = jmin(1.0, 1.0 / ratio);
+    const auto halfWidth = kernel->zeroCrossings / step;
+    const auto phaseStep = step * phasesPerZeroCrossing;
+    const auto tableEnd = kernel->zeroCrossings * phasesPerZeroCrossing;
+    const auto *table = kernel->table.data();
+    const auto gain = (float)step;
+
+    for (int done = 0; done < info.numSamples;)
+    {
+        const auto num = jmin(maxChunk, info.numSamples - done);
+        ensureInput((int64)std::floor(position + (num - 1) * ratio + halfWidth) + 1);
+
+        auto *outLeft = info.buffer->getWritePointer(0, info.startSample + done);
+        auto *outRight = info.buffer->getNumChannels() > 1 ? info.buffer->getWritePointer(1, info.startSample + done) : nullptr;
+
+        for (int i = 0; i < num; ++i)
+        {
+            // Work out the weight of every input sample the kernel reaches, counting down from the left edge.
+            const auto first = (int64)std::ceil(position - halfWidth);
+            const auto numTaps = (int)((int64)std::floor(position + halfWidth) - first + 1);
+            auto phase = (position - (double)first) * phaseStep;
+
+            for (int tap = 0; tap < numTaps; ++tap, phase -= phaseStep)
+            {
+                const auto index = std::abs(phase);
+                const auto whole = (int)index;
+                weights[tap] = whole < tableEnd ? table[whole] + (float)(index - whole) * (table[whole + 1] - table[whole]) : 0.0f;
+            }
+
+            // Then use the same weights for both channels in one loop.
+            const auto offset = (int)(first - inputStart);
+            const auto *left = inputBuffer.getReadPointer(0, offset);
+            const auto *right = inputBuffer.getReadPointer(numberOfChannels - 1, offset);
+            float leftSum = 0.0f;
+            float rightSum = 0.0f;
+
+            for (int tap = 0; tap < numTaps; ++tap)
+            {
+                leftSum += weights[tap] * left[tap];
+                rightSum += weights[tap] * right[tap];
+            }
+
+            outLeft[i] = leftSum * gain;
+
+            if (outRight != nullptr)
+            {
+                outRight[i] = rightSum * gain;
+            }
+
+            position += ratio;
+        }
+
+        for (int chan = 2; chan < info.buffer->getNumChannels(); ++chan)
+        {
+            info.buffer->clear(chan, info.startSample + done, num);
+        }
+
+        done += num;
+
+        // Keep as much history as the widest kernel at the highest ratio reaches, like reset() does,
+        // so a quality, ratio or sample rate change on the next block never reads before the buffer.
+        discardInputBefore((int64)std::floor(position) - maxHalfWidth);
+    }
+}
+
+void SincResamplingAudioSource::setResamplingRatio(double newRatio)
+{
+    ratio = jlimit(minRatio, maxRatio, newRatio);
+}
+
+void SincResamplingAudioSource::setQuality(Quality newQuality)
+{
+    requestedQuality = newQuality;
+}
+
+SincResamplingAudioSource::Quality SincResamplingAudioSource::getQuality() const
+{
+    return requestedQuality.load();
+}
+
+void SincResamplingAudioSource::reset()
+{
+    // Start with silence before the first input sample, so the first kernels have something to their left.
+    inputBuffer.clear();
+    inputStart = -maxHalfWidth;
+    inputCount = maxHalfWidth;
+    position = 0.0;
+}
+
+double SincResamplingAudioSource::getLatency() const
+{
+    // Everything pulled past the centre of the next output sample's kernel hasn't been heard yet.
+    return (double)(inputStart + inputCount) - position;
+}
+
+SincResamplingAudioSource::Kernel SincResamplingAudioSource::makeKernel(int zeroCrossings, double beta, double cutoff)
+{
+    // One side of a Kaiser-windowed sinc, ending in zeros so the interpolation past the last phase reads nothing.
+    Kernel result;
+    result.zeroCrossings = zeroCrossings;
+    result.table.resize((size_t)(zeroCrossings * phasesPerZeroCrossing + 2), 0.0f);
+
+    for (int i = 0; i < zeroCrossings * phasesPerZeroCrossing; ++i)
+    {
+        const auto distance = (double)i / phasesPerZeroCrossing;
+        const auto x = MathConstants<double>::pi * cutoff * distance;
+        const auto sinc = i == 0 ? 1.0 : std::sin(x) / x;
+        const auto edge = distance / zeroCrossings;
+        const auto window = besselI0(beta * std::sqrt(1.0 - edge * edge)) / besselI0(beta);
+        result.table[(size_t)i] = (float)(cutoff * sinc * window);
+    }
+
+    return result;
+}
+
+void SincResamplingAudioSource::ensureInput(int64 endPosition)
+{
+    // Pull more input from the source if the buffer doesn't reach endPosition yet.
+    const auto needed = (int)(endPosition - (inputStart + inputCount));
+
+    if (needed > 0)
+    {
+        jassert(inputCount + needed <= inputBuffer.getNumSamples());
+        input->getNextAudioBlock(AudioSourceChannelInfo(&inputBuffer, inputCount, needed));
+        inputCount += needed;
+    }
+}
+
+void SincResamplingAudioSource::discardInputBefore(int64 streamPosition)
+{
+    // Move the input that is still needed to the front of the buffer.
+    const auto num = (int)jlimit((int64)0, (int64)inputCount, streamPosition - inputStart);
+
+    if (num == 0)
+    {
+        return;
+    }
+
+    for (int chan = 0; chan < numberOfChannels; ++chan)
+    {
+        auto *data = inputBuffer.getWritePointer(chan);
+        std::memmove(data, data + num, (size_t)(inputCount - num) * sizeof(float));
+    }
+
+    inputStart += num;
+    inputCount -= num;
+}
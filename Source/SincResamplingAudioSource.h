@@ -0,0 +1,127 @@
+/*
+	==============================================================================
+
+	SincResamplingAudioSource.h
+	Created: 20 Oct 2026 9:26:44pm
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+	Resamples its input by any ratio in one pass, for the decks' speed and for playing
+	tracks whose sample rate differs from the device's.
+
+	Each output sample is a windowed-sinc interpolation of the input around its exact
+	position. The Kaiser-windowed sinc is kept in a table with 512 phases per zero
+	crossing and read with linear interpolation, which makes it a polyphase filter with
+	as many phases as needed. When the ratio is above one the kernel is stretched by the
+	ratio, so the cutoff follows the output's Nyquist frequency and nothing aliases.
+	The weights of each output sample are worked out once and used for every channel.
+
+	The quality setting trades CPU for a steeper, cleaner filter by changing the number
+	of zero crossings on each side of the kernel and the window.
+*/
+class SincResamplingAudioSource : public AudioSource
+{
+public:
+	/** The quality/CPU setting of the resampler. */
+	enum class Quality
+	{
+		low,	// 4 zero crossings each side, cheapest
+		medium, // 8 zero crossings each side
+		high	// 16 zero crossings each side, the cleanest
+	};
+
+	/**
+		Constructor.
+		@param input The source to resample.
+		@param deleteInputWhenDeleted Whether this object takes ownership of the input.
+		@param numberOfChannels The number of channels to process.
+	*/
+	SincResamplingAudioSource(AudioSource *input, bool deleteInputWhenDeleted, int numberOfChannels = 2);
+
+	/**
+		Destructor.
+	*/
+	~SincResamplingAudioSource() override;
+
+	/**
+		Allocates the buffers for the widest kernel at the highest ratio, so nothing allocates while playing.
+		@param samplesPerBlockExpected The number of samples per block expected.
+		@param sampleRate The sample rate of the output.
+	*/
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+
+	/**
+		Frees the buffers.
+	*/
+	void releaseResources() override;
+
+	/**
+		Produces the next block of resampled audio, pulling as much input as it needs.
+		@param bufferToFill The buffer to be filled with audio data.
+	*/
+	void getNextAudioBlock(const AudioSourceChannelInfo &bufferToFill) override;
+
+	/**
+		Sets the resampling ratio. Only call this from the audio thread.
+		@param ratio The number of input samples consumed per output sample, clamped to 1/16 - 8.
+	*/
+	void setResamplingRatio(double ratio);
+
+	/**
+		Sets the quality setting. Can be called from any thread; it is applied at the start of the next block.
+		@param quality The new quality setting.
+	*/
+	void setQuality(Quality quality);
+
+	/**
+		Returns the quality setting.
+	*/
+	Quality getQuality() const;
+
+	/**
+		Forgets all buffered input. Call this from the audio thread when the resampler
+		is switched back in, so stale audio is never played.
+	*/
+	void reset();
+
+	/**
+		Returns how far the input already pulled runs ahead of the next output sample, which
+		is half the kernel plus what the last block pulled for it. Only call this from the audio thread.
+		@return The latency in input samples.
+	*/
+	double getLatency() const;
+
+private:
+	// A kernel table for one quality setting.
+	struct Kernel
+	{
+		int zeroCrossings = 0;	   // Zero crossings on each side of the centre
+		std::vector<float> table;  // One side of the kernel, phasesPerZeroCrossing values per zero crossing
+	};
+
+	static Kernel makeKernel(int zeroCrossings, double beta, double cutoff);
+	void ensureInput(int64 endPosition);
+	void discardInputBefore(int64 position);
+
+	OptionalScopedPointer<AudioSource> input; // The source being resampled
+	const int numberOfChannels;				  // Number of channels that are processed
+	std::atomic<Quality> requestedQuality{Quality::medium};
+	std::array<Kernel, 3> kernels;			  // The kernel of each quality setting
+
+	const Kernel *kernel = nullptr;	 // Kernel of the current quality
+	double ratio = 1.0;				 // Input samples per output sample
+	int maxChunk = 0;				 // Most output samples made from one pull of input
+	AudioBuffer<float> inputBuffer;	 // Input samples from inputStart onwards
+	int64 inputStart = 0;			 // Stream position of the first sample in inputBuffer
+	int inputCount = 0;				 // Number of valid samples in inputBuffer
+	double position = 0.0;			 // Stream position of the next output sample
+	HeapBlock<float> weights;		 // Kernel weights of the output sample being made
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SincResamplingAudioSource)
+};
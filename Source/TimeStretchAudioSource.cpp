@@ -0,0 +1,340 @@
+/*
+  ==============================================================================
+
+    TimeStretchAudioSource.cpp
+    Created: 18 Oct 2026 2:14:51pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "TimeStretchAudioSource.h"
+
+// Frame length, search tolerance and search decimation for each quality setting.
+// At 44.1 and 48 kHz a 2048 sample frame is about 45 ms, which suits full mixes.
+struct StretchSettings
+{
+    int frameLength;
+    int tolerance;
+    int decimation;
+};
+
+static StretchSettings getSettings(TimeStretchAudioSource::Quality quality)
+{
+    switch (quality)
+    {
+    case TimeStretchAudioSource::Quality::low:
+        return {1024, 256, 4};
+    case TimeStretchAudioSource::Quality::high:
+        return {2048, 512, 1};
+    case TimeStretchAudioSource::Quality::medium:
+    default:
+        return {2048, 384, 2};
+    }
+}
+
+// The largest settings of any quality, used to size the buffers once.
+static constexpr int maxFrameLength = 2048;
+static constexpr int maxTolerance = 512;
+static constexpr double minSpeed = 0.25;
+static constexpr double maxSpeed = 4.0;
+
+TimeStretchAudioSource::TimeStretchAudioSource(AudioSource *_input, bool deleteInputWhenDeleted, int _numberOfChannels)
+    : input(_input, deleteInputWhenDeleted),
+      numberOfChannels(_numberOfChannels)
+{
+    jassert(input.get() != nullptr);
+}
+
+TimeStretchAudioSource::~TimeStretchAudioSource()
+{
+    // Destructor for TimeStretchAudioSource class.
+}
+
+void TimeStretchAudioSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    // The input span a frame needs is largest at the top speed: the frame itself,
+    // the search range on both sides and the hops skipped between frames.
+    const auto maxHop = maxFrameLength / 2;
+    const auto inputCapacity = maxFrameLength + 4 * maxTolerance + (int)std::ceil(maxSpeed + 1.0) * maxHop;
+
+    inputBuffer.setSize(numberOfChannels, inputCapacity);
+    accumulator.setSize(numberOfChannels, maxFrameLength);
+    window.malloc(maxFrameLength);
+    transitionWindow.malloc(maxFrameLength);
+    reference.malloc(maxHop);
+    candidates.malloc(maxHop + 2 * maxTolerance);
+    correlation.malloc(2 * maxTolerance + 1);
+
+    input->prepareToPlay(samplesPerBlockExpected, sampleRate);
+    reset();
+}
+
+void TimeStretchAudioSource::releaseResources()
+{
+    input->releaseResources();
+    inputBuffer.setSize(numberOfChannels, 0);
+    accumulator.setSize(numberOfChannels, 0);
+    window.free();
+    transitionWindow.free();
+    reference.free();
+    candidates.free();
+    correlation.free();
+}
+
+void TimeStretchAudioSource::getNextAudioBlock(const AudioSourceChannelInfo &info)
+{
+    if (accumulator.getNumSamples() == 0)
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
+    int done = 0;
+
+    while (done < info.numSamples)
+    {
+        // Once the ready part of the output has been played, shift the overlap
+        // down and add the next frame on top of it.
+        if (outputReadPosition >= ready)
+        {
+            // The overlap is the last frame's falling half, a hop long. Just after a quality
+            // change it can be longer than the ready part, so the two may overlap.
+            for (int chan = 0; chan < numberOfChannels; ++chan)
+            {
+                auto *acc = accumulator.getWritePointer(chan);
+                std::memmove(acc, acc + ready, (size_t)hop * sizeof(float));
+                FloatVectorOperations::clear(acc + hop, accumulator.getNumSamples() - hop);
+            }
+
+            // A quality change takes effect with the next frame, carrying on from the same place in the
+            // input. That frame fades in over the old hop, so it adds up to one with the old frame's tail.
+            const auto fadeInLength = hop;
+
+            if (requestedQuality.load() != quality)
+            {
+                applyQuality();
+            }
+
+            processFrame(fadeInLength);
+            outputReadPosition = 0;
+        }
+
+        const auto num = jmin(info.numSamples - done, ready - outputReadPosition);
+
+        for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+        {
+            info.buffer->copyFrom(chan, info.startSample + done, accumulator,
+                                  jmin(chan, numberOfChannels - 1), outputReadPosition, num);
+        }
+
+        outputReadPosition += num;
+        done += num;
+    }
+}
+
+void TimeStretchAudioSource::setSpeed(double newSpeed)
+{
+    speed = jlimit(minSpeed, maxSpeed, newSpeed);
+}
+
+void TimeStretchAudioSource::setQuality(Quality newQuality)
+{
+    requestedQuality = newQuality;
+}
+
+TimeStretchAudioSource::Quality TimeStretchAudioSource::getQuality() const
+{
+    return requestedQuality.load();
+}
+
+void TimeStretchAudioSource::reset()
+{
+    // Set up for the requested quality. Nothing here allocates, so it is safe on the audio thread.
+    applyQuality();
+
+    // Start with silence before the first input sample so the first search has room to move back,
+    // at any quality.
+    inputBuffer.clear();
+    inputStart = -maxTolerance;
+    inputCount = maxTolerance;
+    nominalPosition = 0.0;
+    previousFrameStart = 0;
+    previousTailStart = 0;
+    isFirstFrame = true;
+
+    accumulator.clear();
+    ready = hop;
+    outputReadPosition = hop;
+}
+
+double TimeStretchAudioSource::getLatency() const
+{
+    // The ready output crossfades from the previous frame's tail to the last frame, each playing its
+    // input at normal speed. What is heard is in between, weighted by the last frame's rising window.
+    if (isFirstFrame)
+    {
+        return 0.0;
+    }
+
+    const auto rising = 0.5 - 0.5 * std::cos(MathConstants<double>::pi * outputReadPosition / ready);
+    const auto heardPosition = (double)(previousTailStart + outputReadPosition) + rising * (double)(previousFrameStart - previousTailStart);
+    return (double)(inputStart + inputCount) - heardPosition;
+}
+
+void TimeStretchAudioSource::applyQuality()
+{
+    // Switch the frame settings and window to the requested quality, without touching the buffers.
+    quality = requestedQuality.load();
+    const auto settings = getSettings(quality);
+    frameLength = settings.frameLength;
+    hop = frameLength / 2;
+    tolerance = settings.tolerance;
+    decimation = settings.decimation;
+
+    // A periodic Hann window sums to one when overlapped by half a frame.
+    for (int i = 0; i < frameLength; ++i)
+    {
+        window[i] = 0.5f - 0.5f * std::cos(MathConstants<float>::twoPi * (float)i / (float)frameLength);
+    }
+}
+
+void TimeStretchAudioSource::processFrame(int fadeInLength)
+{
+    // Take the next frame from near its nominal position, lined up with the previous one.
+    // Frames are ready samples apart, which is the hop except just after a quality change.
+    const auto frameSize = fadeInLength + hop;
+    const auto nominal = (int64)std::floor(nominalPosition);
+    const auto natural = previousFrameStart + ready;
+
+    ensureInput(jmax(nominal + tolerance + frameSize, natural + hop));
+
+    const auto frameStart = isFirstFrame ? nominal : findBestFrameStart(natural, nominal);
+    const auto offset = (int)(frameStart - inputStart);
+    const float *frameWindow = window.getData();
+
+    // After a quality change the frame rises like the old window and falls like the new one.
+    if (fadeInLength != hop)
+    {
+        for (int i = 0; i < frameSize; ++i)
+        {
+            const auto phase = i < fadeInLength ? (float)i / (float)fadeInLength : 1.0f + (float)(i - fadeInLength) / (float)hop;
+            transitionWindow[i] = 0.5f - 0.5f * std::cos(MathConstants<float>::pi * phase);
+        }
+
+        frameWindow = transitionWindow.getData();
+    }
+
+    for (int chan = 0; chan < numberOfChannels; ++chan)
+    {
+        FloatVectorOperations::addWithMultiply(accumulator.getWritePointer(chan),
+                                               inputBuffer.getReadPointer(chan, offset),
+                                               frameWindow,
+                                               frameSize);
+    }
+
+    previousTailStart = isFirstFrame ? frameStart : natural;
+    previousFrameStart = frameStart;
+    isFirstFrame = false;
+    ready = fadeInLength;
+    nominalPosition += fadeInLength * speed;
+
+    // Keep only what the next frame and its search can still use, with room for the widest search
+    // in case the quality changes.
+    discardInputBefore(jmin(frameStart + ready, (int64)std::floor(nominalPosition) - maxTolerance));
+}
+
+int64 TimeStretchAudioSource::findBestFrameStart(int64 naturalStart, int64 nominalStart)
+{
+    // Compare the natural continuation of the previous frame with every candidate
+    // position in the search range, and pick the one that correlates best.
+    const auto referenceLength = hop / decimation;
+    const auto numOffsets = 2 * tolerance / decimation + 1;
+    const auto searchStart = nominalStart - tolerance;
+
+    getDownmix(naturalStart, hop, reference.getData());
+    getDownmix(searchStart, 2 * tolerance + hop, candidates.getData());
+
+    // Accumulate one reference sample into all offsets at a time, which keeps the
+    // inner loop a contiguous multiply-add that FloatVectorOperations vectorises.
+    FloatVectorOperations::clear(correlation.getData(), numOffsets);
+
+    for (int i = 0; i < referenceLength; ++i)
+    {
+        FloatVectorOperations::addWithMultiply(correlation.getData(), candidates.getData() + i, reference[i], numOffsets);
+    }
+
+    int best = numOffsets / 2;
+
+    for (int i = 0; i < numOffsets; ++i)
+    {
+        if (correlation[i] > correlation[best])
+        {
+            best = i;
+        }
+    }
+
+    return searchStart + best * decimation;
+}
+
+void TimeStretchAudioSource::ensureInput(int64 endPosition)
+{
+    // Pull more input from the source if the buffer doesn't reach endPosition yet.
+    const auto needed = (int)(endPosition - (inputStart + inputCount));
+
+    if (needed > 0)
+    {
+        jassert(inputCount + needed <= inputBuffer.getNumSamples());
+        input->getNextAudioBlock(AudioSourceChannelInfo(&inputBuffer, inputCount, needed));
+        inputCount += needed;
+    }
+}
+
+void TimeStretchAudioSource::discardInputBefore(int64 position)
+{
+    // Move the input that is still needed to the front of the buffer.
+    const auto num = (int)jlimit((int64)0, (int64)inputCount, position - inputStart);
+
+    if (num == 0)
+    {
+        return;
+    }
+
+    for (int chan = 0; chan < numberOfChannels; ++chan)
+    {
+        auto *data = inputBuffer.getWritePointer(chan);
+        std::memmove(data, data + num, (size_t)(inputCount - num) * sizeof(float));
+    }
+
+    inputStart += num;
+    inputCount -= num;
+}
+
+void TimeStretchAudioSource::getDownmix(int64 start, int length, float *dest)
+{
+    // Sums the channels and averages every decimation samples, giving length / decimation values.
+    const auto offset = (int)(start - inputStart);
+    const auto numOut = length / decimation;
+
+    FloatVectorOperations::clear(dest, numOut);
+
+    for (int chan = 0; chan < numberOfChannels; ++chan)
+    {
+        const auto *data = inputBuffer.getReadPointer(chan, offset);
+
+        if (decimation == 1)
+        {
+            FloatVectorOperations::add(dest, data, numOut);
+        }
+        else
+        {
+            for (int i = 0; i < numOut; ++i)
+            {
+                for (int j = 0; j < decimation; ++j)
+                {
+                    dest[i] += data[i * decimation + j];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,140 @@
+/*
+	==============================================================================
+
+	TimeStretchAudioSource.h
+	Created: 18 Oct 2026 2:14:51pm
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+	Changes the tempo of its input without changing the pitch, for the decks' key lock.
+
+	This uses WSOLA (waveform similarity overlap-add). Windowed frames are taken from
+	the input every speed * hop samples and overlap-added every hop samples. Each frame
+	is moved by up to a search tolerance so that it lines up with the natural
+	continuation of the previous frame, which avoids the phasing of plain overlap-add.
+	The cross-correlation for the search runs over every candidate offset at once with
+	FloatVectorOperations, so the inner loop is vectorised on SSE and NEON.
+
+	The quality setting trades CPU for fewer artefacts by changing the frame size,
+	the search range and how much the search signal is decimated. A change applies
+	from the next frame on, carrying on from the same input position: that frame
+	fades in over the old hop and out over the new one, so the overlap still adds up
+	to one and nothing is dropped or repeated.
+*/
+class TimeStretchAudioSource : public AudioSource
+{
+public:
+	/** The quality/CPU setting of the stretcher. */
+	enum class Quality
+	{
+		low,	// Short frames and a coarse search, cheapest
+		medium, // Longer frames and a half-rate search
+		high	// Long frames and a full-rate search
+	};
+
+	/**
+		Constructor.
+		@param input The source to stretch.
+		@param deleteInputWhenDeleted Whether this object takes ownership of the input.
+		@param numberOfChannels The number of channels to process.
+	*/
+	TimeStretchAudioSource(AudioSource *input, bool deleteInputWhenDeleted, int numberOfChannels = 2);
+
+	/**
+		Destructor.
+	*/
+	~TimeStretchAudioSource() override;
+
+	/**
+		Allocates the buffers for the largest quality setting, so changing quality never allocates.
+		@param samplesPerBlockExpected The number of samples per block expected.
+		@param sampleRate The sample rate of the audio.
+	*/
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+
+	/**
+		Frees the buffers.
+	*/
+	void releaseResources() override;
+
+	/**
+		Produces the next block of stretched audio, pulling as much input as it needs.
+		@param bufferToFill The buffer to be filled with audio data.
+	*/
+	void getNextAudioBlock(const AudioSourceChannelInfo &bufferToFill) override;
+
+	/**
+		Sets the tempo ratio. Only call this from the audio thread.
+		@param speed The ratio of input consumed to output produced, clamped to 0.25 - 4.0.
+	*/
+	void setSpeed(double speed);
+
+	/**
+		Sets the quality setting. Can be called from any thread; it is applied from the next frame.
+		@param quality The new quality setting.
+	*/
+	void setQuality(Quality quality);
+
+	/**
+		Returns the quality setting.
+	*/
+	Quality getQuality() const;
+
+	/**
+		Forgets all buffered input and output. Call this from the audio thread when
+		the stretcher is switched back in, so stale audio is never played.
+	*/
+	void reset();
+
+	/**
+		Returns how far the input already pulled runs ahead of the next output sample: the rest
+		of the frame being played, the next frame and its search range. Only call this from the audio thread.
+		@return The latency in input samples.
+	*/
+	double getLatency() const;
+
+private:
+	void applyQuality();
+	void processFrame(int fadeInLength);
+	int64 findBestFrameStart(int64 naturalStart, int64 nominalStart);
+	void ensureInput(int64 endPosition);
+	void discardInputBefore(int64 position);
+	void getDownmix(int64 start, int length, float *dest);
+
+	OptionalScopedPointer<AudioSource> input; // The source being stretched
+	const int numberOfChannels;				  // Number of channels that are processed
+	std::atomic<Quality> requestedQuality{Quality::medium};
+
+	// Settings of the current quality, only changed in applyQuality()
+	Quality quality = Quality::medium; // Quality the buffers are set up for
+	int frameLength = 0;			   // Length of a windowed frame
+	int hop = 0;					   // Output hop, half a frame
+	int tolerance = 0;				   // How far a frame may move to line up with the previous one
+	int decimation = 1;				   // Step between the samples used by the search
+
+	double speed = 1.0;			   // Ratio of input to output
+	AudioBuffer<float> inputBuffer; // Input samples from inputStart onwards
+	int64 inputStart = 0;		   // Stream position of the first sample in inputBuffer
+	int inputCount = 0;			   // Number of valid samples in inputBuffer
+	double nominalPosition = 0.0;  // Where the next frame would start without the search
+	int64 previousFrameStart = 0;  // Where the last frame was taken from
+	int64 previousTailStart = 0;   // Where the tail of the frame before it, under the ready output, was taken from
+	bool isFirstFrame = true;	   // Whether there is a previous frame to line up with
+
+	AudioBuffer<float> accumulator; // Overlap-added output, the first ready samples are ready
+	int ready = 0;					// Samples of the accumulator that are ready, and the spacing to the next frame
+	int outputReadPosition = 0;		// How much of the ready output has been played
+	HeapBlock<float> window;		// Hann window of the current frame length
+	HeapBlock<float> transitionWindow; // Window of the first frame after a quality change
+	HeapBlock<float> reference;		// Decimated downmix of the natural continuation
+	HeapBlock<float> candidates;	// Decimated downmix of the search region
+	HeapBlock<float> correlation;	// Cross-correlation at each candidate offset
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimeStretchAudioSource)
+};
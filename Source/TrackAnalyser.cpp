@@ -0,0 +1,1082 @@
+/*
+  ==============================================================================
+
+    TrackAnalyser.cpp
+    Created: 20 Oct 2026 10:15:22am
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "TrackAnalyser.h"
+
+// Bump this when the analysis changes, so stored results are worked out again.
+static constexpr int analysisVersion = 3;
+
+// Resolution of the onset envelope.
+static constexpr double envelopeFramesPerSecond = 200.0;
+
+// Tempos are reported in this range; anything else is halved or doubled into it.
+static constexpr double minimumBpm = 70.0;
+static constexpr double maximumBpm = 180.0;
+
+// Bass onsets mark the downbeat.
+static constexpr float bassCutoff = 150.0f;
+
+// The chromagram is taken from FFTs of 8192 samples, over the notes from A1 to A6.
+static constexpr int chromaFftOrder = 13;
+static constexpr float lowestChromaFrequency = 55.0f;
+static constexpr float highestChromaFrequency = 1760.0f;
+
+// Loudness is measured in EBU R128 blocks of 400 ms and short-term windows of 3 s, every 100 ms.
+static constexpr double loudnessStepSeconds = 0.1;
+static constexpr int stepsPerBlock = 4;
+static constexpr int stepsPerShortTerm = 30;
+
+// The gates of EBU R128: blocks below -70 LUFS are ignored, and so are blocks 10 LU (20 LU for the
+// loudness range) below the mean of the rest.
+static constexpr double absoluteGate = -70.0;
+static constexpr double integratedRelativeGate = -10.0;
+static constexpr double rangeRelativeGate = -20.0;
+
+// True peak is the peak of the signal oversampled by an interpolator with this many taps per phase.
+static constexpr int truePeakTaps = 12;
+
+// Krumhansl-Kessler key profiles, starting from the tonic.
+static constexpr float majorProfile[12] = {6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f};
+static constexpr float minorProfile[12] = {6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f};
+
+//==============================================================================
+bool TrackAnalysis::hasBeatGrid() const
+{
+    return bpm > 0.0 && beatPeriodSeconds > 0.0;
+}
+
+double TrackAnalysis::getBeatTime(double beat) const
+{
+    return downbeatSeconds + beat * beatPeriodSeconds;
+}
+
+double TrackAnalysis::getBeatAt(double seconds) const
+{
+    return hasBeatGrid() ? (seconds - downbeatSeconds) / beatPeriodSeconds : 0.0;
+}
+
+bool TrackAnalysis::hasKey() const
+{
+    return key >= 0 && key < 24;
+}
+
+String TrackAnalysis::getKeyName() const
+{
+    static const char *const noteNames[12] = {"C", "Db", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B"};
+    return hasKey() ? String(noteNames[key % 12]) + (key >= 12 ? "m" : "") : String();
+}
+
+int TrackAnalysis::getCamelotNumber() const
+{
+    // Going round the wheel is going up in fifths; minor keys share the number of their relative major.
+    if (!hasKey())
+    {
+        return 0;
+    }
+
+    const auto major = key < 12 ? key : (key + 3) % 12;
+    return (major * 7 + 7) % 12 + 1;
+}
+
+String TrackAnalysis::getCamelot() const
+{
+    return hasKey() ? String(getCamelotNumber()) + (key >= 12 ? "A" : "B") : String();
+}
+
+bool TrackAnalysis::hasLoudness() const
+{
+    return loudness < 0.0;
+}
+
+float TrackAnalysis::getAutoGain(double targetLoudness) const
+{
+    // Bring the track to the target, but only boost as far as the peaks stay below -1 dBTP.
+    if (!hasLoudness())
+    {
+        return 1.0f;
+    }
+
+    auto gainDecibels = targetLoudness - loudness;
+
+    if (gainDecibels > 0.0)
+    {
+        gainDecibels = jmin(gainDecibels, jmax(0.0, -1.0 - truePeak));
+    }
+
+    return jlimit(0.25f, 4.0f, Decibels::decibelsToGain((float)gainDecibels));
+}
+
+var TrackAnalysis::toVar() const
+{
+    auto *object = new DynamicObject();
+    object->setProperty("version", analysisVersion);
+    object->setProperty("bpm", bpm);
+    object->setProperty("downbeat", downbeatSeconds);
+    object->setProperty("beatPeriod", beatPeriodSeconds);
+    object->setProperty("confidence", confidence);
+    object->setProperty("key", key);
+    object->setProperty("loudness", loudness);
+    object->setProperty("truePeak", truePeak);
+    object->setProperty("loudnessRange", loudnessRange);
+    return var(object);
+}
+
+TrackAnalysis TrackAnalysis::fromVar(const var &stored)
+{
+    TrackAnalysis analysis;
+    analysis.bpm = stored.getProperty("bpm", 0.0);
+    analysis.downbeatSeconds = stored.getProperty("downbeat", 0.0);
+    analysis.beatPeriodSeconds = stored.getProperty("beatPeriod", 0.0);
+    analysis.confidence = (float)(double)stored.getProperty("confidence", 0.0);
+    analysis.key = stored.getProperty("key", -1);
+    analysis.loudness = stored.getProperty("loudness", 0.0);
+    analysis.truePeak = stored.getProperty("truePeak", 0.0);
+    analysis.loudnessRange = stored.getProperty("loudnessRange", 0.0);
+    return analysis;
+}
+
+//==============================================================================
+// Turns blocks of samples into an onset envelope and finds the beat grid in it.
+class BeatTracker
+{
+public:
+    BeatTracker(double _sampleRate, int maximumBlockSize) : sampleRate(_sampleRate)
+    {
+        // Each envelope frame covers a whole number of samples.
+        hopSize = jmax(1, roundToInt(sampleRate / envelopeFramesPerSecond));
+        bassFilter.setType(dsp::LinkwitzRileyFilterType::lowpass);
+        bassFilter.setCutoffFrequency(bassCutoff);
+        bassFilter.prepare({sampleRate, (uint32)maximumBlockSize, 1});
+    }
+
+    void addSamples(const float *monoData, int numSamples)
+    {
+        // Add up the energy of the whole signal and the bass for each frame.
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float bass, rest;
+            bassFilter.processSample(0, monoData[i], bass, rest);
+            frameEnergy += monoData[i] * monoData[i];
+            frameBassEnergy += bass * bass;
+
+            if (++frameLength == hopSize)
+            {
+                energies.push_back(frameEnergy);
+                bassEnergies.push_back(frameBassEnergy);
+                frameEnergy = frameBassEnergy = 0.0f;
+                frameLength = 0;
+            }
+        }
+    }
+
+    void finish(TrackAnalysis &analysis) const
+    {
+        const auto fps = sampleRate / hopSize;
+        const auto shortestLag = (int)std::floor(fps * 60.0 / maximumBpm);
+        const auto longestLag = (int)std::ceil(fps * 60.0 / minimumBpm);
+        const auto numLags = longestLag * 2 + 3; // Room for the lag of half the tempo
+        const auto numFrames = (int)energies.size();
+
+        if (numFrames < numLags * 4)
+        {
+            return;
+        }
+
+        // Onsets are rises in log energy, of the whole signal and of the bass.
+        std::vector<float> onsets((size_t)numFrames, 0.0f), bassOnsets((size_t)numFrames, 0.0f);
+
+        for (int i = 1; i < numFrames; ++i)
+        {
+            const auto rise = std::log(1.0e-6f + energies[(size_t)i]) - std::log(1.0e-6f + energies[(size_t)i - 1]);
+            const auto bassRise = std::log(1.0e-6f + bassEnergies[(size_t)i]) - std::log(1.0e-6f + bassEnergies[(size_t)i - 1]);
+            bassOnsets[(size_t)i] = jmax(0.0f, bassRise);
+            onsets[(size_t)i] = jmax(0.0f, rise) + bassOnsets[(size_t)i];
+        }
+
+        // Autocorrelate the envelope without its mean, all lags at once for each frame.
+        std::vector<float> centred(onsets);
+        float mean = 0.0f;
+
+        for (auto onset : onsets)
+        {
+            mean += onset;
+        }
+
+        FloatVectorOperations::add(centred.data(), -mean / numFrames, numFrames);
+
+        std::vector<float> correlation((size_t)numLags, 0.0f);
+
+        for (int i = 0; i + numLags < numFrames; ++i)
+        {
+            FloatVectorOperations::addWithMultiply(correlation.data(), centred.data() + i, centred[(size_t)i], numLags);
+        }
+
+        // Score each tempo in the range with its own lag and the lag of half the tempo,
+        // which makes the score favour the beat rather than the off-beat.
+        std::vector<float> scores((size_t)longestLag + 2, 0.0f);
+        auto bestLag = shortestLag;
+        float scoreSum = 0.0f;
+
+        for (int lag = shortestLag; lag <= longestLag + 1; ++lag)
+        {
+            scores[(size_t)lag] = correlation[(size_t)lag] + 0.5f * correlation[(size_t)lag * 2];
+
+            if (lag <= longestLag)
+            {
+                scoreSum += scores[(size_t)lag];
+
+                if (scores[(size_t)lag] > scores[(size_t)bestLag])
+                {
+                    bestLag = lag;
+                }
+            }
+        }
+
+        const auto best = scores[(size_t)bestLag];
+
+        if (best <= 0.0f)
+        {
+            return;
+        }
+
+        // Refine the lag between frames with a parabola through the peak.
+        double period = bestLag;
+
+        if (bestLag > shortestLag && bestLag < longestLag)
+        {
+            const auto before = scores[(size_t)bestLag - 1];
+            const auto after = scores[(size_t)bestLag + 1];
+            const auto curvature = before - 2.0f * best + after;
+
+            if (curvature < 0.0f)
+            {
+                period += 0.5 * (before - after) / curvature;
+            }
+        }
+
+        const auto meanScore = scoreSum / (float)(longestLag - shortestLag + 1);
+        analysis.confidence = jlimit(0.0f, 1.0f, (best - meanScore) / best);
+
+        // The beat phase is the offset where the onsets line up best with the grid.
+        const auto beatPhase = findStrongestPhase(onsets, period);
+
+        // The downbeat is the beat of the bar with the strongest bass onsets.
+        auto downbeatFrame = beatPhase;
+        float strongestBar = -1.0f;
+
+        for (int beat = 0; beat < 4; ++beat)
+        {
+            const auto strength = sumAlongGrid(bassOnsets, beatPhase + beat * period, period * 4.0);
+
+            if (strength > strongestBar)
+            {
+                strongestBar = strength;
+                downbeatFrame = beatPhase + beat * period;
+            }
+        }
+
+        analysis.beatPeriodSeconds = period / fps;
+        analysis.bpm = 60.0 / analysis.beatPeriodSeconds;
+        analysis.downbeatSeconds = downbeatFrame / fps;
+    }
+
+private:
+    static float sumAlongGrid(const std::vector<float> &values, double start, double step)
+    {
+        // Add up the values at every step of a grid.
+        float sum = 0.0f;
+
+        for (auto position = start; position < (double)values.size(); position += step)
+        {
+            sum += values[(size_t)position];
+        }
+
+        return sum;
+    }
+
+    static double findStrongestPhase(const std::vector<float> &values, double period)
+    {
+        // Try every whole-frame offset within a period.
+        auto bestPhase = 0.0;
+        float bestSum = -1.0f;
+
+        for (int phase = 0; phase < (int)std::ceil(period); ++phase)
+        {
+            const auto sum = sumAlongGrid(values, phase, period);
+
+            if (sum > bestSum)
+            {
+                bestSum = sum;
+                bestPhase = phase;
+            }
+        }
+
+        return bestPhase;
+    }
+
+    double sampleRate;								// Sample rate of the track
+    int hopSize = 1;								// Samples per envelope frame
+    float frameEnergy = 0.0f;						// Energy of the current frame
+    float frameBassEnergy = 0.0f;					// Bass energy of the current frame
+    int frameLength = 0;							// Samples in the current frame so far
+    std::vector<float> energies;					// Energy of each frame
+    std::vector<float> bassEnergies;				// Bass energy of each frame
+    dsp::LinkwitzRileyFilter<float> bassFilter;		// Splits off the bass
+};
+
+//==============================================================================
+// Builds a chromagram from FFT frames and matches it against the major and minor key profiles.
+class KeyDetector
+{
+public:
+    KeyDetector(double sampleRate)
+        : fft(chromaFftOrder),
+          window((size_t)fft.getSize()),
+          frame((size_t)fft.getSize()),
+          fftData((size_t)fft.getSize() * 2),
+          binPitchClasses((size_t)fft.getSize() / 2, -1)
+    {
+        // Precompute the window and which pitch class each FFT bin belongs to.
+        const auto size = fft.getSize();
+        dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t)size, dsp::WindowingFunction<float>::hann, false);
+
+        for (int bin = 1; bin < size / 2; ++bin)
+        {
+            const auto frequency = (float)(bin * sampleRate / size);
+
+            if (frequency >= lowestChromaFrequency && frequency <= highestChromaFrequency)
+            {
+                const auto note = roundToInt(69.0f + 12.0f * std::log2(frequency / 440.0f));
+                binPitchClasses[(size_t)bin] = note % 12;
+                firstBin = firstBin == 0 ? bin : firstBin;
+                lastBin = bin;
+            }
+        }
+    }
+
+    void addSamples(const float *monoData, int numSamples)
+    {
+        // Collect whole frames and analyse each one as it fills up.
+        for (int offset = 0; offset < numSamples;)
+        {
+            const auto num = jmin(numSamples - offset, (int)frame.size() - frameLength);
+            FloatVectorOperations::copy(frame.data() + frameLength, monoData + offset, num);
+            frameLength += num;
+            offset += num;
+
+            if (frameLength == (int)frame.size())
+            {
+                analyseFrame();
+                frameLength = 0;
+            }
+        }
+    }
+
+    void finish(TrackAnalysis &analysis) const
+    {
+        // Pick the key whose profile correlates best with the chromagram of the whole track.
+        float best = 0.0f;
+
+        for (int tonic = 0; tonic < 12; ++tonic)
+        {
+            const auto majorScore = correlate(majorProfile, tonic);
+            const auto minorScore = correlate(minorProfile, tonic);
+
+            if (majorScore > best)
+            {
+                best = majorScore;
+                analysis.key = tonic;
+            }
+
+            if (minorScore > best)
+            {
+                best = minorScore;
+                analysis.key = tonic + 12;
+            }
+        }
+    }
+
+private:
+    void analyseFrame()
+    {
+        // Window the frame, take its magnitude spectrum and fold the bins into pitch classes.
+        FloatVectorOperations::multiply(fftData.data(), frame.data(), window.data(), (int)frame.size());
+        FloatVectorOperations::clear(fftData.data() + frame.size(), (int)frame.size());
+        fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+        std::array<float, 12> frameChroma{};
+
+        for (int bin = firstBin; bin <= lastBin; ++bin)
+        {
+            const auto pitchClass = binPitchClasses[(size_t)bin];
+
+            if (pitchClass >= 0)
+            {
+                frameChroma[(size_t)pitchClass] += fftData[(size_t)bin];
+            }
+        }
+
+        // Each frame counts the same, so loud passages don't decide the key on their own.
+        const auto loudest = *std::max_element(frameChroma.begin(), frameChroma.end());
+
+        if (loudest > 0.0f)
+        {
+            for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+            {
+                chroma[(size_t)pitchClass] += frameChroma[(size_t)pitchClass] / loudest;
+            }
+        }
+    }
+
+    float correlate(const float (&profile)[12], int tonic) const
+    {
+        // Pearson correlation between the chromagram and a profile rotated to the tonic.
+        float chromaMean = 0.0f, profileMean = 0.0f;
+
+        for (int i = 0; i < 12; ++i)
+        {
+            chromaMean += chroma[(size_t)i] / 12.0f;
+            profileMean += profile[i] / 12.0f;
+        }
+
+        float covariance = 0.0f, chromaVariance = 0.0f, profileVariance = 0.0f;
+
+        for (int i = 0; i < 12; ++i)
+        {
+            const auto c = chroma[(size_t)((tonic + i) % 12)] - chromaMean;
+            const auto p = profile[i] - profileMean;
+            covariance += c * p;
+            chromaVariance += c * c;
+            profileVariance += p * p;
+        }
+
+        return chromaVariance > 0.0f ? covariance / std::sqrt(chromaVariance * profileVariance) : 0.0f;
+    }
+
+    dsp::FFT fft;						// Transforms the frames
+    std::vector<float> window;			// Hann window
+    std::vector<float> frame;			// Samples of the frame being collected
+    std::vector<float> fftData;			// Working buffer for the FFT
+    std::vector<int> binPitchClasses;	// Pitch class of each bin, -1 outside the chroma range
+    int firstBin = 0;					// First bin in the chroma range
+    int lastBin = 0;					// Last bin in the chroma range
+    int frameLength = 0;				// Samples in the current frame so far
+    std::array<float, 12> chroma{};		// Chromagram of the whole track, from C
+};
+
+//==============================================================================
+// Measures integrated loudness, loudness range and true peak as in EBU R128 and ITU-R BS.1770.
+class LoudnessMeter
+{
+public:
+    LoudnessMeter(double sampleRate, int maximumBlockSize)
+    {
+        stepLength = jmax(1, roundToInt(sampleRate * loudnessStepSeconds));
+
+        // The K-weighting filter is a high shelf for the head followed by a high-pass,
+        // with the coefficients of BS.1770 worked out for the track's sample rate.
+        {
+            const auto k = std::tan(MathConstants<double>::pi * 1681.974450955533 / sampleRate);
+            const auto q = 0.7071752369554196;
+            const auto vh = std::pow(10.0, 3.999843853973347 / 20.0);
+            const auto vb = std::pow(vh, 0.4996667741545416);
+            const auto a0 = 1.0 + k / q + k * k;
+            shelf = {(vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0,
+                     2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+        }
+
+        {
+            const auto k = std::tan(MathConstants<double>::pi * 38.13547087602444 / sampleRate);
+            const auto q = 0.5003270373238773;
+            const auto a0 = 1.0 + k / q + k * k;
+            highPass = {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+        }
+
+        // Oversample 4x below 96 kHz and 2x below 192 kHz, with a Hann-windowed sinc per phase.
+        oversampling = sampleRate < 96000.0 ? 4 : sampleRate < 192000.0 ? 2 : 1;
+
+        for (int phase = 0; phase < oversampling; ++phase)
+        {
+            auto &coefficients = truePeakPhases[(size_t)phase];
+
+            for (int tap = 0; tap < truePeakTaps; ++tap)
+            {
+                const auto distance = tap - (truePeakTaps / 2 - 1) - (double)phase / oversampling;
+                const auto x = MathConstants<double>::pi * distance;
+                const auto sinc = distance == 0.0 ? 1.0 : std::sin(x) / x;
+                const auto window = 0.5 + 0.5 * std::cos(MathConstants<double>::pi * distance / (truePeakTaps / 2));
+                coefficients[(size_t)tap] = (float)(sinc * window);
+            }
+        }
+
+        for (auto &history : histories)
+        {
+            history.assign((size_t)(truePeakTaps - 1 + maximumBlockSize), 0.0f);
+        }
+
+        phaseOutput.resize((size_t)maximumBlockSize);
+    }
+
+    void addSamples(const float *const *channels, int numChannels, int numSamples)
+    {
+        // Add up the K-weighted energy of each 100 ms step, channel by channel.
+        for (int offset = 0; offset < numSamples;)
+        {
+            const auto num = jmin(numSamples - offset, stepLength - stepFill);
+
+            if (numChannels == 2)
+            {
+                stepEnergy += filterPair(channels[0] + offset, channels[1] + offset, num);
+            }
+            else
+            {
+                for (int chan = 0; chan < numChannels; ++chan)
+                {
+                    stepEnergy += filterChannel(chan, channels[chan] + offset, num);
+                }
+            }
+
+            stepFill += num;
+            offset += num;
+
+            if (stepFill == stepLength)
+            {
+                stepEnergies.push_back((float)(stepEnergy / stepLength));
+                stepEnergy = 0.0;
+                stepFill = 0;
+            }
+        }
+
+        for (int chan = 0; chan < numChannels; ++chan)
+        {
+            findTruePeak(chan, channels[chan], numSamples);
+        }
+    }
+
+    void finish(TrackAnalysis &analysis) const
+    {
+        // The integrated loudness is the mean energy of the 400 ms blocks that pass both gates.
+        const auto blocks = getWindowLoudnesses(stepsPerBlock);
+        const auto integrated = getMeanLoudness(blocks, getMeanLoudness(blocks, absoluteGate) + integratedRelativeGate);
+
+        if (integrated < 0.0)
+        {
+            analysis.loudness = integrated;
+            analysis.truePeak = Decibels::gainToDecibels(peak, -100.0f);
+        }
+
+        // The range is the spread from the 10th to the 95th percentile of the gated short-term loudness.
+        // As in EBU Tech 3342, the relative gate is 20 LU below the mean of the windows above the absolute gate.
+        const auto shortTerm = getWindowLoudnesses(stepsPerShortTerm);
+        const auto rangeGate = getMeanLoudness(shortTerm, absoluteGate) + rangeRelativeGate;
+        std::vector<double> gated;
+
+        for (const auto value : shortTerm)
+        {
+            if (value > absoluteGate && value > rangeGate)
+            {
+                gated.push_back(value);
+            }
+        }
+
+        if (!gated.empty())
+        {
+            std::sort(gated.begin(), gated.end());
+            const auto last = (double)(gated.size() - 1);
+            analysis.loudnessRange = gated[(size_t)std::round(last * 0.95)] - gated[(size_t)std::round(last * 0.1)];
+        }
+    }
+
+private:
+    // Biquad coefficients b0, b1, b2, a1, a2.
+    using Coefficients = std::array<double, 5>;
+
+    double filterChannel(int chan, const float *data, int numSamples)
+    {
+        // Run both K-weighting stages and return the sum of squares. The filters are recursive,
+        // so this is a plain loop over the samples in transposed direct form II.
+        const auto c = (size_t)chan;
+        double energy = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double x = data[i];
+            const auto y = shelf[0] * x + states[0][c];
+            states[0][c] = shelf[1] * x - shelf[3] * y + states[1][c];
+            states[1][c] = shelf[2] * x - shelf[4] * y;
+
+            const auto z = highPass[0] * y + states[2][c];
+            states[2][c] = highPass[1] * y - highPass[3] * z + states[3][c];
+            states[3][c] = highPass[2] * y - highPass[4] * z;
+
+            energy += z * z;
+        }
+
+        return energy;
+    }
+
+    double filterPair(const float *left, const float *right, int numSamples)
+    {
+        // The same filters for both channels at once. The recursion can't be split across
+        // samples, but the channels are independent, so every line runs on a register
+        // holding a left and a right value.
+        using Register = dsp::SIMDRegister<double>;
+        static_assert(Register::SIMDNumElements == 2, "A register holds one sample of each channel");
+
+        const auto b0 = Register::expand(shelf[0]), b1 = Register::expand(shelf[1]), b2 = Register::expand(shelf[2]);
+        const auto a1 = Register::expand(shelf[3]), a2 = Register::expand(shelf[4]);
+        const auto d0 = Register::expand(highPass[0]), d1 = Register::expand(highPass[1]), d2 = Register::expand(highPass[2]);
+        const auto c1 = Register::expand(highPass[3]), c2 = Register::expand(highPass[4]);
+
+        auto s0 = Register::fromRawArray(states[0].data()), s1 = Register::fromRawArray(states[1].data());
+        auto s2 = Register::fromRawArray(states[2].data()), s3 = Register::fromRawArray(states[3].data());
+        auto energy = Register::expand(0.0);
+        alignas(16) double pair[2];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            pair[0] = left[i];
+            pair[1] = right[i];
+            const auto x = Register::fromRawArray(pair);
+
+            const auto y = b0 * x + s0;
+            s0 = b1 * x - a1 * y + s1;
+            s1 = b2 * x - a2 * y;
+
+            const auto z = d0 * y + s2;
+            s2 = d1 * y - c1 * z + s3;
+            s3 = d2 * y - c2 * z;
+
+            energy += z * z;
+        }
+
+        s0.copyToRawArray(states[0].data());
+        s1.copyToRawArray(states[1].data());
+        s2.copyToRawArray(states[2].data());
+        s3.copyToRawArray(states[3].data());
+        return energy.sum();
+    }
+
+    void findTruePeak(int chan, const float *data, int numSamples)
+    {
+        // Each phase of the interpolator is a sum of shifted copies of the input, so it is
+        // worked out a whole block at a time with FloatVectorOperations.
+        auto &history = histories[(size_t)chan];
+        auto *input = history.data() + truePeakTaps - 1;
+        FloatVectorOperations::copy(input, data, numSamples);
+
+        const auto range = FloatVectorOperations::findMinAndMax(data, numSamples);
+        peak = jmax(peak, -range.getStart(), range.getEnd());
+
+        for (int phase = 1; phase < oversampling; ++phase)
+        {
+            const auto &coefficients = truePeakPhases[(size_t)phase];
+            FloatVectorOperations::copyWithMultiply(phaseOutput.data(), input, coefficients[0], numSamples);
+
+            for (int tap = 1; tap < truePeakTaps; ++tap)
+            {
+                FloatVectorOperations::addWithMultiply(phaseOutput.data(), input - tap, coefficients[(size_t)tap], numSamples);
+            }
+
+            const auto phaseRange = FloatVectorOperations::findMinAndMax(phaseOutput.data(), numSamples);
+            peak = jmax(peak, -phaseRange.getStart(), phaseRange.getEnd());
+        }
+
+        // Keep the end of the block for the taps of the next one.
+        std::memmove(history.data(), history.data() + numSamples, (size_t)(truePeakTaps - 1) * sizeof(float));
+    }
+
+    std::vector<double> getWindowLoudnesses(int stepsPerWindow) const
+    {
+        // The loudness of every window of the given number of steps, one window per step.
+        std::vector<double> loudnesses;
+        double sum = 0.0;
+
+        for (size_t step = 0; step < stepEnergies.size(); ++step)
+        {
+            sum += stepEnergies[step];
+
+            if (step >= (size_t)stepsPerWindow)
+            {
+                sum -= stepEnergies[step - (size_t)stepsPerWindow];
+            }
+
+            if (step + 1 >= (size_t)stepsPerWindow)
+            {
+                loudnesses.push_back(toLoudness(jmax(0.0, sum) / stepsPerWindow));
+            }
+        }
+
+        return loudnesses;
+    }
+
+    static double getMeanLoudness(const std::vector<double> &loudnesses, double gate)
+    {
+        // Average the energy of the windows above both the absolute gate and the given one, 0 if there are none.
+        double sum = 0.0;
+        int count = 0;
+
+        for (const auto value : loudnesses)
+        {
+            if (value > absoluteGate && value > gate)
+            {
+                sum += toEnergy(value);
+                ++count;
+            }
+        }
+
+        return count > 0 ? toLoudness(sum / count) : 0.0;
+    }
+
+    static double toLoudness(double energy) { return energy > 0.0 ? -0.691 + 10.0 * std::log10(energy) : -1000.0; }
+    static double toEnergy(double loudness) { return std::pow(10.0, (loudness + 0.691) / 10.0); }
+
+    Coefficients shelf{};												// First K-weighting stage
+    Coefficients highPass{};											// Second K-weighting stage
+    alignas(16) std::array<std::array<double, 2>, 4> states{};			// Filter state, each line holding both channels
+    int stepLength = 1;													// Samples per 100 ms step
+    int stepFill = 0;													// Samples in the current step so far
+    double stepEnergy = 0.0;											// K-weighted energy of the current step
+    std::vector<float> stepEnergies;									// Mean square of each step, summed over the channels
+    int oversampling = 4;												// True peak oversampling factor
+    std::array<std::array<float, truePeakTaps>, 4> truePeakPhases{};	// Interpolator coefficients of each phase
+    std::array<std::vector<float>, 2> histories;						// Last taps of the previous block, then the block, per channel
+    std::vector<float> phaseOutput;										// One phase of the oversampled block
+    float peak = 0.0f;													// Highest true peak so far, as a gain
+};
+
+//==============================================================================
+// Mixes each block down to mono once and feeds it to every analysis.
+class AnalysisPipeline
+{
+public:
+    AnalysisPipeline(double sampleRate, int maximumBlockSize)
+        : beatTracker(sampleRate, maximumBlockSize), keyDetector(sampleRate), loudnessMeter(sampleRate, maximumBlockSize)
+    {
+        mono.setSize(1, maximumBlockSize);
+    }
+
+    void addSamples(const float *const *channels, int numChannels, int numSamples)
+    {
+        // Loudness is measured on the channels themselves, everything else on the mono mix.
+        loudnessMeter.addSamples(channels, numChannels, numSamples);
+
+        auto *monoData = mono.getWritePointer(0);
+        FloatVectorOperations::copyWithMultiply(monoData, channels[0], 1.0f / numChannels, numSamples);
+
+        for (int chan = 1; chan < numChannels; ++chan)
+        {
+            FloatVectorOperations::addWithMultiply(monoData, channels[chan], 1.0f / numChannels, numSamples);
+        }
+
+        beatTracker.addSamples(monoData, numSamples);
+        keyDetector.addSamples(monoData, numSamples);
+    }
+
+    TrackAnalysis finish() const
+    {
+        TrackAnalysis analysis;
+        beatTracker.finish(analysis);
+        keyDetector.finish(analysis);
+        loudnessMeter.finish(analysis);
+        return analysis;
+    }
+
+private:
+    BeatTracker beatTracker;		// Tempo and beat grid
+    KeyDetector keyDetector;		// Musical key
+    LoudnessMeter loudnessMeter;	// Loudness and true peak
+    AudioBuffer<float> mono;		// Mono mix of the block being analysed
+};
+
+//==============================================================================
+// Reads a track on a pool thread, analyses it and stores the result.
+class TrackAnalyser::AnalysisJob : public ThreadPoolJob
+{
+public:
+    AnalysisJob(WeakReference<TrackAnalyser> _owner,
+                AudioFormatManager &_formatManager,
+                const URL &_audioURL,
+                int64 _key,
+                std::shared_ptr<const DecodedTrack> _decoded,
+                const File &_targetFile)
+        : ThreadPoolJob("Analyse " + _audioURL.getFileName()),
+          owner(_owner),
+          formatManager(_formatManager),
+          audioURL(_audioURL),
+          key(_key),
+          decoded(std::move(_decoded)),
+          targetFile(_targetFile)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        std::unique_ptr<AnalysisPipeline> pipeline;
+        constexpr int chunkSize = 1 << 16;
+
+        // Decoded tracks are already in memory; anything else is read from disk.
+        if (decoded != nullptr && decoded->samples.getNumChannels() > 0)
+        {
+            const auto &samples = decoded->samples;
+            pipeline = std::make_unique<AnalysisPipeline>(decoded->sampleRate, chunkSize);
+
+            for (int pos = 0; pos < samples.getNumSamples() && !shouldExit(); pos += chunkSize)
+            {
+                const auto num = jmin(chunkSize, samples.getNumSamples() - pos);
+                const float *channels[] = {samples.getReadPointer(0, pos), samples.getReadPointer(samples.getNumChannels() - 1, pos)};
+                pipeline->addSamples(channels, jmin(2, samples.getNumChannels()), num);
+            }
+        }
+        else if (audioURL.isLocalFile())
+        {
+            std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(audioURL.getLocalFile()));
+
+            if (reader != nullptr && reader->lengthInSamples > 0 && reader->sampleRate > 0.0)
+            {
+                AudioBuffer<float> chunk(jlimit(1, 2, (int)reader->numChannels), chunkSize);
+                pipeline = std::make_unique<AnalysisPipeline>(reader->sampleRate, chunkSize);
+
+                for (int64 pos = 0; pos < reader->lengthInSamples && !shouldExit(); pos += chunkSize)
+                {
+                    const auto num = (int)jmin((int64)chunkSize, reader->lengthInSamples - pos);
+                    reader->read(&chunk, 0, num, pos, true, true);
+                    pipeline->addSamples(chunk.getArrayOfReadPointers(), chunk.getNumChannels(), num);
+                }
+            }
+        }
+
+        if (shouldExit())
+        {
+            return jobHasFinished;
+        }
+
+        // Tracks that couldn't be read are stored too, so they aren't tried again on every import.
+        const auto analysis = pipeline != nullptr ? pipeline->finish() : TrackAnalysis();
+
+        if (!targetFile.replaceWithText(JSON::toString(analysis.toVar())))
+        {
+            std::cout << "TrackAnalyser::Couldn't write " << targetFile.getFullPathName() << std::endl;
+        }
+
+        MessageManager::callAsync([weakOwner = owner, k = key, analysis]
+                                  {
+            if (auto *analyser = weakOwner.get())
+                analyser->jobFinished(k, analysis); });
+
+        return jobHasFinished;
+    }
+
+private:
+    WeakReference<TrackAnalyser> owner;			 // The analyser that receives the result, if it still exists
+    AudioFormatManager &formatManager;			 // Used to open the track
+    URL audioURL;								 // The track
+    int64 key;									 // The track's key
+    std::shared_ptr<const DecodedTrack> decoded; // The decoded samples, if the track is in memory
+    File targetFile;							 // Where the result goes
+};
+
+//==============================================================================
+// Reads every stored result on the pool, so lookups on the message thread never touch the disk.
+class TrackAnalyser::LoadJob : public ThreadPoolJob
+{
+public:
+    LoadJob(WeakReference<TrackAnalyser> _owner, const File &_folder)
+        : ThreadPoolJob("Analysis index"), owner(_owner), folder(_folder)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        // Results from an older version of the analysis are left out, so those tracks are analysed again.
+        std::map<int64, TrackAnalysis> stored;
+
+        for (const auto &entry : RangedDirectoryIterator(folder, false, "*.json", File::findFiles))
+        {
+            if (shouldExit())
+            {
+                return jobHasFinished;
+            }
+
+            const auto parsed = JSON::parse(entry.getFile());
+
+            if (parsed.isObject() && (int)parsed.getProperty("version", 0) == analysisVersion)
+            {
+                stored.emplace(entry.getFile().getFileNameWithoutExtension().getHexValue64(), TrackAnalysis::fromVar(parsed));
+            }
+        }
+
+        MessageManager::callAsync([weakOwner = owner, results = std::move(stored)]() mutable
+                                  {
+            if (auto *analyser = weakOwner.get())
+                analyser->loadFinished(std::move(results)); });
+
+        return jobHasFinished;
+    }
+
+private:
+    WeakReference<TrackAnalyser> owner; // The analyser that receives the results, if it still exists
+    File folder;						// Where the results are kept
+};
+
+//==============================================================================
+TrackAnalyser::TrackAnalyser(AudioFormatManager &_formatManager, const File &_folder)
+    : formatManager(_formatManager), folder(_folder)
+{
+    // Keep the results with the user's application data unless told otherwise.
+    if (folder == File())
+    {
+        folder = File::getSpecialLocation(File::userApplicationDataDirectory).getChildFile("xDecks").getChildFile("Analysis");
+    }
+
+    folder.createDirectory();
+    pool.addJob(new LoadJob(WeakReference<TrackAnalyser>(this), folder), true);
+}
+
+TrackAnalyser::~TrackAnalyser()
+{
+    pool.removeAllJobs(true, 5000);
+}
+
+bool TrackAnalyser::find(int64 key, TrackAnalysis &result) const
+{
+    const auto it = results.find(key);
+
+    if (it == results.end())
+    {
+        return false;
+    }
+
+    result = it->second;
+    return true;
+}
+
+bool TrackAnalyser::isLoaded() const
+{
+    return loaded;
+}
+
+void TrackAnalyser::analyse(const URL &audioURL, int64 key, std::shared_ptr<const DecodedTrack> decoded, Callback callback)
+{
+    // Only start a job for the first request of a track; the rest wait for the same result.
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+
+    if (!loaded)
+    {
+        waitingForLoad.push_back([this, audioURL, key, decoded, callback]
+                                 { analyse(audioURL, key, decoded, callback); });
+        return;
+    }
+
+    // The track may have been analysed in an earlier session.
+    const auto stored = results.find(key);
+
+    if (stored != results.end())
+    {
+        if (callback != nullptr)
+        {
+            callback(stored->second);
+        }
+
+        return;
+    }
+
+    auto &callbacks = pending[key];
+    callbacks.push_back(std::move(callback));
+
+    if (callbacks.size() == 1)
+    {
+        pool.addJob(new AnalysisJob(WeakReference<TrackAnalyser>(this), formatManager, audioURL,
+                                    key, std::move(decoded), getFileForKey(key)),
+                    true);
+    }
+}
+
+void TrackAnalyser::analyseLibrary(const std::vector<LibraryTrack> &tracks, std::function<void(const File &, const TrackAnalysis &)> onTrackAnalysed)
+{
+    // Queue the tracks that have no result and no job yet, once the stored results are in.
+    if (!loaded)
+    {
+        waitingForLoad.push_back([this, tracks, onTrackAnalysed]
+                                 { analyseLibrary(tracks, onTrackAnalysed); });
+        return;
+    }
+
+    for (const auto &track : tracks)
+    {
+        const auto key = DecodedTrackCache::makeKey(track.file, track.size, track.modificationTime);
+
+        if (results.find(key) != results.end() || pending.find(key) != pending.end())
+        {
+            continue;
+        }
+
+        Callback callback;
+
+        if (onTrackAnalysed != nullptr)
+        {
+            callback = [onTrackAnalysed, file = track.file](const TrackAnalysis &result)
+            {
+                onTrackAnalysed(file, result);
+            };
+        }
+
+        analyse(URL(track.file), key, nullptr, callback);
+    }
+}
+
+File TrackAnalyser::getFileForKey(int64 key) const
+{
+    return folder.getChildFile(String::toHexString(key) + ".json");
+}
+
+void TrackAnalyser::jobFinished(int64 key, const TrackAnalysis &analysis)
+{
+    // Keep the result and hand it to everyone who asked for it.
+    results[key] = analysis;
+
+    auto it = pending.find(key);
+
+    if (it == pending.end())
+    {
+        return;
+    }
+
+    const auto callbacks = std::move(it->second);
+    pending.erase(it);
+
+    for (const auto &callback : callbacks)
+    {
+        if (callback != nullptr)
+        {
+            callback(analysis);
+        }
+    }
+}
+
+void TrackAnalyser::loadFinished(std::map<int64, TrackAnalysis> stored)
+{
+    // Keep the stored results, then run the requests that were waiting for them.
+    results.insert(stored.begin(), stored.end());
+    loaded = true;
+
+    if (onLoaded != nullptr)
+    {
+        onLoaded();
+    }
+
+    const auto waiting = std::move(waitingForLoad);
+    waitingForLoad.clear();
+
+    for (const auto &request : waiting)
+    {
+        request();
+    }
+}
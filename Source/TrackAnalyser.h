@@ -0,0 +1,196 @@
+/*
+	==============================================================================
+
+	TrackAnalyser.h
+	Created: 20 Oct 2026 10:15:22am
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "DecodedTrackCache.h"
+#include "TrackLibrary.h"
+
+/**
+	What the analyser found out about a track.
+
+	The beat grid is a downbeat and a beat period: beat n of the track is at
+	downbeatSeconds + n * beatPeriodSeconds, and every fourth beat from the
+	downbeat starts a bar. n can be negative for beats before the downbeat.
+*/
+struct TrackAnalysis
+{
+	double bpm = 0.0;				// Tempo in beats per minute, 0 if no tempo was found
+	double downbeatSeconds = 0.0;	// Time of the first downbeat, within the first bar
+	double beatPeriodSeconds = 0.0; // Length of a beat in seconds
+	float confidence = 0.0f;		// How sure the analyser is of the tempo, from 0.0 to 1.0
+	int key = -1;					// 0 to 11 for C to B major, 12 to 23 for C to B minor, -1 if unknown
+	double loudness = 0.0;			// Integrated loudness in LUFS, 0 if unknown or silent
+	double truePeak = 0.0;			// True peak in dBTP
+	double loudnessRange = 0.0;		// Loudness range in LU
+
+	/**
+		Returns whether a tempo was found.
+	*/
+	bool hasBeatGrid() const;
+
+	/**
+		Returns the time of a beat.
+		@param beat The beat number, counted from the downbeat.
+	*/
+	double getBeatTime(double beat) const;
+
+	/**
+		Returns which beat a time is on, with the fraction of the way to the next beat.
+		@param seconds The time in the track.
+	*/
+	double getBeatAt(double seconds) const;
+
+	/**
+		Returns whether a key was found.
+	*/
+	bool hasKey() const;
+
+	/**
+		Returns the key in musical notation, like "Am" or "F#", or an empty string.
+	*/
+	String getKeyName() const;
+
+	/**
+		Returns the number of the key on the Camelot wheel, from 1 to 12, or 0 if there is no key.
+	*/
+	int getCamelotNumber() const;
+
+	/**
+		Returns the key in Camelot notation, like "8A", or an empty string.
+		Keys next to each other on the wheel mix harmonically.
+	*/
+	String getCamelot() const;
+
+	/**
+		Returns whether the loudness was measured.
+	*/
+	bool hasLoudness() const;
+
+	/**
+		Returns the gain that brings the track to a target loudness. Boosts are limited so
+		the true peak stays below -1 dBTP, and the gain is limited to +/-12 dB.
+		@param targetLoudness The loudness to match, in LUFS.
+		@return The linear gain, 1.0 if the loudness is unknown.
+	*/
+	float getAutoGain(double targetLoudness) const;
+
+	/**
+		Converts the analysis to a var, for storing as JSON.
+	*/
+	var toVar() const;
+
+	/**
+		Reads an analysis stored with toVar().
+		@param stored The stored var.
+	*/
+	static TrackAnalysis fromVar(const var &stored);
+};
+
+/**
+	Works out the tempo, beat grid, key and loudness of tracks on a pool of worker
+	threads and keeps the results on disk, so a track is only analysed once. Each block
+	is mixed to mono once and fed to every analysis, so a track is only read once as well.
+
+	The tempo comes from an onset envelope at 200 frames per second, made from the rise
+	in energy of the bass and of the whole signal. Its autocorrelation is worked out for
+	every lag in the tempo range at once with FloatVectorOperations. Tempos are folded
+	into 70 to 180 BPM. The beat phase is the offset where the envelope is strongest
+	along the grid, and the downbeat is the beat of the bar with the strongest bass onsets.
+
+	The key comes from a chromagram: Hann-windowed FFTs of 8192 samples are folded into
+	the twelve pitch classes from 55 Hz to 1760 Hz, each frame normalised so quiet
+	passages count as much as loud ones. The sum is correlated with the Krumhansl-Kessler
+	major and minor profiles in all twelve keys.
+
+	Loudness is measured on the channels before they are mixed down, as EBU R128
+	describes: the K-weighted energy of 400 ms blocks gated at -70 LUFS and 10 LU below
+	the mean of the blocks above -70 LUFS gives the integrated loudness, and 3 s windows
+	gated the same way, but 20 LU below, give the loudness range. The K-weighting filters
+	both channels of a stereo track at once on a SIMD register. The true peak comes from
+	oversampling 4x below 96 kHz, a block at a time with FloatVectorOperations.
+
+	Results are stored as one small JSON file per track in the user's application data
+	folder, named after the DecodedTrackCache key. They are all read into memory once,
+	on the pool, when the analyser is created, so looking up a track never touches the
+	disk. Requests made before then wait for the stored results to come in.
+*/
+class TrackAnalyser
+{
+public:
+	/** Receives a finished analysis on the message thread. */
+	using Callback = std::function<void(const TrackAnalysis &)>;
+
+	/**
+		Constructor.
+		@param formatManager The AudioFormatManager used to open tracks that aren't decoded in memory.
+		@param folder Where to keep the results. Defaults to a folder in the user's application data.
+	*/
+	TrackAnalyser(AudioFormatManager &formatManager, const File &folder = File());
+
+	/**
+		Destructor. Stops any analysis that is still running.
+	*/
+	~TrackAnalyser();
+
+	/**
+		Looks up the stored analysis of a track, in memory.
+		@param key The track's key from DecodedTrackCache::makeKey().
+		@param result Receives the analysis if there is one.
+		@return True if the track has been analysed. Always false until the stored results have been read.
+	*/
+	bool find(int64 key, TrackAnalysis &result) const;
+
+	/**
+		Returns whether the stored results have been read.
+	*/
+	bool isLoaded() const;
+
+	/**
+		Analyses a track in the background and stores the result. Requests for a track
+		that is already being analysed share the same job, and requests for a track
+		that turns out to have a stored result get that result.
+		@param audioURL The track. Only local files are read; other tracks need decoded samples.
+		@param key The track's key from DecodedTrackCache::makeKey().
+		@param decoded The decoded samples, if the track is in memory, so the file doesn't have to be read again.
+		@param callback Called on the message thread when the analysis is done. May be nullptr.
+	*/
+	void analyse(const URL &audioURL, int64 key, std::shared_ptr<const DecodedTrack> decoded, Callback callback);
+
+	/**
+		Queues every track that hasn't been analysed and isn't being analysed yet, for when
+		tracks are imported. Keys come from the sizes and times in the index, so no file is read.
+		@param tracks The tracks in the library.
+		@param onTrackAnalysed Called on the message thread as each queued track is done. May be nullptr.
+	*/
+	void analyseLibrary(const std::vector<LibraryTrack> &tracks, std::function<void(const File &, const TrackAnalysis &)> onTrackAnalysed = nullptr);
+
+	/** Called on the message thread once the stored results have been read. */
+	std::function<void()> onLoaded;
+
+private:
+	class AnalysisJob;
+	class LoadJob;
+
+	File getFileForKey(int64 key) const;
+	void jobFinished(int64 key, const TrackAnalysis &analysis);
+	void loadFinished(std::map<int64, TrackAnalysis> stored);
+
+	AudioFormatManager &formatManager;							   // Used to open tracks for analysis
+	File folder;												   // Where the results are kept
+	ThreadPool pool{jmax(1, SystemStats::getNumCpus() / 2)};	   // Analyses several tracks at once
+	std::map<int64, TrackAnalysis> results;						   // Every result, only touched on the message thread
+	std::map<int64, std::vector<Callback>> pending;				   // Callbacks waiting for each job, only touched on the message thread
+	std::vector<std::function<void()>> waitingForLoad;			   // Requests made before the stored results were read
+	bool loaded = false;										   // Whether the stored results have been read
+
+	JUCE_DECLARE_WEAK_REFERENCEABLE(TrackAnalyser)
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackAnalyser)
+};
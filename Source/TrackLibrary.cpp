@@ -0,0 +1,682 @@
+/*
+  ==============================================================================
+
+    TrackLibrary.cpp
+    Created: 20 Oct 2026 3:48:10pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "TrackLibrary.h"
+
+// Identifies index files, and the version of their layout.
+static constexpr int indexMagic = 0x424C4478; // "xDLB" read as a little-endian int
+static constexpr int indexVersion = 2;
+
+// Imported tags are passed back after this many tracks, or after this long, whichever comes first.
+static constexpr size_t importBatchSize = 64;
+static constexpr uint32 importBatchMilliseconds = 250;
+
+// Text frames are at the start of an ID3 tag; anything after this, like cover art, isn't read.
+static constexpr int64 maxId3Bytes = 256 * 1024;
+
+// Orders tracks by path, which is how the index and the scans are sorted.
+static bool isBefore(const LibraryTrack &a, const LibraryTrack &b)
+{
+    return a.file.getFullPathName() < b.file.getFullPathName();
+}
+
+// Writes the roots and tracks to the index, through a temporary file so a half-written index is never read.
+static void writeIndex(const File &indexFile, const Array<File> &roots, const std::vector<LibraryTrack> &tracks)
+{
+    MemoryOutputStream out;
+    out.writeInt(indexMagic);
+    out.writeInt(indexVersion);
+    out.writeInt(roots.size());
+
+    for (const auto &root : roots)
+    {
+        out.writeString(root.getFullPathName());
+    }
+
+    out.writeInt((int)tracks.size());
+
+    for (const auto &track : tracks)
+    {
+        out.writeString(track.file.getFullPathName());
+        out.writeInt64(track.size);
+        out.writeInt64(track.modificationTime);
+        out.writeBool(track.tags.isRead);
+
+        if (track.tags.isRead)
+        {
+            out.writeString(track.tags.title);
+            out.writeString(track.tags.artist);
+            out.writeString(track.tags.album);
+            out.writeDouble(track.tags.lengthSeconds);
+            out.writeDouble(track.tags.sampleRate);
+            out.writeInt(track.tags.bitrate);
+        }
+    }
+
+    TemporaryFile temp(indexFile);
+
+    if (!temp.getFile().replaceWithData(out.getData(), out.getDataSize()) || !temp.overwriteTargetFileWithTemporary())
+    {
+        std::cout << "TrackLibrary::Couldn't write " << indexFile.getFullPathName() << std::endl;
+    }
+}
+
+// Turns ISO-8859-1 text into a String, up to the first null.
+static String fromLatin1(const uint8 *data, size_t size)
+{
+    String text;
+
+    for (size_t i = 0; i < size && data[i] != 0; ++i)
+    {
+        text += (juce_wchar)data[i];
+    }
+
+    return text.trim();
+}
+
+// Reads the text of an ID3v2 text frame, which starts with a byte giving its encoding.
+static String decodeId3Text(const uint8 *data, size_t size)
+{
+    if (size < 2)
+    {
+        return {};
+    }
+
+    const auto encoding = data[0];
+
+    if (encoding == 3)
+    {
+        const auto *end = std::find(data + 1, data + size, (uint8)0);
+        return String::fromUTF8((const char *)data + 1, (int)(end - data - 1)).trim();
+    }
+
+    if (encoding != 1 && encoding != 2)
+    {
+        return fromLatin1(data + 1, size - 1);
+    }
+
+    // UTF-16, with a byte order mark for encoding 1 and big-endian for encoding 2.
+    auto bigEndian = encoding == 2;
+    size_t i = 1;
+
+    if (encoding == 1 && size >= 3 && (data[1] == 0xfe || data[1] == 0xff))
+    {
+        bigEndian = data[1] == 0xfe;
+        i = 3;
+    }
+
+    const auto unitAt = [&](size_t index)
+    {
+        return bigEndian ? (juce_wchar)((data[index] << 8) | data[index + 1]) : (juce_wchar)(data[index] | (data[index + 1] << 8));
+    };
+
+    String text;
+
+    for (; i + 1 < size; i += 2)
+    {
+        auto character = unitAt(i);
+
+        if (character == 0)
+        {
+            break;
+        }
+
+        // Characters outside the basic plane are split over a surrogate pair.
+        if (character >= 0xd800 && character < 0xdc00 && i + 3 < size)
+        {
+            character = 0x10000 + ((character - 0xd800) << 10) + (unitAt(i + 2) - 0xdc00);
+            i += 2;
+        }
+
+        text += character;
+    }
+
+    return text.trim();
+}
+
+// Fills in whatever the tags are missing from an ID3v2 tag at the start of the file, or an ID3v1 tag at the end.
+static void readId3Tags(const File &file, TrackTags &tags)
+{
+    FileInputStream in(file);
+    uint8 header[10];
+
+    if (in.failedToOpen())
+    {
+        return;
+    }
+
+    if (in.read(header, 10) == 10 && std::memcmp(header, "ID3", 3) == 0 && header[3] >= 2 && header[3] <= 4)
+    {
+        // Sizes in the tag header, and in v2.4 frame headers, use seven bits per byte.
+        const auto syncsafe = [](const uint8 *bytes)
+        { return (bytes[0] & 0x7f) << 21 | (bytes[1] & 0x7f) << 14 | (bytes[2] & 0x7f) << 7 | (bytes[3] & 0x7f); };
+        const auto bigEndian = [](const uint8 *bytes, int numBytes)
+        {
+            int value = 0;
+
+            for (int i = 0; i < numBytes; ++i)
+            {
+                value = (value << 8) | bytes[i];
+            }
+
+            return value;
+        };
+
+        const auto version = header[3];
+        MemoryBlock tag;
+        in.readIntoMemoryBlock(tag, jmin((int64)syncsafe(header + 6), maxId3Bytes));
+
+        const auto *data = static_cast<const uint8 *>(tag.getData());
+        const auto size = tag.getSize();
+        const size_t idLength = version == 2 ? 3 : 4;
+        const size_t frameHeaderLength = version == 2 ? 6 : 10;
+        size_t pos = 0;
+
+        // Skip the extended header, if there is one.
+        if ((header[5] & 0x40) != 0 && size >= 4)
+        {
+            pos = version == 4 ? (size_t)syncsafe(data) : (size_t)bigEndian(data, 4) + 4;
+        }
+
+        while (pos + frameHeaderLength <= size && data[pos] != 0)
+        {
+            const auto *id = data + pos;
+            const auto frameSize = (size_t)(version == 2 ? bigEndian(id + 3, 3) : version == 4 ? syncsafe(id + 4) : bigEndian(id + 4, 4));
+            const auto body = pos + frameHeaderLength;
+
+            if (body + frameSize > size)
+            {
+                break;
+            }
+
+            const auto isFrame = [&](const char *v22Id, const char *v23Id)
+            { return std::memcmp(id, version == 2 ? v22Id : v23Id, idLength) == 0; };
+
+            if (isFrame("TT2", "TIT2") && tags.title.isEmpty())
+            {
+                tags.title = decodeId3Text(data + body, frameSize);
+            }
+            else if (isFrame("TP1", "TPE1") && tags.artist.isEmpty())
+            {
+                tags.artist = decodeId3Text(data + body, frameSize);
+            }
+            else if (isFrame("TAL", "TALB") && tags.album.isEmpty())
+            {
+                tags.album = decodeId3Text(data + body, frameSize);
+            }
+
+            pos = body + frameSize;
+        }
+    }
+
+    // Older files only have the fixed-size ID3v1 tag in their last 128 bytes.
+    uint8 v1[128];
+
+    if ((tags.title.isEmpty() || tags.artist.isEmpty()) && in.getTotalLength() >= 128 && in.setPosition(in.getTotalLength() - 128) && in.read(v1, 128) == 128 && std::memcmp(v1, "TAG", 3) == 0)
+    {
+        tags.title = tags.title.isEmpty() ? fromLatin1(v1 + 3, 30) : tags.title;
+        tags.artist = tags.artist.isEmpty() ? fromLatin1(v1 + 33, 30) : tags.artist;
+        tags.album = tags.album.isEmpty() ? fromLatin1(v1 + 63, 30) : tags.album;
+    }
+}
+
+// Returns the first of some metadata keys that has a value. The keys aren't case-sensitive.
+static String findTag(const StringPairArray &metadata, std::initializer_list<const char *> keys)
+{
+    for (const auto *key : keys)
+    {
+        const auto value = metadata.getValue(key, {}).trim();
+
+        if (value.isNotEmpty())
+        {
+            return value;
+        }
+    }
+
+    return {};
+}
+
+// Reads a track's tags and format, opening the file only as far as the reader needs to.
+static TrackTags readTags(AudioFormatManager &formatManager, const LibraryTrack &track)
+{
+    TrackTags tags;
+    tags.isRead = true;
+
+    if (std::unique_ptr<AudioFormatReader> reader{formatManager.createReaderFor(track.file)})
+    {
+        if (reader->sampleRate > 0.0)
+        {
+            tags.sampleRate = reader->sampleRate;
+            tags.lengthSeconds = (double)reader->lengthInSamples / reader->sampleRate;
+        }
+
+        // Ogg Vorbis readers use the id3 keys, WAV readers the RIFF INFO ids and Core Audio plain names.
+        const auto &metadata = reader->metadataValues;
+        tags.title = findTag(metadata, {"id3title", "INAM", "title"});
+        tags.artist = findTag(metadata, {"id3artist", "IART", "artist"});
+        tags.album = findTag(metadata, {"id3album", "IPRD", "album"});
+    }
+
+    if (tags.title.isEmpty() || tags.artist.isEmpty() || tags.album.isEmpty())
+    {
+        readId3Tags(track.file, tags);
+    }
+
+    if (tags.lengthSeconds > 0.0)
+    {
+        tags.bitrate = roundToInt((double)track.size * 8.0 / tags.lengthSeconds / 1000.0);
+    }
+
+    if (tags.title.isEmpty())
+    {
+        tags.title = track.file.getFileNameWithoutExtension();
+    }
+
+    return tags;
+}
+
+//==============================================================================
+// Walks the library's folders on the pool thread and compares what it finds with the index.
+class TrackLibrary::ScanJob : public ThreadPoolJob
+{
+public:
+    ScanJob(WeakReference<TrackLibrary> _owner,
+            const File &_indexFile,
+            const String &_wildcard,
+            const Array<File> &_roots,
+            std::vector<LibraryTrack> _previous,
+            bool _saveRegardless)
+        : ThreadPoolJob("Library scan"),
+          owner(_owner),
+          indexFile(_indexFile),
+          wildcard(_wildcard),
+          roots(_roots),
+          previous(std::move(_previous)),
+          saveRegardless(_saveRegardless)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        // The directory iterator already knows each file's size and time, so no file is opened.
+        std::vector<LibraryTrack> scanned;
+
+        for (const auto &root : roots)
+        {
+            for (const auto &entry : RangedDirectoryIterator(root, true, wildcard, File::findFiles))
+            {
+                if (shouldExit())
+                {
+                    return jobHasFinished;
+                }
+
+                scanned.push_back({entry.getFile(), entry.getFileSize(), entry.getModificationTime().toMilliseconds()});
+            }
+        }
+
+        std::sort(scanned.begin(), scanned.end(), isBefore);
+        scanned.erase(std::unique(scanned.begin(), scanned.end(), [](const LibraryTrack &a, const LibraryTrack &b)
+                                  { return a.file == b.file; }),
+                      scanned.end());
+
+        // Both lists are sorted by path, so they can be compared in one pass.
+        Changes changes;
+        auto before = previous.begin();
+        auto now = scanned.begin();
+
+        while (before != previous.end() || now != scanned.end())
+        {
+            if (now == scanned.end() || (before != previous.end() && isBefore(*before, *now)))
+            {
+                changes.removed.push_back((before++)->file);
+            }
+            else if (before == previous.end() || isBefore(*now, *before))
+            {
+                changes.added.push_back((now++)->file);
+            }
+            else
+            {
+                // Unchanged tracks keep their tags; changed ones are read again.
+                if (before->size != now->size || before->modificationTime != now->modificationTime)
+                {
+                    changes.changed.push_back(now->file);
+                }
+                else
+                {
+                    now->tags = before->tags;
+                }
+
+                ++before;
+                ++now;
+            }
+        }
+
+        const auto hasChanges = !changes.added.empty() || !changes.changed.empty() || !changes.removed.empty();
+
+        if (hasChanges || saveRegardless)
+        {
+            writeIndex(indexFile, roots, scanned);
+        }
+
+        MessageManager::callAsync([weakOwner = owner, tracks = std::move(scanned), changes]() mutable
+                                  {
+            if (auto *library = weakOwner.get())
+                library->scanFinished(std::move(tracks), changes); });
+
+        return jobHasFinished;
+    }
+
+private:
+    WeakReference<TrackLibrary> owner;	  // The library that receives the result, if it still exists
+    File indexFile;						  // Where the index goes
+    String wildcard;					  // File patterns of the tracks to look for
+    Array<File> roots;					  // The folders to walk
+    std::vector<LibraryTrack> previous;	  // The tracks in the index before the scan, sorted by path
+    bool saveRegardless;				  // Whether to write the index even if no track changed, because the roots did
+};
+
+//==============================================================================
+// The tracks of an import, shared by all of its workers.
+struct TrackLibrary::ImportQueue
+{
+    std::vector<LibraryTrack> tracks;	// The tracks to read
+    std::atomic<size_t> next{0};		// The next track for a worker to take
+    std::atomic<int> workersLeft{0};	// Workers that haven't finished yet
+};
+
+//==============================================================================
+// Takes tracks from an import's queue one at a time and reads their tags.
+class TrackLibrary::ImportJob : public ThreadPoolJob
+{
+public:
+    ImportJob(WeakReference<TrackLibrary> _owner, AudioFormatManager &_formatManager, std::shared_ptr<ImportQueue> _queue)
+        : ThreadPoolJob("Tag import"), owner(_owner), formatManager(_formatManager), queue(std::move(_queue))
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        // Keep taking the next track until the queue is empty, passing results back as they build up.
+        std::vector<LibraryTrack> batch;
+        auto lastSent = Time::getMillisecondCounter();
+
+        for (auto index = queue->next++; index < queue->tracks.size() && !shouldExit(); index = queue->next++)
+        {
+            auto track = queue->tracks[index];
+            track.tags = readTags(formatManager, track);
+            batch.push_back(std::move(track));
+
+            if (batch.size() >= importBatchSize || Time::getMillisecondCounter() - lastSent >= importBatchMilliseconds)
+            {
+                send(std::move(batch));
+                batch.clear();
+                lastSent = Time::getMillisecondCounter();
+            }
+        }
+
+        if (!batch.empty())
+        {
+            send(std::move(batch));
+        }
+
+        // The last worker to finish reports the end of the import.
+        if (--queue->workersLeft == 0)
+        {
+            MessageManager::callAsync([weakOwner = owner]
+                                      {
+                if (auto *library = weakOwner.get())
+                    library->importFinished(); });
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    void send(std::vector<LibraryTrack> batch)
+    {
+        MessageManager::callAsync([weakOwner = owner, tracks = std::move(batch)]
+                                  {
+            if (auto *library = weakOwner.get())
+                library->tagsRead(tracks); });
+    }
+
+    WeakReference<TrackLibrary> owner;		// The library that receives the tags, if it still exists
+    AudioFormatManager &formatManager;		// Used to open the tracks
+    std::shared_ptr<ImportQueue> queue;		// The tracks of the import
+};
+
+//==============================================================================
+TrackLibrary::TrackLibrary(AudioFormatManager &_formatManager, const File &_indexFile)
+    : formatManager(_formatManager), indexFile(_indexFile)
+{
+    // Keep the index with the user's application data unless told otherwise.
+    if (indexFile == File())
+    {
+        indexFile = File::getSpecialLocation(File::userApplicationDataDirectory).getChildFile("xDecks").getChildFile("Library.xdlb");
+    }
+
+    indexFile.getParentDirectory().createDirectory();
+    load();
+}
+
+TrackLibrary::~TrackLibrary()
+{
+    importPool.removeAllJobs(true, 5000);
+    pool.removeAllJobs(true, 5000);
+}
+
+const std::vector<LibraryTrack> &TrackLibrary::getTracks() const
+{
+    return tracks;
+}
+
+Array<File> TrackLibrary::getRoots() const
+{
+    return roots;
+}
+
+void TrackLibrary::addRoot(const File &folder)
+{
+    // Add the folder unless it is already in the library.
+    if (!folder.isDirectory() || roots.contains(folder))
+    {
+        std::cout << "TrackLibrary::Invalid folder: " << folder.getFullPathName() << std::endl;
+        return;
+    }
+
+    roots.add(folder);
+    isIndexStale = true;
+    rescan();
+}
+
+void TrackLibrary::removeRoot(const File &folder)
+{
+    // Its tracks are dropped by the rescan.
+    if (roots.contains(folder))
+    {
+        roots.removeFirstMatchingValue(folder);
+        isIndexStale = true;
+        rescan();
+    }
+}
+
+void TrackLibrary::rescan()
+{
+    // Only one scan runs at a time; a rescan asked for during a scan runs after it.
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+    jassert(formatManager.getNumKnownFormats() > 0);
+
+    if (isScanning)
+    {
+        isRescanPending = true;
+        return;
+    }
+
+    isScanning = true;
+    pool.addJob(new ScanJob(WeakReference<TrackLibrary>(this), indexFile, formatManager.getWildcardForAllFormats(), roots, tracks, isIndexStale), true);
+    isIndexStale = false;
+}
+
+void TrackLibrary::load()
+{
+    // Read the whole index in one go and parse it from memory.
+    MemoryBlock data;
+
+    if (!indexFile.loadFileAsData(data))
+    {
+        roots.add(File::getSpecialLocation(File::userMusicDirectory));
+        isIndexStale = true;
+        return;
+    }
+
+    MemoryInputStream in(data, false);
+
+    // Indexes from before tags were imported are read without them, and the tags imported again.
+    const auto magic = in.readInt();
+    const auto version = in.readInt();
+
+    if (magic != indexMagic || version < 1 || version > indexVersion)
+    {
+        std::cout << "TrackLibrary::Invalid index file: " << indexFile.getFullPathName() << std::endl;
+        roots.add(File::getSpecialLocation(File::userMusicDirectory));
+        isIndexStale = true;
+        return;
+    }
+
+    for (int i = in.readInt(); i > 0 && !in.isExhausted(); --i)
+    {
+        roots.add(File(in.readString()));
+    }
+
+    const auto numTracks = in.readInt();
+    tracks.reserve((size_t)jmax(0, numTracks));
+
+    for (int i = 0; i < numTracks && !in.isExhausted(); ++i)
+    {
+        LibraryTrack track;
+        track.file = File(in.readString());
+        track.size = in.readInt64();
+        track.modificationTime = in.readInt64();
+
+        if (version >= 2 && in.readBool())
+        {
+            track.tags.title = in.readString();
+            track.tags.artist = in.readString();
+            track.tags.album = in.readString();
+            track.tags.lengthSeconds = in.readDouble();
+            track.tags.sampleRate = in.readDouble();
+            track.tags.bitrate = in.readInt();
+            track.tags.isRead = true;
+        }
+
+        tracks.push_back(std::move(track));
+    }
+}
+
+void TrackLibrary::saveInBackground()
+{
+    // Write a copy of the index on the scan thread, so the message thread doesn't wait on the disk.
+    pool.addJob([file = indexFile, rootsToSave = roots, tracksToSave = tracks]
+                { writeIndex(file, rootsToSave, tracksToSave); });
+}
+
+void TrackLibrary::scanFinished(std::vector<LibraryTrack> scanned, const Changes &changes)
+{
+    // Keep the tags that were imported while the scan was running.
+    std::vector<LibraryTrack> toImport;
+
+    for (auto &track : scanned)
+    {
+        const auto it = std::lower_bound(tracks.begin(), tracks.end(), track, isBefore);
+
+        if (!track.tags.isRead && it != tracks.end() && it->file == track.file && it->size == track.size && it->modificationTime == track.modificationTime)
+        {
+            track.tags = it->tags;
+        }
+
+        if (!track.tags.isRead && importing.count(track.file) == 0)
+        {
+            toImport.push_back(track);
+        }
+    }
+
+    // Take the new list of tracks, then start any rescan that was asked for in the meantime.
+    tracks = std::move(scanned);
+    isScanning = false;
+
+    if (isRescanPending)
+    {
+        isRescanPending = false;
+        rescan();
+    }
+
+    if ((!changes.added.empty() || !changes.changed.empty() || !changes.removed.empty()) && onChanged != nullptr)
+    {
+        onChanged(changes);
+    }
+
+    importTags(std::move(toImport));
+}
+
+void TrackLibrary::importTags(std::vector<LibraryTrack> toImport)
+{
+    // Start a worker on every thread of the pool, all taking tracks from the same queue.
+    if (toImport.empty())
+    {
+        return;
+    }
+
+    for (const auto &track : toImport)
+    {
+        importing.insert(track.file);
+    }
+
+    auto queue = std::make_shared<ImportQueue>();
+    queue->tracks = std::move(toImport);
+    queue->workersLeft = jmin(importPool.getNumThreads(), (int)queue->tracks.size());
+    ++importsRunning;
+
+    for (int i = queue->workersLeft; i > 0; --i)
+    {
+        importPool.addJob(new ImportJob(WeakReference<TrackLibrary>(this), formatManager, queue), true);
+    }
+}
+
+void TrackLibrary::tagsRead(const std::vector<LibraryTrack> &imported)
+{
+    // Store the tags of the tracks that are still in the library and haven't changed since they were read.
+    std::vector<LibraryTrack> updated;
+
+    for (const auto &track : imported)
+    {
+        importing.erase(track.file);
+        const auto it = std::lower_bound(tracks.begin(), tracks.end(), track, isBefore);
+
+        if (it != tracks.end() && it->file == track.file && it->size == track.size && it->modificationTime == track.modificationTime)
+        {
+            it->tags = track.tags;
+            updated.push_back(track);
+        }
+    }
+
+    if (!updated.empty() && onTagsRead != nullptr)
+    {
+        onTagsRead(updated);
+    }
+}
+
+void TrackLibrary::importFinished()
+{
+    // Keep the tags once every import has finished.
+    if (--importsRunning == 0)
+    {
+        saveInBackground();
+    }
+}
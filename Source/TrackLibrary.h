@@ -0,0 +1,139 @@
+/*
+	==============================================================================
+
+	TrackLibrary.h
+	Created: 20 Oct 2026 3:48:10pm
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+	What a track's tags and format say about it.
+*/
+struct TrackTags
+{
+	String title;				// Title from the tags, or the file name if it has none
+	String artist;				// Artist from the tags
+	String album;				// Album from the tags
+	double lengthSeconds = 0.0; // Length of the track
+	double sampleRate = 0.0;	// Sample rate of the file
+	int bitrate = 0;			// Average bitrate in kbit/s, worked out from the file size and length
+	bool isRead = false;		// Whether the tags have been read yet
+};
+
+/**
+	A track in the library, as it was when its folder was last scanned.
+*/
+struct LibraryTrack
+{
+	File file;					// The track
+	int64 size = 0;				// Size of the file in bytes
+	int64 modificationTime = 0; // When the file was last modified, in milliseconds since 1970
+	TrackTags tags;				// The track's tags, once they have been read
+};
+
+/**
+	The tracks in the user's music folders, kept in an index file so the whole library
+	is there as soon as the app starts, without walking any folders.
+
+	The index holds the folders to scan and the path, size and modification time of
+	every track in them, in a compact binary file that is read in one go. Rescans walk
+	the folders recursively on a background thread and compare what they find with the
+	index by size and modification time. Only tracks that were added, changed or removed
+	are reported, and the index is only rewritten when something changed.
+
+	New and changed tracks then have their tags read on a pool with a thread per core.
+	The tracks waiting to be read are shared by all the workers, and each one takes the
+	next track as soon as it is done with the last, so a slow file never holds up the
+	rest. Results are passed back in small batches as they come in, so the playlist
+	fills in while the import is still running. Tags come from the format readers'
+	metadata, and from the ID3 tags of files whose reader has none, like MP3s.
+*/
+class TrackLibrary
+{
+public:
+	/** What a rescan found out. */
+	struct Changes
+	{
+		std::vector<File> added;   // Tracks that are new to the library
+		std::vector<File> changed; // Tracks whose size or modification time changed
+		std::vector<File> removed; // Tracks that are gone, or whose folder was removed
+	};
+
+	/**
+		Constructor. Reads the index, or starts with the user's music folder if there isn't one.
+		@param formatManager Decides which files are tracks: anything it has a format for.
+		@param indexFile Where to keep the index. Defaults to a file in the user's application data.
+	*/
+	TrackLibrary(AudioFormatManager &formatManager, const File &indexFile = File());
+
+	/**
+		Destructor. Stops a rescan that is still running.
+	*/
+	~TrackLibrary();
+
+	/**
+		Returns the tracks in the library, sorted by path.
+	*/
+	const std::vector<LibraryTrack> &getTracks() const;
+
+	/**
+		Returns the folders the library is made of.
+	*/
+	Array<File> getRoots() const;
+
+	/**
+		Adds a folder and its subfolders to the library, and rescans.
+		@param folder The folder to add. Nothing happens if it is already in the library.
+	*/
+	void addRoot(const File &folder);
+
+	/**
+		Removes a folder from the library, and rescans.
+		@param folder The folder to remove.
+	*/
+	void removeRoot(const File &folder);
+
+	/**
+		Looks for new, changed and removed tracks in the background. If a rescan is already
+		running, another one is started once it is done.
+	*/
+	void rescan();
+
+	/** Called on the message thread after a rescan that found any changes. */
+	std::function<void(const Changes &)> onChanged;
+
+	/** Called on the message thread with each batch of tracks whose tags have just been read. */
+	std::function<void(const std::vector<LibraryTrack> &)> onTagsRead;
+
+private:
+	class ScanJob;
+	class ImportJob;
+	struct ImportQueue;
+
+	void load();
+	void saveInBackground();
+	void scanFinished(std::vector<LibraryTrack> scanned, const Changes &changes);
+	void importTags(std::vector<LibraryTrack> toImport);
+	void tagsRead(const std::vector<LibraryTrack> &imported);
+	void importFinished();
+
+	AudioFormatManager &formatManager;	// Decides which files are tracks
+	File indexFile;						// Where the index is kept
+	Array<File> roots;					// The folders in the library
+	std::vector<LibraryTrack> tracks;	// Every track in the library, sorted by path
+	ThreadPool pool{1};					// Runs the rescans, one at a time
+	bool isScanning = false;			// Whether a rescan is running
+	bool isRescanPending = false;		// Whether to rescan again once the current rescan is done
+	bool isIndexStale = false;			// Whether the roots changed since the index was written
+	ThreadPool importPool{jmax(1, SystemStats::getNumCpus())}; // Reads tags, a track per worker at a time
+	int importsRunning = 0;				// Number of imports whose workers haven't all finished
+	std::set<File> importing;			// Tracks waiting for their tags, so they aren't queued twice
+
+	JUCE_DECLARE_WEAK_REFERENCEABLE(TrackLibrary)
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackLibrary)
+};
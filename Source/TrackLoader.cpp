@@ -0,0 +1,453 @@
+/*
+  ==============================================================================
+
+    TrackLoader.cpp
+    Created: 17 Oct 2026 11:04:18am
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "TrackLoader.h"
+
+// An InputStream over a MemoryBlock that is shared between several readers,
+// so the file only has to be read from disk once.
+class SharedBlockInputStream : public MemoryInputStream
+{
+public:
+    SharedBlockInputStream(std::shared_ptr<const MemoryBlock> sharedBlock)
+        : MemoryInputStream(sharedBlock->getData(), sharedBlock->getSize(), false),
+          block(std::move(sharedBlock))
+    {
+    }
+
+private:
+    std::shared_ptr<const MemoryBlock> block; // Keeps the data alive for as long as the stream
+};
+
+//==============================================================================
+// Reads a file into memory on a pool thread and creates the readers for it.
+class TrackLoader::LoadJob : public ThreadPoolJob
+{
+public:
+    LoadJob(WeakReference<TrackLoader> _owner,
+            AudioFormatManager &_formatManager,
+            DecodedTrackCache &_decodedCache,
+            const URL &_audioURL,
+            Listener *_listener,
+            int _requestId,
+            std::shared_ptr<std::atomic<bool>> _cancelled,
+            bool _decodeIntoMemory)
+        : ThreadPoolJob("Load " + _audioURL.getFileName()),
+          owner(_owner),
+          formatManager(_formatManager),
+          decodedCache(_decodedCache),
+          audioURL(_audioURL),
+          listener(_listener),
+          requestId(_requestId),
+          cancelled(std::move(_cancelled)),
+          decodeIntoMemory(_decodeIntoMemory)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        auto track = std::make_shared<LoadedTrack>();
+        track->audioURL = audioURL;
+        track->hashCode = DecodedTrackCache::makeKey(audioURL);
+
+        // A recently played track doesn't need to be read or decoded again.
+        if (decodeIntoMemory)
+        {
+            track->decoded = decodedCache.find(track->hashCode);
+
+            if (track->decoded != nullptr)
+            {
+                postResult(track, {});
+                return jobHasFinished;
+            }
+        }
+
+        // Reading the file is the first half of the progress when the track is decoded as well.
+        progressScale = decodeIntoMemory ? 0.5 : 1.0;
+
+        // Uncompressed files are mapped rather than read, so they start instantly.
+        if (!openMappedReaders(*track))
+        {
+            auto block = std::make_shared<MemoryBlock>();
+            String error;
+
+            if (!readWholeFile(*block, error))
+            {
+                if (!isCancelled())
+                {
+                    postResult(track, error);
+                }
+                return jobHasFinished;
+            }
+
+            std::shared_ptr<const MemoryBlock> data(block);
+            track->reader.reset(formatManager.createReaderFor(std::make_unique<SharedBlockInputStream>(data)));
+            track->thumbnailReader.reset(formatManager.createReaderFor(std::make_unique<SharedBlockInputStream>(data)));
+        }
+
+        if ((track->reader == nullptr && track->mappedReader == nullptr) || track->thumbnailReader == nullptr)
+        {
+            postResult(track, "Unsupported audio format: " + audioURL.getFileName());
+        }
+        else
+        {
+            if (decodeIntoMemory)
+            {
+                decodeWholeTrack(*track);
+            }
+
+            if (!isCancelled())
+            {
+                postResult(track, {});
+            }
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    bool openMappedReaders(LoadedTrack &track)
+    {
+        // Only WAV and AIFF support memory-mapped readers; other formats return nullptr
+        // and are read into memory instead.
+        if (!audioURL.isLocalFile())
+        {
+            return false;
+        }
+
+        const auto file = audioURL.getLocalFile();
+        auto *format = formatManager.findFormatForFileExtension(file.getFileExtension());
+
+        if (format == nullptr)
+        {
+            return false;
+        }
+
+        std::unique_ptr<MemoryMappedAudioFormatReader> playerReader(format->createMemoryMappedReader(file));
+        std::unique_ptr<MemoryMappedAudioFormatReader> waveformReader(format->createMemoryMappedReader(file));
+
+        if (playerReader == nullptr || waveformReader == nullptr || !playerReader->mapEntireFile() || !waveformReader->mapEntireFile())
+        {
+            return false;
+        }
+
+        track.mappedReader = std::move(playerReader);
+        track.thumbnailReader = std::move(waveformReader);
+        return true;
+    }
+
+    void decodeWholeTrack(LoadedTrack &track)
+    {
+        // Decode the player's reader into a float buffer and add it to the cache.
+        // Tracks that are too big for the cache are streamed as usual.
+        AudioFormatReader &reader = track.mappedReader != nullptr ? *track.mappedReader : *track.reader;
+        const auto sizeInBytes = (size_t)reader.lengthInSamples * reader.numChannels * sizeof(float);
+
+        if (reader.lengthInSamples <= 0 || reader.lengthInSamples > std::numeric_limits<int>::max() || !decodedCache.canFit(sizeInBytes))
+        {
+            return;
+        }
+
+        const auto length = (int)reader.lengthInSamples;
+        constexpr int chunkSize = 1 << 16;
+
+        auto decoded = std::make_unique<DecodedTrack>();
+        decoded->sampleRate = reader.sampleRate;
+        decoded->samples.setSize((int)reader.numChannels, length);
+
+        for (int pos = 0; pos < length; pos += chunkSize)
+        {
+            if (isCancelled())
+            {
+                return;
+            }
+
+            reader.read(&decoded->samples, pos, jmin(chunkSize, length - pos), pos, true, true);
+
+            if (listener != nullptr && (pos / chunkSize) % 16 == 0)
+            {
+                postProgress(0.5 + 0.5 * (double)pos / (double)length);
+            }
+        }
+
+        track.decoded = decodedCache.insert(track.hashCode, std::move(decoded));
+
+        // Both the player and the waveform use the decoded samples now.
+        track.reader.reset();
+        track.mappedReader.reset();
+        track.thumbnailReader.reset();
+    }
+
+    bool isCancelled() const
+    {
+        return cancelled->load() || shouldExit();
+    }
+
+    bool readWholeFile(MemoryBlock &block, String &error)
+    {
+        // Read the file in chunks so progress can be reported and the job can be cancelled.
+        std::unique_ptr<InputStream> stream;
+
+        if (audioURL.isLocalFile())
+        {
+            stream = audioURL.getLocalFile().createInputStream();
+        }
+        else
+        {
+            stream = audioURL.createInputStream(URL::InputStreamOptions(URL::ParameterHandling::inAddress));
+        }
+
+        if (stream == nullptr)
+        {
+            error = "Couldn't open " + audioURL.getFileName();
+            return false;
+        }
+
+        const auto totalLength = stream->getTotalLength();
+        constexpr int chunkSize = 1 << 18;
+        double lastProgress = 0.0;
+
+        MemoryOutputStream out(block, false);
+
+        if (totalLength > 0)
+        {
+            out.preallocate((size_t)totalLength);
+        }
+
+        while (!stream->isExhausted())
+        {
+            if (isCancelled())
+            {
+                return false;
+            }
+
+            if (out.writeFromInputStream(*stream, chunkSize) <= 0)
+            {
+                break;
+            }
+
+            // Don't flood the message thread with tiny progress steps.
+            if (totalLength > 0)
+            {
+                const auto progress = progressScale * (double)out.getPosition() / (double)totalLength;
+
+                if (listener != nullptr && progress - lastProgress >= 0.02)
+                {
+                    lastProgress = progress;
+                    postProgress(progress);
+                }
+            }
+        }
+
+        out.flush();
+
+        if (out.getDataSize() == 0)
+        {
+            error = audioURL.getFileName() + " is empty";
+            return false;
+        }
+
+        return true;
+    }
+
+    void postProgress(double progress)
+    {
+        MessageManager::callAsync([weakOwner = owner, l = listener, id = requestId, progress]
+                                  {
+            if (auto *loader = weakOwner.get())
+                loader->jobProgress(l, id, progress); });
+    }
+
+    void postResult(std::shared_ptr<LoadedTrack> track, const String &error)
+    {
+        // Prefetches have no listener; the result is only kept in the cache.
+        if (listener == nullptr)
+        {
+            return;
+        }
+
+        MessageManager::callAsync([weakOwner = owner, l = listener, id = requestId, track, error]
+                                  {
+            if (auto *loader = weakOwner.get())
+                loader->jobFinished(l, id, track, error); });
+    }
+
+    WeakReference<TrackLoader> owner;			   // The loader that receives the results, if it still exists
+    AudioFormatManager &formatManager;			   // Used to create the readers
+    DecodedTrackCache &decodedCache;			   // Where decoded tracks are looked up and stored
+    URL audioURL;								   // The track being loaded
+    Listener *listener;							   // Who asked for the track, or nullptr for a prefetch
+    int requestId;								   // Lets the loader ignore results of replaced requests
+    std::shared_ptr<std::atomic<bool>> cancelled; // Set when the request is replaced or cancelled
+    bool decodeIntoMemory;						   // Whether to decode the whole track into the cache
+    double progressScale = 1.0;					   // How much of the progress is taken up by reading the file
+};
+
+//==============================================================================
+TrackLoader::TrackLoader(AudioFormatManager &_formatManager, DecodedTrackCache &_decodedCache)
+    : formatManager(_formatManager), decodedCache(_decodedCache)
+{
+    // Constructor for TrackLoader class.
+}
+
+TrackLoader::~TrackLoader()
+{
+    // Interrupt anything still reading and wait for the workers to stop.
+    for (auto &pending : pendingRequests)
+    {
+        *pending.second.cancelled = true;
+    }
+
+    cancelPrefetch();
+    pool.removeAllJobs(true, 5000);
+}
+
+void TrackLoader::loadTrack(const URL &audioURL, Listener *listener, bool decodeIntoMemory)
+{
+    // Queue a load job, replacing whatever this listener asked for before.
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+
+    const auto previous = pendingRequests.find(listener);
+
+    if (previous != pendingRequests.end())
+    {
+        *previous->second.cancelled = true;
+    }
+
+    pausePrefetch();
+
+    Request request{nextRequestId++, std::make_shared<std::atomic<bool>>(false)};
+    pendingRequests[listener] = request;
+
+    pool.addJob(new LoadJob(WeakReference<TrackLoader>(this), formatManager, decodedCache,
+                            audioURL, listener, request.id, request.cancelled, decodeIntoMemory),
+                true);
+}
+
+void TrackLoader::prefetch(const URL &audioURL)
+{
+    // Only decks that decode into memory read from the cache, so otherwise there's nothing to gain.
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+
+    if (decodingListeners.empty())
+    {
+        return;
+    }
+
+    cancelPrefetch();
+    waitingPrefetch = audioURL;
+    startPrefetch();
+}
+
+void TrackLoader::setDecodingIntoMemory(Listener *listener, bool decodes)
+{
+    if (decodes)
+    {
+        decodingListeners.insert(listener);
+        return;
+    }
+
+    decodingListeners.erase(listener);
+
+    if (decodingListeners.empty())
+    {
+        cancelPrefetch();
+    }
+}
+
+void TrackLoader::cancelLoads(Listener *listener)
+{
+    // Flag the pending job so it stops reading; its result will be ignored.
+    auto it = pendingRequests.find(listener);
+
+    if (it != pendingRequests.end())
+    {
+        *it->second.cancelled = true;
+        pendingRequests.erase(it);
+        startPrefetch();
+    }
+}
+
+void TrackLoader::startPrefetch()
+{
+    // Decode into the cache without anyone waiting for the result, once no deck is waiting for a load.
+    if (waitingPrefetch.isEmpty() || !pendingRequests.empty())
+    {
+        return;
+    }
+
+    runningPrefetch = waitingPrefetch;
+    prefetchCancelled = std::make_shared<std::atomic<bool>>(false);
+    pool.addJob(new LoadJob(WeakReference<TrackLoader>(this), formatManager, decodedCache,
+                            waitingPrefetch, nullptr, 0, prefetchCancelled, true),
+                true);
+    waitingPrefetch = URL();
+}
+
+void TrackLoader::cancelPrefetch()
+{
+    // Drop the waiting prefetch and stop the running one; a half-decoded track is never cached.
+    waitingPrefetch = URL();
+
+    if (prefetchCancelled != nullptr)
+    {
+        *prefetchCancelled = true;
+        prefetchCancelled = nullptr;
+    }
+}
+
+void TrackLoader::pausePrefetch()
+{
+    // Stop the running prefetch so the load gets the workers, and start it again once the loads are done.
+    // If it already finished, starting it again only finds the track in the cache.
+    if (prefetchCancelled != nullptr)
+    {
+        *prefetchCancelled = true;
+        prefetchCancelled = nullptr;
+
+        if (waitingPrefetch.isEmpty())
+        {
+            waitingPrefetch = runningPrefetch;
+        }
+    }
+}
+
+void TrackLoader::jobProgress(Listener *listener, int requestId, double progress)
+{
+    // Forward progress only for the request that is still current.
+    auto it = pendingRequests.find(listener);
+
+    if (it != pendingRequests.end() && it->second.id == requestId)
+    {
+        listener->trackLoadProgress(progress);
+    }
+}
+
+void TrackLoader::jobFinished(Listener *listener, int requestId, std::shared_ptr<LoadedTrack> track, const String &error)
+{
+    // Deliver the result if the request hasn't been replaced or cancelled in the meantime.
+    auto it = pendingRequests.find(listener);
+
+    if (it == pendingRequests.end() || it->second.id != requestId)
+    {
+        return;
+    }
+
+    pendingRequests.erase(it);
+    startPrefetch();
+
+    if (error.isEmpty())
+    {
+        listener->trackLoaded(*track);
+    }
+    else
+    {
+        listener->trackLoadFailed(track->audioURL, error);
+    }
+}
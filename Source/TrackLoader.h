@@ -0,0 +1,143 @@
+/*
+	==============================================================================
+
+	TrackLoader.h
+	Created: 17 Oct 2026 11:04:18am
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "DecodedTrackCache.h"
+
+/**
+	A track that has been opened by the TrackLoader and is ready to be swapped into a deck.
+	The file is only read once; the player and the waveform each get their own reader
+	over the same bytes in memory. WAV and AIFF files are memory-mapped instead of read,
+	in which case mappedReader is used for playback. When the track was decoded into
+	memory, the readers are left empty and both use the decoded samples instead.
+*/
+struct LoadedTrack
+{
+	URL audioURL;										// Where the track was loaded from
+	int64 hashCode = 0;									// Hash used to identify the track in caches
+	std::unique_ptr<AudioFormatReader> reader;			// Reader for playback, taken by DJAudioPlayer
+	std::unique_ptr<MemoryMappedAudioFormatReader> mappedReader; // Mapped reader for playback of WAV and AIFF files
+	std::unique_ptr<AudioFormatReader> thumbnailReader; // Reader for the waveform, taken by WaveformDisplay
+	std::shared_ptr<const DecodedTrack> decoded;		// The whole track as PCM, if it was decoded into memory
+};
+
+/**
+	Opens tracks on a background worker so the message thread never blocks on disk or
+	on parsing a file, then hands the result back to a Listener on the message thread.
+*/
+class TrackLoader
+{
+public:
+	/**
+		Receives the progress and result of a load on the message thread.
+	*/
+	class Listener
+	{
+	public:
+		virtual ~Listener() = default;
+
+		/**
+			Called as the file is being read.
+			@param progress How much of the file has been read, from 0.0 to 1.0.
+		*/
+		virtual void trackLoadProgress(double progress) = 0;
+
+		/**
+			Called when the track is ready. The listener can take the readers out of the track.
+			@param track The loaded track.
+		*/
+		virtual void trackLoaded(LoadedTrack &track) = 0;
+
+		/**
+			Called when the track could not be loaded.
+			@param audioURL The URL that failed to load.
+			@param error A description of what went wrong.
+		*/
+		virtual void trackLoadFailed(const URL &audioURL, const String &error) = 0;
+	};
+
+	/**
+		Constructor.
+		@param formatManager The AudioFormatManager object used for creating readers.
+		@param decodedCache The cache of decoded tracks shared by the decks and the playlist.
+	*/
+	TrackLoader(AudioFormatManager &formatManager, DecodedTrackCache &decodedCache);
+
+	/**
+		Destructor. Waits for any running jobs to stop.
+	*/
+	~TrackLoader();
+
+	/**
+		Starts loading a track in the background. Any load that is still pending for
+		the same listener is cancelled, so only the most recent request is delivered.
+		@param audioURL The URL of the audio file to load.
+		@param listener The listener that will receive the result on the message thread.
+		@param decodeIntoMemory Whether to decode the whole track into memory, using the cache if it was decoded before.
+	*/
+	void loadTrack(const URL &audioURL, Listener *listener, bool decodeIntoMemory = false);
+
+	/**
+		Decodes a track into the cache in the background, so that loading it into a
+		deck later is instant. Does nothing if the track is already cached, or if no
+		listener decodes into memory, since only those loads read from the cache.
+
+		Only one prefetch is kept: a new one replaces the one that is waiting and
+		cancels the one that is running. A prefetch waits until no load is pending,
+		and a load stops the running prefetch and puts it back to wait, so it never
+		holds up a deck.
+		@param audioURL The URL of the audio file to decode.
+	*/
+	void prefetch(const URL &audioURL);
+
+	/**
+		Tells the loader whether a listener's loads decode into memory, which is what
+		decides whether prefetching is worth it. Call it with false before the listener is deleted.
+		@param listener The listener.
+		@param decodes True if the listener's loads decode into memory.
+	*/
+	void setDecodingIntoMemory(Listener *listener, bool decodes);
+
+	/**
+		Cancels any pending load for a listener. Must be called before the listener is deleted.
+		@param listener The listener whose loads should be cancelled.
+	*/
+	void cancelLoads(Listener *listener);
+
+private:
+	class LoadJob;
+
+	// A pending request, only touched on the message thread.
+	struct Request
+	{
+		int id;
+		std::shared_ptr<std::atomic<bool>> cancelled;
+	};
+
+	void startPrefetch();
+	void cancelPrefetch();
+	void pausePrefetch();
+	void jobProgress(Listener *listener, int requestId, double progress);
+	void jobFinished(Listener *listener, int requestId, std::shared_ptr<LoadedTrack> track, const String &error);
+
+	AudioFormatManager &formatManager; // Reference to the AudioFormatManager object
+	DecodedTrackCache &decodedCache;   // Decoded tracks shared between loads
+	ThreadPool pool{2};				   // Workers that open and read the files
+	std::map<Listener *, Request> pendingRequests; // The current request for each listener
+	int nextRequestId = 1;						   // Identifies requests so stale results are ignored
+	std::set<Listener *> decodingListeners;		   // Listeners whose loads decode into memory
+	URL waitingPrefetch;						   // The prefetch waiting for the loads to finish, empty if none
+	URL runningPrefetch;						   // The prefetch that was started last
+	std::shared_ptr<std::atomic<bool>> prefetchCancelled; // Cancels the running prefetch, nullptr if none was started
+
+	JUCE_DECLARE_WEAK_REFERENCEABLE(TrackLoader)
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackLoader)
+};
@@ -0,0 +1,556 @@
+/*
+  ==============================================================================
+
+    TrackTable.cpp
+    Created: 20 Oct 2026 6:02:37pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "TrackTable.h"
+#include <numeric>
+
+// Keys sort round the Camelot wheel, minor before major at each number, then tracks with no key.
+static int getKeySortOrder(int key)
+{
+    TrackAnalysis analysis;
+    analysis.key = key;
+    return analysis.hasKey() ? analysis.getCamelotNumber() * 2 + (key < 12 ? 1 : 0) : 100;
+}
+
+// The title shown for a track: its tag, or the file name while the tags are unread or the tag is empty.
+static String getTitle(const LibraryTrack &track)
+{
+    return track.tags.isRead && track.tags.title.isNotEmpty() ? track.tags.title : track.file.getFileNameWithoutExtension();
+}
+
+// Splits a string into its characters, so they can be indexed without walking the UTF-8 each time.
+static std::vector<juce_wchar> toCharacters(const String &text)
+{
+    std::vector<juce_wchar> characters;
+
+    for (auto pointer = text.getCharPointer(); !pointer.isEmpty();)
+    {
+        characters.push_back(pointer.getAndAdvance());
+    }
+
+    return characters;
+}
+
+// Packs one to three characters into an index key. Word prefixes are flagged, so they never clash with trigrams.
+static uint64 makeNgramKey(const juce_wchar *characters, int length, bool isWordPrefix)
+{
+    uint64 key = isWordPrefix ? (uint64)1 << 63 : 0;
+
+    for (int i = 0; i < length; ++i)
+    {
+        key |= (uint64)(characters[i] & 0x1fffff) << (21 * i);
+    }
+
+    return key;
+}
+
+// Whether a lower-case string matches a search word: anywhere for longer words, at the start of a word for short ones.
+static bool matchesWord(const String &lowerText, const String &word)
+{
+    if (word.length() >= 3)
+    {
+        return lowerText.contains(word);
+    }
+
+    for (auto index = lowerText.indexOf(word); index >= 0; index = lowerText.indexOf(index + 1, word))
+    {
+        if (index == 0 || !CharacterFunctions::isLetterOrDigit(lowerText[index - 1]))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool TrackTable::Search::isEmpty() const
+{
+    return words.isEmpty() && maxBpm <= 0.0f && key < 0;
+}
+
+void TrackTable::setTracks(const std::vector<LibraryTrack> &tracks, const TrackAnalyser &analyser)
+{
+    // Rebuild every column, starting a new string pool so removed tracks don't leave strings behind.
+    strings.clear();
+    lowerStrings.clear();
+    stringIds.clear();
+    ngramIndex.clear();
+    files.clear();
+    titles.clear();
+    artists.clear();
+    albums.clear();
+    fileNames.clear();
+    lengths.clear();
+    bpms.clear();
+    keys.clear();
+    bitrates.clear();
+    sizes.clear();
+    rowsByFile.clear();
+
+    for (const auto &track : tracks)
+    {
+        // The key comes from the size and time in the index, so no file is read.
+        TrackAnalysis analysis;
+        analyser.find(DecodedTrackCache::makeKey(track.file, track.size, track.modificationTime), analysis);
+
+        rowsByFile[track.file] = (int)files.size();
+        files.push_back(track.file);
+        titles.push_back(intern(getTitle(track)));
+        artists.push_back(intern(track.tags.artist));
+        albums.push_back(intern(track.tags.album));
+        fileNames.push_back(intern(track.file.getFileName()));
+        lengths.push_back((float)track.tags.lengthSeconds);
+        bpms.push_back((float)analysis.bpm);
+        keys.push_back((int8)analysis.key);
+        bitrates.push_back(track.tags.bitrate);
+        sizes.push_back(track.size);
+    }
+
+    markStale({title, artist, album, length, bpm, key, bitrate, size});
+    updateMatches(false);
+    updateView();
+}
+
+int TrackTable::setTags(const LibraryTrack &track)
+{
+    // Only the changed columns have to be sorted again.
+    const auto it = rowsByFile.find(track.file);
+
+    if (it == rowsByFile.end())
+    {
+        return -1;
+    }
+
+    const auto row = (size_t)it->second;
+    titles[row] = intern(getTitle(track));
+    artists[row] = intern(track.tags.artist);
+    albums[row] = intern(track.tags.album);
+    lengths[row] = (float)track.tags.lengthSeconds;
+    bitrates[row] = track.tags.bitrate;
+    markStale({title, artist, album, length, bitrate});
+    updateMatch(row);
+    return getViewPosition(it->second);
+}
+
+int TrackTable::setAnalysis(const File &file, const TrackAnalysis &analysis)
+{
+    // Only the changed columns have to be sorted again.
+    const auto it = rowsByFile.find(file);
+
+    if (it == rowsByFile.end())
+    {
+        return -1;
+    }
+
+    bpms[(size_t)it->second] = (float)analysis.bpm;
+    keys[(size_t)it->second] = (int8)analysis.key;
+    markStale({bpm, key});
+    updateMatch((size_t)it->second);
+    return getViewPosition(it->second);
+}
+
+void TrackTable::sort(Column column, bool forwards)
+{
+    if (column < 0 || column >= numColumns)
+    {
+        std::cout << "TrackTable::Invalid column: " << column << std::endl;
+        return;
+    }
+
+    sortColumn = column;
+    sortForwards = forwards;
+    updateView();
+}
+
+void TrackTable::setSearch(const String &text)
+{
+    // Typing more of a search only ever narrows it, so only the rows that matched so far are checked again.
+    // That doesn't hold for field filters, or when a short word, matched at word starts, becomes a long one.
+    const auto newSearch = parseSearch(text);
+    auto narrows = text.startsWith(searchText) && !text.containsChar(':') && !searchText.containsChar(':') && !search.words.isEmpty();
+
+    if (narrows && !CharacterFunctions::isWhitespace(searchText.getLastCharacter()))
+    {
+        const auto &lastWord = search.words[search.words.size() - 1];
+        const auto &extendedWord = newSearch.words[search.words.size() - 1];
+        narrows = lastWord.length() >= 3 || extendedWord.length() < 3;
+    }
+
+    search = newSearch;
+    searchText = text;
+    updateMatches(narrows);
+    updateView();
+}
+
+int TrackTable::getNumRows() const
+{
+    return (int)view.size();
+}
+
+File TrackTable::getFile(int position) const
+{
+    return isPositiveAndBelow(position, (int)view.size()) ? files[(size_t)view[(size_t)position]] : File();
+}
+
+String TrackTable::getText(int position, Column column) const
+{
+    // Numbers are only turned into text here, for the rows that are painted.
+    if (!isPositiveAndBelow(position, (int)view.size()))
+    {
+        return {};
+    }
+
+    const auto row = (size_t)view[(size_t)position];
+
+    switch (column)
+    {
+    case title:
+        return strings[(size_t)titles[row]];
+    case artist:
+        return strings[(size_t)artists[row]];
+    case album:
+        return strings[(size_t)albums[row]];
+    case length:
+    {
+        const auto seconds = roundToInt(lengths[row]);
+        return seconds > 0 ? String(seconds / 60) + ":" + String(seconds % 60).paddedLeft('0', 2) : String();
+    }
+    case bpm:
+        return bpms[row] > 0.0f ? String(bpms[row], 1) : String();
+    case key:
+    {
+        TrackAnalysis analysis;
+        analysis.key = keys[row];
+        return analysis.getCamelot();
+    }
+    case bitrate:
+        return bitrates[row] > 0 ? String(bitrates[row]) : String();
+    case size:
+        return String(sizes[row] / 10000);
+    default:
+        return {};
+    }
+}
+
+TrackTable::Search TrackTable::parseSearch(const String &text)
+{
+    // Words are searched for in lower case; "bpm:" and "key:" words are filters.
+    Search result;
+
+    for (const auto &token : StringArray::fromTokens(text.toLowerCase(), " \t", ""))
+    {
+        const auto value = token.fromFirstOccurrenceOf(":", false, false);
+
+        if (token.startsWith("bpm:"))
+        {
+            // A single tempo matches anything that rounds to it.
+            const auto low = value.upToFirstOccurrenceOf("-", false, false).getFloatValue();
+            const auto high = value.containsChar('-') ? value.fromFirstOccurrenceOf("-", false, false).getFloatValue() : low;
+            const auto margin = value.containsChar('-') ? 0.0f : 0.5f;
+
+            if (low > 0.0f)
+            {
+                result.minBpm = low - margin;
+                result.maxBpm = jmax(low, high) + margin;
+            }
+        }
+        else if (token.startsWith("key:"))
+        {
+            // Keys can be given in Camelot notation or by name.
+            for (int key = 0; key < 24; ++key)
+            {
+                TrackAnalysis analysis;
+                analysis.key = key;
+
+                if (value.equalsIgnoreCase(analysis.getCamelot()) || value.equalsIgnoreCase(analysis.getKeyName()))
+                {
+                    result.key = key;
+                }
+            }
+        }
+        else
+        {
+            result.words.add(token);
+        }
+    }
+
+    return result;
+}
+
+std::vector<bool> TrackTable::findStrings(const String &word) const
+{
+    // Look up the word's rarest trigram, or its prefix for short words, and check only the strings that have it.
+    std::vector<bool> found(strings.size(), false);
+    const auto characters = toCharacters(word);
+    const std::vector<int> *candidates = nullptr;
+
+    if (characters.size() >= 3)
+    {
+        for (size_t i = 0; i + 3 <= characters.size(); ++i)
+        {
+            const auto it = ngramIndex.find(makeNgramKey(characters.data() + i, 3, false));
+
+            if (it == ngramIndex.end())
+            {
+                return found;
+            }
+
+            if (candidates == nullptr || it->second.size() < candidates->size())
+            {
+                candidates = &it->second;
+            }
+        }
+    }
+    else if (!characters.empty())
+    {
+        const auto it = ngramIndex.find(makeNgramKey(characters.data(), (int)characters.size(), true));
+        candidates = it != ngramIndex.end() ? &it->second : nullptr;
+    }
+
+    if (candidates != nullptr)
+    {
+        for (const auto id : *candidates)
+        {
+            found[(size_t)id] = characters.size() < 3 || lowerStrings[(size_t)id].contains(word);
+        }
+    }
+
+    return found;
+}
+
+void TrackTable::updateMatches(bool narrows)
+{
+    // Work out which strings have each word once, then check each row's four strings against them.
+    if (!narrows || matches.size() != files.size())
+    {
+        matches.assign(files.size(), true);
+    }
+
+    if (search.isEmpty())
+    {
+        return;
+    }
+
+    for (const auto &word : search.words)
+    {
+        const auto found = findStrings(word);
+
+        for (size_t row = 0; row < files.size(); ++row)
+        {
+            matches[row] = matches[row] && (found[(size_t)titles[row]] || found[(size_t)artists[row]] || found[(size_t)albums[row]] || found[(size_t)fileNames[row]]);
+        }
+    }
+
+    for (size_t row = 0; row < files.size(); ++row)
+    {
+        matches[row] = matches[row] && matchesFields(row);
+    }
+}
+
+void TrackTable::updateMatch(size_t row)
+{
+    // A row that starts or stops matching the search is shown or hidden, in the order the view already has.
+    const auto isMatch = matchesRow(row);
+
+    if (isMatch != matches[row])
+    {
+        matches[row] = isMatch;
+        updateView(false);
+    }
+}
+
+bool TrackTable::matchesRow(size_t row) const
+{
+    // Check one row without the index, for rows whose tags or analysis just changed.
+    for (const auto &word : search.words)
+    {
+        if (!matchesWord(lowerStrings[(size_t)titles[row]], word) && !matchesWord(lowerStrings[(size_t)artists[row]], word)
+            && !matchesWord(lowerStrings[(size_t)albums[row]], word) && !matchesWord(lowerStrings[(size_t)fileNames[row]], word))
+        {
+            return false;
+        }
+    }
+
+    return matchesFields(row);
+}
+
+bool TrackTable::matchesFields(size_t row) const
+{
+    return (search.maxBpm <= 0.0f || (bpms[row] >= search.minBpm && bpms[row] <= search.maxBpm))
+           && (search.key < 0 || keys[row] == search.key);
+}
+
+int TrackTable::intern(const String &text)
+{
+    // Hand out the same id for every copy of a string.
+    const auto it = stringIds.find(text);
+
+    if (it != stringIds.end())
+    {
+        return it->second;
+    }
+
+    const auto id = (int)strings.size();
+    strings.push_back(text);
+    lowerStrings.push_back(text.toLowerCase());
+    stringIds.emplace(text, id);
+
+    // Index every trigram of the new string, and the first one and two letters of each of its words.
+    // Ids only grow, so each list stays sorted; a string is only listed once under each key.
+    const auto characters = toCharacters(lowerStrings.back());
+    const auto add = [this, id](uint64 key)
+    {
+        auto &ids = ngramIndex[key];
+
+        if (ids.empty() || ids.back() != id)
+        {
+            ids.push_back(id);
+        }
+    };
+
+    for (size_t i = 0; i < characters.size(); ++i)
+    {
+        if (i + 3 <= characters.size())
+        {
+            add(makeNgramKey(characters.data() + i, 3, false));
+        }
+
+        if (i == 0 || !CharacterFunctions::isLetterOrDigit(characters[i - 1]))
+        {
+            add(makeNgramKey(characters.data() + i, 1, true));
+
+            if (i + 1 < characters.size())
+            {
+                add(makeNgramKey(characters.data() + i, 2, true));
+            }
+        }
+    }
+
+    return id;
+}
+
+const std::vector<int> &TrackTable::getSortedRows(Column column)
+{
+    // Work out the order of a column the first time it is needed after it changed.
+    auto &sorted = sortedRows[(size_t)column];
+
+    if (sorted.size() == files.size() && !staleColumns[(size_t)column])
+    {
+        return sorted;
+    }
+
+    staleColumns[(size_t)column] = false;
+
+    sorted.resize(files.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+
+    const auto sortBy = [&sorted](const auto &values)
+    {
+        std::stable_sort(sorted.begin(), sorted.end(), [&values](int a, int b)
+                         { return values[(size_t)a] < values[(size_t)b]; });
+    };
+
+    if (column == title || column == artist || column == album)
+    {
+        // Strings are compared once each to rank them, then the rows are sorted by rank.
+        std::vector<int> byText(strings.size());
+        std::iota(byText.begin(), byText.end(), 0);
+        std::sort(byText.begin(), byText.end(), [this](int a, int b)
+                  { return strings[(size_t)a].compareNatural(strings[(size_t)b]) < 0; });
+
+        std::vector<int> ranks(strings.size());
+
+        for (size_t i = 0; i < byText.size(); ++i)
+        {
+            ranks[(size_t)byText[i]] = (int)i;
+        }
+
+        const auto &ids = column == title ? titles : column == artist ? artists : albums;
+        std::vector<int> rowRanks(files.size());
+
+        for (size_t row = 0; row < files.size(); ++row)
+        {
+            rowRanks[row] = ranks[(size_t)ids[row]];
+        }
+
+        sortBy(rowRanks);
+    }
+    else if (column == key)
+    {
+        std::vector<int> keyOrder(files.size());
+
+        for (size_t row = 0; row < files.size(); ++row)
+        {
+            keyOrder[row] = getKeySortOrder(keys[row]);
+        }
+
+        sortBy(keyOrder);
+    }
+    else if (column == length)
+    {
+        sortBy(lengths);
+    }
+    else if (column == bpm)
+    {
+        sortBy(bpms);
+    }
+    else if (column == bitrate)
+    {
+        sortBy(bitrates);
+    }
+    else
+    {
+        sortBy(sizes);
+    }
+
+    return sorted;
+}
+
+void TrackTable::markStale(std::initializer_list<Column> columns)
+{
+    // The old order is kept, so rows can be shown or hidden without sorting again.
+    for (const auto column : columns)
+    {
+        staleColumns[(size_t)column] = true;
+    }
+}
+
+void TrackTable::updateView(bool resort)
+{
+    // Show the matching rows in the sorted order, reading the permutation backwards for a descending sort.
+    // Without resorting, a column whose values changed keeps the order it had.
+    const auto &current = sortedRows[(size_t)sortColumn];
+    const auto &sorted = !resort && current.size() == files.size() ? current : getSortedRows(sortColumn);
+    view.clear();
+    viewPositions.assign(files.size(), -1);
+
+    const auto show = [this](int row)
+    {
+        if (matches[(size_t)row])
+        {
+            viewPositions[(size_t)row] = (int)view.size();
+            view.push_back(row);
+        }
+    };
+
+    if (sortForwards)
+    {
+        std::for_each(sorted.begin(), sorted.end(), show);
+    }
+    else
+    {
+        std::for_each(sorted.rbegin(), sorted.rend(), show);
+    }
+}
+
+int TrackTable::getViewPosition(int row) const
+{
+    return isPositiveAndBelow(row, (int)viewPositions.size()) ? viewPositions[(size_t)row] : -1;
+}
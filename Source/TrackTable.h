@@ -0,0 +1,162 @@
+/*
+	==============================================================================
+
+	TrackTable.h
+	Created: 20 Oct 2026 6:02:37pm
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "TrackLibrary.h"
+#include "TrackAnalyser.h"
+
+/**
+	The tracks shown in the playlist, stored a column at a time.
+
+	Text columns hold ids into a pool of interned strings, so an artist on a hundred
+	tracks is stored once, and numeric columns hold plain numbers. Sorting by a column
+	uses a permutation of the rows that is worked out the first time the column is
+	sorted and kept until the column changes; sorting the other way reads the same
+	permutation backwards. Text is only formatted for the rows that are painted.
+
+	The table shows a view of the rows: the rows that match the search, in their sorted
+	order. Rows are addressed by their position in the view, which is what the
+	TableListBox asks for.
+
+	Searches look for every word of the search in the title, artist, album or file name,
+	through an n-gram index over the interned strings. Words of three or more letters
+	match anywhere: the string ids for one of the word's trigrams are looked up and only
+	those strings are checked. Shorter words match the start of a word in the string,
+	through an index of the first one and two letters of every word. Since the index is
+	over distinct strings rather than rows, an artist on many tracks is checked once.
+	A search can also filter by field: "bpm:120-128" or "bpm:124" for the tempo, and
+	"key:8A" or "key:Am" for the key.
+*/
+class TrackTable
+{
+public:
+	/** The columns of the table. */
+	enum Column
+	{
+		title,
+		artist,
+		album,
+		length,
+		bpm,
+		key,
+		bitrate,
+		size,
+		numColumns
+	};
+
+	/**
+		Replaces the rows with the tracks in the library, keeping the analysis of tracks
+		that have been analysed, and sorts them by the current column.
+		@param tracks The tracks in the library.
+		@param analyser Used to look up the analysis of each track, in memory.
+	*/
+	void setTracks(const std::vector<LibraryTrack> &tracks, const TrackAnalyser &analyser);
+
+	/**
+		Updates the tags of a track. The track stays where it is until the table is sorted again,
+		but is shown or hidden straight away if it starts or stops matching the search, which
+		changes the number of rows.
+		@param track The track, with its tags.
+		@return The track's position in the view, or -1 if it isn't in the view.
+	*/
+	int setTags(const LibraryTrack &track);
+
+	/**
+		Updates the analysis of a track. The track stays where it is until the table is sorted again,
+		but is shown or hidden straight away if it starts or stops matching the search, which
+		changes the number of rows.
+		@param file The track.
+		@param analysis The track's analysis.
+		@return The track's position in the view, or -1 if it isn't in the view.
+	*/
+	int setAnalysis(const File &file, const TrackAnalysis &analysis);
+
+	/**
+		Sorts the view by a column.
+		@param column The column to sort by.
+		@param forwards True for ascending, false for descending.
+	*/
+	void sort(Column column, bool forwards);
+
+	/**
+		Shows only the tracks that match a search, keeping the sort order.
+		@param text The search, as typed. An empty search shows every track.
+	*/
+	void setSearch(const String &text);
+
+	/**
+		Returns the number of rows in the view.
+	*/
+	int getNumRows() const;
+
+	/**
+		Returns the file of a row.
+		@param position The row's position in the view.
+	*/
+	File getFile(int position) const;
+
+	/**
+		Returns the text of a cell, formatted for display.
+		@param position The row's position in the view.
+		@param column The column.
+	*/
+	String getText(int position, Column column) const;
+
+private:
+	/** A search, split into its words and field filters. */
+	struct Search
+	{
+		StringArray words;	   // Words to find, in lower case
+		float minBpm = 0.0f;   // Lowest tempo, if filtering by tempo
+		float maxBpm = 0.0f;   // Highest tempo, 0 if not filtering by tempo
+		int key = -1;		   // Key to filter by, -1 if not filtering by key
+		bool isEmpty() const;
+	};
+
+	static Search parseSearch(const String &text);
+	std::vector<bool> findStrings(const String &word) const;
+	void updateMatches(bool narrows);
+	void updateMatch(size_t row);
+	bool matchesRow(size_t row) const;
+	bool matchesFields(size_t row) const;
+	int intern(const String &text);
+	const std::vector<int> &getSortedRows(Column column);
+	void markStale(std::initializer_list<Column> columns);
+	void updateView(bool resort = true);
+	int getViewPosition(int row) const;
+
+	std::vector<String> strings;				   // Every distinct string in the text columns, once
+	std::vector<String> lowerStrings;			   // Each string in lower case, for searching
+	std::unordered_map<String, int> stringIds;	   // The id of each string in strings
+	std::unordered_map<uint64, std::vector<int>> ngramIndex; // Ids of the strings with each trigram or word prefix, in order
+
+	std::vector<File> files;					   // The file of each row
+	std::vector<int> titles;					   // Title string id of each row
+	std::vector<int> artists;					   // Artist string id of each row
+	std::vector<int> albums;					   // Album string id of each row
+	std::vector<int> fileNames;					   // File name string id of each row
+	std::vector<float> lengths;					   // Length of each row in seconds
+	std::vector<float> bpms;					   // Tempo of each row, 0 if it hasn't been analysed
+	std::vector<int8> keys;						   // Key of each row as in TrackAnalysis, -1 if unknown
+	std::vector<int> bitrates;					   // Average bitrate of each row in kbit/s
+	std::vector<int64> sizes;					   // File size of each row in bytes
+	std::map<File, int> rowsByFile;				   // The row of each file
+
+	std::array<std::vector<int>, numColumns> sortedRows; // Rows in ascending order of each column, empty until needed
+	std::array<bool, numColumns> staleColumns{};	   // Whether each column changed since it was last sorted
+	String searchText;							   // The current search, as typed
+	Search search;								   // The current search, parsed
+	std::vector<bool> matches;					   // Whether each row matches the search
+	std::vector<int> view;						   // The matching rows in the order they are shown
+	std::vector<int> viewPositions;				   // The position of each row in the view, -1 if it doesn't match
+	Column sortColumn = title;					   // The column the view is sorted by
+	bool sortForwards = true;					   // Whether the view is sorted ascending
+};
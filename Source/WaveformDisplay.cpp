@@ -14,12 +14,16 @@
 
 //==============================================================================
 WaveformDisplay::WaveformDisplay(AudioFormatManager& formatManagerToUse, 
-                                 AudioThumbnailCache& cacheToUse) 
+                                 AudioThumbnailCache& cacheToUse,
+                                 WaveformStore& storeToUse) 
                                 : audioThumbnail(512, formatManagerToUse, cacheToUse), 
+                                  waveformStore(storeToUse),
                                   fileLoaded(false),
                                   position(0.0)
 {
 	audioThumbnail.addChangeListener(this);
+	// Every pixel is painted, so nothing behind the display has to be redrawn with it
+	setOpaque(true);
 }
 
 WaveformDisplay::~WaveformDisplay()
@@ -29,27 +33,19 @@ WaveformDisplay::~WaveformDisplay()
 // Paint method to draw the waveform display
 void WaveformDisplay::paint (juce::Graphics& g)
 {
-    // Clear the background
-    g.fillAll (Colour::fromRGB(13, 27, 42));   
-
-    // Draw an outline around the component
-    g.setColour (Colour::fromRGB(119, 141, 169));
-    g.drawRect (getLocalBounds(), 1);   
-
-    // Set the colour to light grey
-    g.setColour (Colour::fromRGB(224, 225, 221));
-
     // Check if a file is loaded
     if (fileLoaded) 
     {
+        // The waveform only changes when a track loads or the size changes, so it is drawn once into an image
+        if (waveformImage.isNull())
+        {
+            renderWaveformImage();
+        }
+        g.drawImageAt(waveformImage, 0, 0);
         // Set the fill colour to grey with 40% opacity
         g.setColour(Colour::fromRGB(224, 225, 221).withAlpha(0.4f)); 
         // Tint the left side of the waveform display grey
         g.fillRect(0, 0, position * getWidth(), getHeight()); 
-        // Set the colour to light blue
-        g.setColour(Colour::fromRGB(119, 141, 169));
-        // Draw the audio waveform
-        audioThumbnail.drawChannels(g, getLocalBounds(), 0.0, audioThumbnail.getTotalLength(), 1.0f);
         // Set the colour to white
         g.setColour(Colours::white);
         // Draw a vertical line at the current position
@@ -57,6 +53,15 @@ void WaveformDisplay::paint (juce::Graphics& g)
     }
     else
     {
+        // Clear the background
+        g.fillAll (Colour::fromRGB(13, 27, 42));   
+
+        // Draw an outline around the component
+        g.setColour (Colour::fromRGB(119, 141, 169));
+        g.drawRect (getLocalBounds(), 1);   
+
+        // Set the colour to light grey
+        g.setColour (Colour::fromRGB(224, 225, 221));
         // Set the font size to 20
         g.setFont (juce::FontOptions (20.0f));
         // Draw placeholder text indicating that no file is loaded
@@ -66,9 +71,44 @@ void WaveformDisplay::paint (juce::Graphics& g)
     }
 }
 
-void WaveformDisplay::resized()
+// Draw the background, the outline and the whole waveform into the cached image
+void WaveformDisplay::renderWaveformImage()
 {
+    waveformImage = Image(Image::RGB, jmax(1, getWidth()), jmax(1, getHeight()), false);
+    Graphics g(waveformImage);
+
+    g.fillAll(Colour::fromRGB(13, 27, 42));
+    g.setColour(Colour::fromRGB(119, 141, 169));
+    g.drawRect(getLocalBounds(), 1);
 
+    // Draw the audio waveform, from the stored overview if there is one
+    if (overview != nullptr)
+    {
+        overview->draw(g, getLocalBounds(), 0.0, (double)overview->getLengthInSamples() / jmax(1, getWidth()));
+    }
+    else
+    {
+        audioThumbnail.drawChannels(g, getLocalBounds(), 0.0, audioThumbnail.getTotalLength(), 1.0f);
+    }
+}
+
+// Show a new overview here and in anything that follows this display
+void WaveformDisplay::setOverview(std::shared_ptr<const WaveformOverview> newOverview)
+{
+    overview = std::move(newOverview);
+    waveformImage = Image();
+    repaint();
+
+    if (onOverviewChanged != nullptr)
+    {
+        onOverviewChanged(overview);
+    }
+}
+
+void WaveformDisplay::resized()
+{
+    // The cached waveform is redrawn at the new size
+    waveformImage = Image();
 }
 
 // Load an audio file from a URL
@@ -76,21 +116,65 @@ void WaveformDisplay::loadURL(URL audioURL)
 {
     // Clear the current audio thumbnail
     audioThumbnail.clear();
+    trackKey = 0;
+    setOverview(nullptr);
     // Load the audio file into the thumbnail
     bool fileLoaded = audioThumbnail.setSource(new URLInputSource(audioURL));
 }
 
+// Build the waveform from a track that was opened in the background
+void WaveformDisplay::loadTrack(LoadedTrack &track)
+{
+    // Clear the current audio thumbnail
+    audioThumbnail.clear();
+    trackKey = track.hashCode;
+
+    // A track that was analysed before is drawn from its overview without decoding anything
+    setOverview(waveformStore.find(trackKey));
+
+    if (overview != nullptr)
+    {
+        track.thumbnailReader.reset();
+        fileLoaded = true;
+        return;
+    }
+
+    // Generate the overview in the background for next time, and switch to it when it is ready
+    waveformStore.generate(track.audioURL, trackKey, track.decoded,
+                           [safeThis = Component::SafePointer<WaveformDisplay>(this), key = trackKey](std::shared_ptr<const WaveformOverview> newOverview)
+                           {
+                               if (safeThis != nullptr && safeThis->trackKey == key && newOverview != nullptr)
+                               {
+                                   safeThis->setOverview(newOverview);
+                               }
+                           });
+
+    if (track.thumbnailReader != nullptr)
+    {
+        // The thumbnail reads from its own reader over the same bytes as the player
+        audioThumbnail.setReader(track.thumbnailReader.release(), track.hashCode);
+    }
+    else
+    {
+        // A decoded track has no reader; its overview is built from the samples on the store's worker,
+        // so the message thread never scans the whole track, and the playhead shows until it arrives
+        fileLoaded = true;
+        waveformImage = Image();
+        repaint();
+    }
+}
+
 // Set the playback position relative to the total length
 void WaveformDisplay::setPositionRelative(double pos)
 {
-    // Update the position if it has changed
+    // Update the position, and only repaint the strip between the old and new playhead
+    const int oldX = roundToInt(position * getWidth());
+    const int newX = roundToInt(pos * getWidth());
     position = pos;
-    if (pos != position)
+    if (oldX != newX)
     {
-        position = pos;
+        repaint(jmin(oldX, newX) - 2, 0, std::abs(newX - oldX) + 6, getHeight());
     }
-    // Repaint the component to reflect the new position
-    repaint();
 }
 
 // Callback method for changes in the audio thumbnail
@@ -99,8 +183,9 @@ void WaveformDisplay::changeListenerCallback(ChangeBroadcaster* source)
     // Check if the change source is the audio thumbnail
     if (source == &audioThumbnail)
     {
-        // Set fileLoaded to true and repaint the component
+        // Set fileLoaded to true and redraw the cached waveform
         fileLoaded = true;
+        waveformImage = Image();
         repaint();
     }
 }
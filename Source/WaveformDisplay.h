@@ -11,6 +11,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "TrackLoader.h"
+#include "WaveformStore.h"
 
 //==============================================================================
 /*
@@ -23,9 +25,11 @@ public:
    *
    * @param formatManagerToUse The AudioFormatManager object to use for loading audio files.
    * @param cacheToUse The AudioThumbnailCache object to use for caching audio thumbnails.
+   * @param storeToUse The WaveformStore that keeps precomputed waveforms on disk.
    */
   WaveformDisplay(AudioFormatManager &formatManagerToUse,
-                  AudioThumbnailCache &cacheToUse);
+                  AudioThumbnailCache &cacheToUse,
+                  WaveformStore &storeToUse);
 
   /**
    * @brief Destructs the WaveformDisplay object.
@@ -58,6 +62,18 @@ public:
    */
   void loadURL(URL audioURL);
 
+  /**
+   * @brief Shows the waveform of a track opened by the TrackLoader.
+   *
+   * A track that was analysed before is drawn straight away from its stored overview.
+   * Otherwise the thumbnail is built as before while the overview is generated in the
+   * background, and the display switches to the overview once it is ready. Tracks that
+   * were decoded into memory have no thumbnail reader, so they wait for the overview.
+   *
+   * @param track The loaded track. Its thumbnail reader is taken by the thumbnail.
+   */
+  void loadTrack(LoadedTrack &track);
+
   /**
    * @brief Sets the relative position of the playhead.
    *
@@ -65,8 +81,30 @@ public:
    */
   void setPositionRelative(double pos);
 
+  /**
+   * @brief Called with the stored overview whenever the track or its overview changes.
+   * The overview is nullptr while a track has not been analysed yet.
+   */
+  std::function<void(std::shared_ptr<const WaveformOverview>)> onOverviewChanged;
+
 private:
+  /**
+   * @brief Draws the background and the whole waveform into the cached image.
+   */
+  void renderWaveformImage();
+
+  /**
+   * @brief Replaces the overview, clears the cached image and tells onOverviewChanged.
+   *
+   * @param newOverview The new overview, or nullptr.
+   */
+  void setOverview(std::shared_ptr<const WaveformOverview> newOverview);
+
   AudioThumbnail audioThumbnail; // The audio thumbnail used for displaying the waveform
+  WaveformStore &waveformStore;  // Where precomputed waveforms are kept
+  std::shared_ptr<const WaveformOverview> overview; // The stored overview of the track, if it has one
+  Image waveformImage;           // The waveform drawn once, so moving the playhead doesn't redraw it
+  int64 trackKey = 0;            // Key of the track being shown, so late overviews of other tracks are ignored
   bool fileLoaded;               // Flag indicating whether an audio file is loaded
   double position;               // The relative position of the playhead
 
@@ -0,0 +1,538 @@
+/*
+  ==============================================================================
+
+    WaveformStore.cpp
+    Created: 19 Oct 2026 6:12:40pm
+    Author:  pavelosky
+
+  ==============================================================================
+*/
+
+#include "WaveformStore.h"
+
+// Identifies overview files, and the version of their layout.
+static constexpr int overviewMagic = 0x46574478; // "xDWF" read as a little-endian int
+static constexpr int overviewVersion = 2;
+
+// Band split of the coloured waveform, the same as the deck's isolator.
+static constexpr float lowMidCrossover = 200.0f;
+static constexpr float midHighCrossover = 2500.0f;
+
+// Converts a sum of squares over some samples to an RMS level scaled to 0..255.
+static uint8 toLevel(double sumOfSquares, int numSamples)
+{
+    return (uint8)jlimit(0, 255, roundToInt(std::sqrt(sumOfSquares / jmax(1, numSamples)) * 255.0));
+}
+
+//==============================================================================
+// Builds the levels of an overview from blocks of samples.
+class OverviewBuilder
+{
+public:
+    OverviewBuilder(double sampleRate, int maximumBlockSize)
+    {
+        // The bands are split from a mono mix with Linkwitz-Riley crossovers.
+        lowCrossover.setType(dsp::LinkwitzRileyFilterType::lowpass);
+        highCrossover.setType(dsp::LinkwitzRileyFilterType::lowpass);
+        lowCrossover.setCutoffFrequency(lowMidCrossover);
+        highCrossover.setCutoffFrequency(midHighCrossover);
+        lowCrossover.prepare({sampleRate, (uint32)maximumBlockSize, 1});
+        highCrossover.prepare({sampleRate, (uint32)maximumBlockSize, 1});
+        mono.setSize(1, maximumBlockSize);
+    }
+
+    void addSamples(const float *const *channels, int numChannels, int numSamples)
+    {
+        // Mix down once for the band analysis.
+        auto *monoData = mono.getWritePointer(0);
+        FloatVectorOperations::copyWithMultiply(monoData, channels[0], 1.0f / numChannels, numSamples);
+
+        for (int chan = 1; chan < numChannels; ++chan)
+        {
+            FloatVectorOperations::addWithMultiply(monoData, channels[chan], 1.0f / numChannels, numSamples);
+        }
+
+        // Fill the current bucket with as many samples as fit, then start the next one.
+        for (int offset = 0; offset < numSamples;)
+        {
+            const auto num = jmin(numSamples - offset, WaveformOverview::baseSamplesPerBucket - bucketLength);
+
+            for (int i = offset; i < offset + num; ++i)
+            {
+                float lowBand, rest, midBand, highBand;
+                lowCrossover.processSample(0, monoData[i], lowBand, rest);
+                highCrossover.processSample(0, rest, midBand, highBand);
+                bandSquares[0] += lowBand * lowBand;
+                bandSquares[1] += midBand * midBand;
+                bandSquares[2] += highBand * highBand;
+            }
+
+            for (int chan = 0; chan < numChannels; ++chan)
+            {
+                const auto *data = channels[chan] + offset;
+                const auto range = FloatVectorOperations::findMinAndMax(data, num);
+                bucketMin = jmin(bucketMin, range.getStart());
+                bucketMax = jmax(bucketMax, range.getEnd());
+
+                for (int i = 0; i < num; ++i)
+                {
+                    bucketSquares += (double)data[i] * data[i] / numChannels;
+                }
+            }
+
+            bucketLength += num;
+            offset += num;
+
+            if (bucketLength == WaveformOverview::baseSamplesPerBucket)
+            {
+                finishBucket();
+            }
+        }
+    }
+
+    void finish()
+    {
+        // Keep the partial bucket at the end of the track.
+        if (bucketLength > 0)
+        {
+            finishBucket();
+        }
+
+        // Each level combines groups of buckets from the level below it.
+        for (int level = 1; level < WaveformOverview::numLevels; ++level)
+        {
+            const auto &below = levels[(size_t)level - 1];
+            auto &current = levels[(size_t)level];
+
+            for (size_t start = 0; start < below.size(); start += WaveformOverview::levelRatio)
+            {
+                const auto end = jmin(below.size(), start + WaveformOverview::levelRatio);
+                WaveformOverview::Bucket bucket{127, -127, 0, 0, 0, 0, {0, 0}};
+                double squares = 0.0, lowSquares = 0.0, midSquares = 0.0, highSquares = 0.0;
+
+                for (auto i = start; i < end; ++i)
+                {
+                    bucket.min = jmin(bucket.min, below[i].min);
+                    bucket.max = jmax(bucket.max, below[i].max);
+                    squares += (double)below[i].rms * below[i].rms;
+                    lowSquares += (double)below[i].low * below[i].low;
+                    midSquares += (double)below[i].mid * below[i].mid;
+                    highSquares += (double)below[i].high * below[i].high;
+                }
+
+                // The levels are already scaled, so average them back on that scale.
+                const auto count = (int)(end - start);
+                bucket.rms = toLevel(squares / (255.0 * 255.0), count);
+                bucket.low = toLevel(lowSquares / (255.0 * 255.0), count);
+                bucket.mid = toLevel(midSquares / (255.0 * 255.0), count);
+                bucket.high = toLevel(highSquares / (255.0 * 255.0), count);
+                current.push_back(bucket);
+            }
+        }
+    }
+
+    bool write(OutputStream &out, double sampleRate, int64 lengthInSamples) const
+    {
+        // Header, then the table of levels, then the buckets of each level.
+        const auto headerSize = 28 + WaveformOverview::numLevels * 16;
+        int64 offset = headerSize;
+
+        out.writeInt(overviewMagic);
+        out.writeInt(overviewVersion);
+        out.writeDouble(sampleRate);
+        out.writeInt64(lengthInSamples);
+        out.writeInt(WaveformOverview::numLevels);
+
+        for (int level = 0; level < WaveformOverview::numLevels; ++level)
+        {
+            const auto &buckets = levels[(size_t)level];
+            out.writeInt(getSamplesPerBucket(level));
+            out.writeInt((int)buckets.size());
+            out.writeInt64(offset);
+            offset += (int64)(buckets.size() * sizeof(WaveformOverview::Bucket));
+        }
+
+        for (const auto &buckets : levels)
+        {
+            if (!buckets.empty() && !out.write(buckets.data(), buckets.size() * sizeof(WaveformOverview::Bucket)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static int getSamplesPerBucket(int level)
+    {
+        auto samplesPerBucket = WaveformOverview::baseSamplesPerBucket;
+
+        for (int i = 0; i < level; ++i)
+        {
+            samplesPerBucket *= WaveformOverview::levelRatio;
+        }
+
+        return samplesPerBucket;
+    }
+
+private:
+    void finishBucket()
+    {
+        levels[0].push_back({(int8)jlimit(-127, 127, roundToInt(bucketMin * 127.0f)),
+                             (int8)jlimit(-127, 127, roundToInt(bucketMax * 127.0f)),
+                             toLevel(bucketSquares, bucketLength),
+                             toLevel(bandSquares[0], bucketLength),
+                             toLevel(bandSquares[1], bucketLength),
+                             toLevel(bandSquares[2], bucketLength),
+                             {0, 0}});
+
+        bucketMin = 1.0f;
+        bucketMax = -1.0f;
+        bucketSquares = 0.0;
+        bandSquares.fill(0.0);
+        bucketLength = 0;
+    }
+
+    std::array<std::vector<WaveformOverview::Bucket>, WaveformOverview::numLevels> levels; // Buckets of each level, finest first
+    float bucketMin = 1.0f;                                                                // Lowest sample of the current bucket
+    float bucketMax = -1.0f;                                                               // Highest sample of the current bucket
+    double bucketSquares = 0.0;                                                            // Sum of squares of the current bucket
+    std::array<double, 3> bandSquares{};                                                   // Sum of squares of each band in the current bucket
+    int bucketLength = 0;                                                                  // Samples in the current bucket so far
+    dsp::LinkwitzRileyFilter<float> lowCrossover;                                          // Splits off the low band
+    dsp::LinkwitzRileyFilter<float> highCrossover;                                         // Splits the rest into mid and high
+    AudioBuffer<float> mono;                                                               // Mono mix of the block being analysed
+};
+
+//==============================================================================
+WaveformOverview::WaveformOverview(std::unique_ptr<MemoryMappedFile> mappedFile) : file(std::move(mappedFile))
+{
+    // Constructor for WaveformOverview class.
+}
+
+std::shared_ptr<const WaveformOverview> WaveformOverview::open(const File &overviewFile)
+{
+    // Map the file and check its header before handing it out.
+    if (!overviewFile.existsAsFile())
+    {
+        return nullptr;
+    }
+
+    auto mappedFile = std::make_unique<MemoryMappedFile>(overviewFile, MemoryMappedFile::readOnly);
+
+    if (mappedFile->getData() == nullptr)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<WaveformOverview> overview(new WaveformOverview(std::move(mappedFile)));
+
+    if (!overview->readHeader())
+    {
+        std::cout << "WaveformOverview::Invalid overview file: " << overviewFile.getFullPathName() << std::endl;
+        return nullptr;
+    }
+
+    return overview;
+}
+
+bool WaveformOverview::readHeader()
+{
+    // Read the header and point each level at its buckets in the mapped file.
+    const auto *data = static_cast<const char *>(file->getData());
+    const auto size = (int64)file->getSize();
+    MemoryInputStream in(data, (size_t)size, false);
+
+    if (in.readInt() != overviewMagic || in.readInt() != overviewVersion)
+    {
+        return false;
+    }
+
+    sampleRate = in.readDouble();
+    lengthInSamples = in.readInt64();
+
+    if (in.readInt() != numLevels || sampleRate <= 0.0 || lengthInSamples <= 0)
+    {
+        return false;
+    }
+
+    for (auto &level : levels)
+    {
+        level.samplesPerBucket = in.readInt();
+        level.numBuckets = in.readInt();
+        const auto offset = in.readInt64();
+
+        if (level.samplesPerBucket <= 0 || level.numBuckets < 0 || offset < 0 || offset + (int64)level.numBuckets * (int64)sizeof(Bucket) > size)
+        {
+            return false;
+        }
+
+        level.buckets = reinterpret_cast<const Bucket *>(data + offset);
+    }
+
+    return true;
+}
+
+double WaveformOverview::getSampleRate() const
+{
+    return sampleRate;
+}
+
+int64 WaveformOverview::getLengthInSamples() const
+{
+    return lengthInSamples;
+}
+
+int WaveformOverview::getSamplesPerBucket(int level) const
+{
+    return levels[(size_t)level].samplesPerBucket;
+}
+
+int WaveformOverview::getNumBuckets(int level) const
+{
+    return levels[(size_t)level].numBuckets;
+}
+
+const WaveformOverview::Bucket *WaveformOverview::getBuckets(int level) const
+{
+    return levels[(size_t)level].buckets;
+}
+
+int WaveformOverview::getLevelForResolution(double samplesPerPixel) const
+{
+    // Coarser levels are cheaper to draw, as long as they still fill every pixel.
+    for (int level = numLevels - 1; level > 0; --level)
+    {
+        if (levels[(size_t)level].samplesPerBucket <= samplesPerPixel)
+        {
+            return level;
+        }
+    }
+
+    return 0;
+}
+
+void WaveformOverview::draw(Graphics &g, Rectangle<int> area, double startSample, double samplesPerPixel) const
+{
+    // Work in buckets of the level that has about one bucket per pixel.
+    const auto level = getLevelForResolution(samplesPerPixel);
+    const auto *buckets = getBuckets(level);
+    const auto numBuckets = getNumBuckets(level);
+    const auto bucketsPerPixel = samplesPerPixel / getSamplesPerBucket(level);
+    const auto firstBucket = startSample / getSamplesPerBucket(level);
+    const auto centre = (float)area.getCentreY();
+    const auto halfHeight = area.getHeight() * 0.5f;
+
+    for (int x = 0; x < area.getWidth(); ++x)
+    {
+        const auto start = firstBucket + x * bucketsPerPixel;
+
+        if (start < 0.0 || start >= numBuckets)
+        {
+            continue;
+        }
+
+        const auto first = (int)start;
+        const auto last = jmin(numBuckets, jmax(first + 1, (int)(start + bucketsPerPixel)));
+        int low = 127, high = -127, rms = 0;
+        float lowBand = 0.0f, midBand = 0.0f, highBand = 0.0f;
+
+        for (int i = first; i < last; ++i)
+        {
+            low = jmin(low, (int)buckets[i].min);
+            high = jmax(high, (int)buckets[i].max);
+            rms = jmax(rms, (int)buckets[i].rms);
+            lowBand = jmax(lowBand, (float)buckets[i].low);
+            midBand = jmax(midBand, (float)buckets[i].mid);
+            highBand = jmax(highBand, (float)buckets[i].high);
+        }
+
+        // Colour the column by the balance of the bands, at full brightness
+        const auto loudest = jmax(1.0f, lowBand, midBand, highBand);
+        const auto colour = Colour::fromFloatRGBA(lowBand / loudest, midBand / loudest, highBand / loudest, 1.0f);
+
+        // Peaks in the band colour, with the RMS level on top in a brighter shade
+        const auto column = area.getX() + x;
+        g.setColour(colour.withMultipliedBrightness(0.7f));
+        g.drawVerticalLine(column, centre - high / 127.0f * halfHeight, centre - low / 127.0f * halfHeight + 1.0f);
+
+        const auto rmsHeight = rms / 255.0f * halfHeight;
+        g.setColour(colour.interpolatedWith(Colours::white, 0.3f));
+        g.drawVerticalLine(column, centre - rmsHeight, centre + rmsHeight + 1.0f);
+    }
+}
+
+//==============================================================================
+// Reads a track on the store's thread and writes its overview file.
+class WaveformStore::GenerateJob : public ThreadPoolJob
+{
+public:
+    GenerateJob(WeakReference<WaveformStore> _owner,
+                AudioFormatManager &_formatManager,
+                const URL &_audioURL,
+                int64 _key,
+                std::shared_ptr<const DecodedTrack> _decoded,
+                const File &_targetFile)
+        : ThreadPoolJob("Waveform " + _audioURL.getFileName()),
+          owner(_owner),
+          formatManager(_formatManager),
+          audioURL(_audioURL),
+          key(_key),
+          decoded(std::move(_decoded)),
+          targetFile(_targetFile)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        std::unique_ptr<OverviewBuilder> builder;
+        double sampleRate = 0.0;
+        int64 lengthInSamples = 0;
+        constexpr int chunkSize = 1 << 16;
+
+        // Decoded tracks are already in memory; anything else is read from disk.
+        if (decoded != nullptr)
+        {
+            const auto &samples = decoded->samples;
+            sampleRate = decoded->sampleRate;
+            lengthInSamples = samples.getNumSamples();
+            builder = std::make_unique<OverviewBuilder>(sampleRate, chunkSize);
+
+            for (int pos = 0; pos < samples.getNumSamples() && !shouldExit(); pos += chunkSize)
+            {
+                const auto num = jmin(chunkSize, samples.getNumSamples() - pos);
+                const float *channels[] = {samples.getReadPointer(0, pos), samples.getReadPointer(samples.getNumChannels() - 1, pos)};
+                builder->addSamples(channels, jmin(2, samples.getNumChannels()), num);
+            }
+        }
+        else if (audioURL.isLocalFile())
+        {
+            std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(audioURL.getLocalFile()));
+
+            if (reader != nullptr && reader->lengthInSamples > 0 && reader->sampleRate > 0.0)
+            {
+                AudioBuffer<float> chunk(jlimit(1, 2, (int)reader->numChannels), chunkSize);
+                sampleRate = reader->sampleRate;
+                lengthInSamples = reader->lengthInSamples;
+                builder = std::make_unique<OverviewBuilder>(sampleRate, chunkSize);
+
+                for (int64 pos = 0; pos < lengthInSamples && !shouldExit(); pos += chunkSize)
+                {
+                    const auto num = (int)jmin((int64)chunkSize, lengthInSamples - pos);
+                    reader->read(&chunk, 0, num, pos, true, true);
+                    builder->addSamples(chunk.getArrayOfReadPointers(), chunk.getNumChannels(), num);
+                }
+            }
+        }
+
+        if (!shouldExit() && builder != nullptr && lengthInSamples > 0)
+        {
+            builder->finish();
+            save(*builder, sampleRate, lengthInSamples);
+        }
+
+        // Report back even if the job was stopped, so the store forgets the request and the
+        // next one for this track starts a new job instead of waiting for this one forever.
+        MessageManager::callAsync([weakOwner = owner, k = key]
+                                  {
+            if (auto *store = weakOwner.get())
+                store->jobFinished(k); });
+
+        return jobHasFinished;
+    }
+
+private:
+    void save(const OverviewBuilder &builder, double sampleRate, int64 lengthInSamples)
+    {
+        // Write next to the target and move it into place once it is complete.
+        TemporaryFile temp(targetFile);
+
+        {
+            auto out = temp.getFile().createOutputStream();
+
+            if (out == nullptr || !builder.write(*out, sampleRate, lengthInSamples))
+            {
+                std::cout << "WaveformStore::Couldn't write " << targetFile.getFullPathName() << std::endl;
+                return;
+            }
+        }
+
+        temp.overwriteTargetFileWithTemporary();
+    }
+
+    WeakReference<WaveformStore> owner;			 // The store that receives the result, if it still exists
+    AudioFormatManager &formatManager;			 // Used to open the track
+    URL audioURL;								 // The track
+    int64 key;									 // The track's key
+    std::shared_ptr<const DecodedTrack> decoded; // The decoded samples, if the track is in memory
+    File targetFile;							 // Where the overview goes
+};
+
+//==============================================================================
+WaveformStore::WaveformStore(AudioFormatManager &_formatManager, const File &_folder)
+    : formatManager(_formatManager), folder(_folder)
+{
+    // Keep the overviews with the user's application data unless told otherwise.
+    if (folder == File())
+    {
+        folder = File::getSpecialLocation(File::userApplicationDataDirectory).getChildFile("xDecks").getChildFile("Waveforms");
+    }
+
+    folder.createDirectory();
+}
+
+WaveformStore::~WaveformStore()
+{
+    pool.removeAllJobs(true, 5000);
+}
+
+std::shared_ptr<const WaveformOverview> WaveformStore::find(int64 key) const
+{
+    return WaveformOverview::open(getFileForKey(key));
+}
+
+void WaveformStore::generate(const URL &audioURL, int64 key, std::shared_ptr<const DecodedTrack> decoded, Callback callback)
+{
+    // Only start a job for the first request of a track; the rest wait for the same result.
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+
+    auto &callbacks = pending[key];
+    callbacks.push_back(std::move(callback));
+
+    if (callbacks.size() == 1)
+    {
+        pool.addJob(new GenerateJob(WeakReference<WaveformStore>(this), formatManager, audioURL,
+                                    key, std::move(decoded), getFileForKey(key)),
+                    true);
+    }
+}
+
+File WaveformStore::getFileForKey(int64 key) const
+{
+    return folder.getChildFile(String::toHexString(key) + ".xdwf");
+}
+
+void WaveformStore::jobFinished(int64 key)
+{
+    // Map the new overview once and hand it to everyone who asked for it. A stopped or failed
+    // job has no overview, so they get nullptr. Either way the request is done with.
+    auto it = pending.find(key);
+
+    if (it == pending.end())
+    {
+        return;
+    }
+
+    const auto callbacks = std::move(it->second);
+    pending.erase(it);
+
+    const auto overview = find(key);
+
+    for (const auto &callback : callbacks)
+    {
+        if (callback != nullptr)
+        {
+            callback(overview);
+        }
+    }
+}
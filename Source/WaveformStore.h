@@ -0,0 +1,189 @@
+/*
+	==============================================================================
+
+	WaveformStore.h
+	Created: 19 Oct 2026 6:12:40pm
+	Author:  pavelosky
+
+	==============================================================================
+*/
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "DecodedTrackCache.h"
+
+/**
+	A precomputed waveform overview of a whole track, read straight from a memory-mapped file.
+
+	Besides the peaks and RMS level, every bucket has the energy of the low, mid and
+	high bands, split at the same crossover points as the deck's isolator, so the
+	waveform can be coloured to tell kicks from hi-hats.
+
+	The overview is a pyramid of levels. The first level has one bucket for every
+	few dozen samples and each level above it is four times coarser, so a display
+	of any width can pick a level with about one bucket per pixel and never has to
+	touch more than a few thousand buckets to draw the whole track.
+*/
+class WaveformOverview
+{
+public:
+	/** The peaks, loudness and band energies of one bucket, with both channels mixed together. */
+	struct Bucket
+	{
+		int8 min;		  // Lowest sample, scaled to -127..127
+		int8 max;		  // Highest sample, scaled to -127..127
+		uint8 rms;		  // RMS level, scaled to 0..255
+		uint8 low;		  // RMS level below 200 Hz, scaled to 0..255
+		uint8 mid;		  // RMS level from 200 Hz to 2.5 kHz, scaled to 0..255
+		uint8 high;		  // RMS level above 2.5 kHz, scaled to 0..255
+		uint8 unused[2]; // Keeps buckets eight bytes long
+	};
+
+	/** Number of samples in a bucket of the finest level. */
+	static constexpr int baseSamplesPerBucket = 64;
+
+	/** How many buckets of one level make up a bucket of the next. */
+	static constexpr int levelRatio = 4;
+
+	/** Number of levels in an overview. */
+	static constexpr int numLevels = 6;
+
+	/**
+		Maps an overview file.
+		@param file The file written by WaveformStore.
+		@return The overview, or nullptr if the file is missing or isn't a valid overview.
+	*/
+	static std::shared_ptr<const WaveformOverview> open(const File &file);
+
+	/**
+		Returns the sample rate of the track.
+	*/
+	double getSampleRate() const;
+
+	/**
+		Returns the length of the track in samples.
+	*/
+	int64 getLengthInSamples() const;
+
+	/**
+		Returns the number of samples in each bucket of a level.
+		@param level The level, from 0 (finest) to numLevels - 1.
+	*/
+	int getSamplesPerBucket(int level) const;
+
+	/**
+		Returns the number of buckets in a level.
+		@param level The level, from 0 (finest) to numLevels - 1.
+	*/
+	int getNumBuckets(int level) const;
+
+	/**
+		Returns the buckets of a level.
+		@param level The level, from 0 (finest) to numLevels - 1.
+	*/
+	const Bucket *getBuckets(int level) const;
+
+	/**
+		Picks the coarsest level that still has at least one bucket per pixel.
+		@param samplesPerPixel How many samples of the track one pixel covers.
+	*/
+	int getLevelForResolution(double samplesPerPixel) const;
+
+	/**
+		Draws part of the waveform, one column of pixels at a time, centred vertically in the area.
+		Each column is coloured by the balance of its bands: red for bass, green for mids and blue for highs.
+		Columns before the start or after the end of the track are left untouched.
+		@param g The Graphics object to draw with.
+		@param area The area to draw into.
+		@param startSample The track sample at the left edge of the area. May be negative.
+		@param samplesPerPixel How many samples of the track one pixel covers.
+	*/
+	void draw(Graphics &g, Rectangle<int> area, double startSample, double samplesPerPixel) const;
+
+private:
+	// Where a level is in the file.
+	struct Level
+	{
+		int samplesPerBucket = 0;
+		int numBuckets = 0;
+		const Bucket *buckets = nullptr;
+	};
+
+	WaveformOverview(std::unique_ptr<MemoryMappedFile> mappedFile);
+	bool readHeader();
+
+	std::unique_ptr<MemoryMappedFile> file;	 // The mapped overview file
+	double sampleRate = 0.0;				 // Sample rate of the track
+	int64 lengthInSamples = 0;				 // Length of the track in samples
+	std::array<Level, numLevels> levels;	 // The levels, finest first
+
+	friend class WaveformStore;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformOverview)
+};
+
+/**
+	Keeps waveform overviews on disk, so that a track only has to be decoded once to
+	draw its waveform, even across restarts of the app.
+
+	Overviews are stored in the user's application data folder and named after the
+	same key as the DecodedTrackCache, which includes the file's size and modification
+	time, so an edited file gets a new overview. The key is not the audio itself, so
+	retagging or moving a file also gives it a new key, and its overview, analysis
+	and hot cues are no longer found; the overview and analysis are made again, but
+	the hot cues are lost. Keying by the audio content would need every file in the
+	library to be read, which the index avoids. Missing overviews are generated on a
+	background thread, written to a temporary file and moved into place, so a
+	half-written overview is never mapped. Different tracks are analysed in parallel
+	on half of the CPU cores, so a whole library can be queued at once.
+*/
+class WaveformStore
+{
+public:
+	/** Receives a generated overview on the message thread, or nullptr if it couldn't be generated. */
+	using Callback = std::function<void(std::shared_ptr<const WaveformOverview>)>;
+
+	/**
+		Constructor.
+		@param formatManager The AudioFormatManager used to open tracks that aren't decoded in memory.
+		@param folder Where to keep the overview files. Defaults to a folder in the user's application data.
+	*/
+	WaveformStore(AudioFormatManager &formatManager, const File &folder = File());
+
+	/**
+		Destructor. Stops any overview that is still being generated.
+	*/
+	~WaveformStore();
+
+	/**
+		Maps the stored overview of a track, if there is one.
+		@param key The track's key from DecodedTrackCache::makeKey().
+		@return The overview, or nullptr if the track hasn't been analysed yet.
+	*/
+	std::shared_ptr<const WaveformOverview> find(int64 key) const;
+
+	/**
+		Generates the overview of a track in the background and stores it.
+		Requests for a track that is already being generated share the same job. Every
+		request's callback is called once, with nullptr if the job failed or was stopped.
+		@param audioURL The track. Only local files are read; other tracks need decoded samples.
+		@param key The track's key from DecodedTrackCache::makeKey().
+		@param decoded The decoded samples, if the track is in memory, so the file doesn't have to be read again.
+		@param callback Called on the message thread when the overview is ready. May be nullptr.
+	*/
+	void generate(const URL &audioURL, int64 key, std::shared_ptr<const DecodedTrack> decoded, Callback callback);
+
+private:
+	class GenerateJob;
+
+	File getFileForKey(int64 key) const;
+	void jobFinished(int64 key);
+
+	AudioFormatManager &formatManager;				  // Used to open tracks for generating overviews
+	File folder;									  // Where the overview files are kept
+	ThreadPool pool{jmax(1, SystemStats::getNumCpus() / 2)}; // Generates overviews of several tracks at once
+	std::map<int64, std::vector<Callback>> pending; // Callbacks waiting for each job, only touched on the message thread
+
+	JUCE_DECLARE_WEAK_REFERENCEABLE(WaveformStore)
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformStore)
+};